@@ -1,10 +1,22 @@
 #include <UDPTest/Client.h>
+#include <UDPTest/Detail/EventLog.h>
+#include <UDPTest/Detail/TrafficClass.h>
+#include <UDPTest/Exporter.h>
+#include <UDPTest/FanOut.h>
+#include <UDPTest/LogBenchmark.h>
+#include <UDPTest/Reflector.h>
 #include <UDPTest/Server.h>
+#include <UDPTest/Simulation.h>
 
 #include <cxxopts.hpp>
 
 using UDPTest::Client;
+using UDPTest::Exporter;
+using UDPTest::FanOut;
+using UDPTest::LogBenchmark;
+using UDPTest::Reflector;
 using UDPTest::Server;
+using UDPTest::Simulation;
 
 int main(int argc, char* argv[])
 {
@@ -17,6 +29,40 @@ int main(int argc, char* argv[])
 		("b,bitrate", "The bitrate per second to send", cxxopts::value<std::string>()->default_value("1M"))
 		("r,packetrate", "The rate of packets per second to send", cxxopts::value<uint32_t>()->default_value("100"))
 		("t,time", "The total time to test in seconds", cxxopts::value<uint32_t>()->default_value("10"))
+		("sendring", "The maximum number of in-flight sends (client)", cxxopts::value<uint32_t>()->default_value("8"))
+		("catchup", "How to catch up on missed send slots: burst, drop or stretch. Burst queues at most a send ring of them and skips the rest (client)", cxxopts::value<std::string>()->default_value("burst"))
+		("sweep", "Payload sizes to sweep, as a list and/or start:end:step ranges (client)", cxxopts::value<std::string>()->default_value(""))
+		("phases", "Phases to run back to back over one session, comma-separated, each with slash-separated bitrate=, rate=, size= and time= overriding -b, -r and -t (client)", cxxopts::value<std::string>()->default_value(""))
+		("m,metrics", "Publish live metrics to this shared-memory segment", cxxopts::value<std::string>()->default_value(""))
+		("stat", "Print the metrics of a shared-memory segment and exit", cxxopts::value<std::string>())
+		("exporter", "Serve a shared-memory segment's metrics to Prometheus on the address", cxxopts::value<std::string>())
+		("exporterport", "The port to serve Prometheus metrics on", cxxopts::value<std::string>()->default_value("9464"))
+		("shape", "The traffic shape: cbr, poisson, onoff:<burst packets>:<off ms> or trace:<file> (client)", cxxopts::value<std::string>()->default_value("cbr"))
+		("sizes", "Draw payload sizes uniformly from <min>:<max> instead of sizing them from the bitrate (client)", cxxopts::value<std::string>()->default_value(""))
+		("integrity", "Seal every packet with a CRC32C that the server verifies (client)", cxxopts::value<bool>()->implicit_value("true"))
+		("fresh", "Share the payload seed so the server regenerates and checks every payload byte (client)", cxxopts::value<bool>()->implicit_value("true"))
+		("warmup", "Milliseconds to send before the first measured run without counting anything (client)", cxxopts::value<uint32_t>()->default_value("0"))
+		("repeat", "The number of measured runs of each payload size, summarized with confidence intervals (client)", cxxopts::value<uint32_t>()->default_value("1"))
+		("header", "Optional packet header fields to negotiate, comma-separated from timestamp, stream and flags (client)", cxxopts::value<std::string>()->default_value(""))
+		("targets", "Comma-separated <address>[:<port>] targets to test at once, splitting the bitrate and packet rate between them (client)", cxxopts::value<std::string>()->default_value(""))
+		("classes", "Traffic classes to run at once towards the server, comma-separated <name>:<settings> with slash-separated dscp=, priority=, bitrate=, rate=, size= and shape= overriding --dscp, --priority, -b, -r, --sizes and --shape (client)", cxxopts::value<std::string>()->default_value(""))
+		("dscp", "The DSCP to mark packets and acks with, from 0 to 63 or be, ef, cs<0-7> or af<1-4><1-3> (client)", cxxopts::value<std::string>()->default_value("0"))
+		("priority", "The socket priority to send packets and acks at, 0 for the default (client)", cxxopts::value<uint32_t>()->default_value("0"))
+		("soak", "Write rolling 1s, 1m and 1h aggregates to this file as JSON lines (client)", cxxopts::value<std::string>()->default_value(""))
+		("soaksize", "The megabytes to write to a soak file before rotating it (client)", cxxopts::value<uint32_t>()->default_value("64"))
+		("soakfiles", "The number of rotated soak files to keep (client)", cxxopts::value<uint32_t>()->default_value("8"))
+		("perf", "Read cycles, instructions and cache misses of the transport thread with perf_event", cxxopts::value<bool>()->implicit_value("true"))
+		("impair", "Impair acks with comma-separated delay=<ms>, jitter=<ms>, loss=<%>, reorder=<%> and duplicate=<%> (server)", cxxopts::value<std::string>()->default_value(""))
+		("recvdepth", "The number of concurrent receives per connection (server)", cxxopts::value<uint32_t>()->default_value("8"))
+		("reflector", "Run the server as a stateless reflector, or send to one without a control connection", cxxopts::value<bool>()->implicit_value("true"))
+		("shards", "The number of reflector sockets sharing the port, each with its own thread (server)", cxxopts::value<uint32_t>()->default_value("1"))
+		("idletimeout", "The seconds a reflector flow may be idle before it is forgotten (server)", cxxopts::value<uint32_t>()->default_value("30"))
+		("maxflows", "The most flows each reflector shard tracks (server)", cxxopts::value<uint32_t>()->default_value("65536"))
+		("eventlog", "Record every packet event to this binary file", cxxopts::value<std::string>()->default_value(""))
+		("decode", "Print the events of a binary event log and exit", cxxopts::value<std::string>())
+		("simulate", "Simulate a client and server over an in-memory network impaired each way with comma-separated delay=<ms>, jitter=<ms>, loss=<%>, reorder=<%> and duplicate=<%>, corrupting packets with corrupt=<%> and limiting the client's link to link=<Mbit/s>, check every stat against the network's ground truth and exit", cxxopts::value<std::string>())
+		("seed", "The seed of a simulation, which replays exactly for a seed", cxxopts::value<uint64_t>()->default_value("1"))
+		("logbench", "Measure the per-packet cost of each logging mode over this many events and exit", cxxopts::value<uint32_t>()->implicit_value("1000000"))
 		("h,help", "Display this help message");
 	try
 	{
@@ -27,11 +73,88 @@ int main(int argc, char* argv[])
 			std::cout << opt.help() << '\n';
 			return 0;
 		}
-		if (res["server"].as<bool>() == true)
+		if (res.count("stat") != 0)
+			Exporter::PrintMetrics(res["stat"].as<std::string>(), std::cout);
+		else if (res.count("decode") != 0)
+			UDPTest::Detail::EventLog::Decode(res["decode"].as<std::string>(), std::cout);
+		else if (res.count("logbench") != 0)
 		{
-			Server server(res["address"].as<std::string>(),
-				res["port"].as<std::string>());
-			server.Run();
+			if (res["logbench"].as<uint32_t>() == 0)
+			{
+				std::cerr << "Event count must be nonzero\n";
+				return 1;
+			}
+			LogBenchmark::Run(res["logbench"].as<uint32_t>(), std::cout);
+		}
+		else if (res.count("simulate") != 0)
+		{
+			Simulation::Config config;
+			Simulation::ParseNetwork(res["simulate"].as<std::string>(), config);
+			config.seed = res["seed"].as<uint64_t>();
+			config.time = res["time"].as<uint32_t>();
+			config.packetRate = res["packetrate"].as<uint32_t>();
+			config.bitRate = Client::ParseBitrate(res["bitrate"].as<std::string>());
+			config.shape = res["shape"].as<std::string>();
+			config.sendRingSize = res["sendring"].as<uint32_t>();
+			config.catchUpPolicy = res["catchup"].as<std::string>();
+			config.fields = UDPTest::Detail::BasePacketFields |
+				UDPTest::Detail::ParseFields(res["header"].as<std::string>()) |
+				((res["integrity"].as<bool>() == true) ? UDPTest::Detail::FieldBit(UDPTest::Detail::Field::Checksum) : 0);
+			if (Simulation::Run(config, std::cout) == false)
+				return 1;
+		}
+		else if (res.count("exporter") != 0)
+		{
+			Exporter exporter(res["address"].as<std::string>(),
+				res["exporterport"].as<std::string>(),
+				res["exporter"].as<std::string>());
+			exporter.Run();
+		}
+		else if (res["server"].as<bool>() == true)
+		{
+			if (res["recvdepth"].as<uint32_t>() == 0)
+			{
+				std::cerr << "Receive depth must be nonzero\n";
+				return 1;
+			}
+			if (res["reflector"].as<bool>() == true)
+			{
+				if (res["shards"].as<uint32_t>() == 0)
+				{
+					std::cerr << "Shard count must be nonzero\n";
+					return 1;
+				}
+				if (res["eventlog"].as<std::string>().empty() == false)
+				{
+					std::cerr << "A reflector can't record an event log\n";
+					return 1;
+				}
+				if (res["impair"].as<std::string>().empty() == false)
+				{
+					std::cerr << "A reflector can't impair acks\n";
+					return 1;
+				}
+				Reflector reflector(res["address"].as<std::string>(),
+					res["port"].as<std::string>(),
+					res["shards"].as<uint32_t>(),
+					res["recvdepth"].as<uint32_t>(),
+					res["idletimeout"].as<uint32_t>(),
+					res["maxflows"].as<uint32_t>(),
+					res["metrics"].as<std::string>(),
+					res["perf"].as<bool>());
+				reflector.Run();
+			}
+			else
+			{
+				Server server(res["address"].as<std::string>(),
+					res["port"].as<std::string>(),
+					res["recvdepth"].as<uint32_t>(),
+					res["metrics"].as<std::string>(),
+					res["eventlog"].as<std::string>(),
+					res["perf"].as<bool>(),
+					res["impair"].as<std::string>());
+				server.Run();
+			}
 		}
 		else if (res["client"].as<bool>() == true)
 		{
@@ -40,12 +163,112 @@ int main(int argc, char* argv[])
 				std::cerr << "Packet rate must be nonzero\n";
 				return 1;
 			}
-			Client client(res["address"].as<std::string>(),
-				res["port"].as<std::string>(), 
-				res["bitrate"].as<std::string>(),
-				res["packetrate"].as<uint32_t>(),
-				res["time"].as<uint32_t>());
-			client.Run();
+			if (res["sendring"].as<uint32_t>() == 0)
+			{
+				std::cerr << "Send ring size must be nonzero\n";
+				return 1;
+			}
+			if (res["repeat"].as<uint32_t>() == 0)
+			{
+				std::cerr << "Repeat count must be nonzero\n";
+				return 1;
+			}
+			if (res["soaksize"].as<uint32_t>() == 0 || res["soakfiles"].as<uint32_t>() == 0)
+			{
+				std::cerr << "Soak file size and count must be nonzero\n";
+				return 1;
+			}
+			if (res["priority"].as<uint32_t>() > 255)
+			{
+				std::cerr << "Socket priority must be at most 255\n";
+				return 1;
+			}
+			UDPTest::Detail::TrafficClass defaults;
+			defaults.bitRate = res["bitrate"].as<std::string>();
+			defaults.packetRate = res["packetrate"].as<uint32_t>();
+			defaults.sizes = res["sizes"].as<std::string>();
+			defaults.shape = res["shape"].as<std::string>();
+			defaults.tos = static_cast<uint8_t>(
+				UDPTest::Detail::TrafficClass::ParseDscp(res["dscp"].as<std::string>()) << 2);
+			defaults.priority = static_cast<uint8_t>(res["priority"].as<uint32_t>());
+			const auto makeClient = [&res](const FanOut::Flow& flow, const std::string& header,
+				const Client::Shared* shared)
+			{
+				const UDPTest::Detail::TrafficClass& trafficClass = flow.trafficClass;
+				Client::Config config;
+				config.address = flow.address;
+				config.port = flow.port;
+				config.bitRate = trafficClass.bitRate;
+				config.packetRate = trafficClass.packetRate;
+				config.time = res["time"].as<uint32_t>();
+				config.sendRingSize = res["sendring"].as<uint32_t>();
+				config.catchUpPolicy = res["catchup"].as<std::string>();
+				config.sweep = res["sweep"].as<std::string>();
+				config.phases = res["phases"].as<std::string>();
+				config.metrics = res["metrics"].as<std::string>();
+				config.shape = trafficClass.shape;
+				config.sizes = trafficClass.sizes;
+				config.integrity = res["integrity"].as<bool>();
+				config.fresh = res["fresh"].as<bool>();
+				config.reflector = res["reflector"].as<bool>();
+				config.eventLog = res["eventlog"].as<std::string>();
+				config.warmup = res["warmup"].as<uint32_t>();
+				config.repeat = res["repeat"].as<uint32_t>();
+				// a fan-out meters its shared thread itself
+				config.perf = shared == nullptr && res["perf"].as<bool>();
+				config.header = header;
+				config.tos = trafficClass.tos;
+				config.priority = trafficClass.priority;
+				config.soak = res["soak"].as<std::string>();
+				config.soakSize = res["soaksize"].as<uint32_t>();
+				config.soakFiles = res["soakfiles"].as<uint32_t>();
+				return std::make_unique<Client>(config, shared);
+			};
+			const std::string& targets = res["targets"].as<std::string>();
+			const std::string& classes = res["classes"].as<std::string>();
+			if (targets.empty() == false || classes.empty() == false)
+			{
+				if (res["eventlog"].as<std::string>().empty() == false ||
+					res["soak"].as<std::string>().empty() == false ||
+					res["phases"].as<std::string>().empty() == false)
+				{
+					std::cerr << "A fan-out can't record an event log or soak windows, or run phases\n";
+					return 1;
+				}
+				if (targets.empty() == false && classes.empty() == false)
+				{
+					std::cerr << "Targets and classes can't be combined\n";
+					return 1;
+				}
+				if (classes.empty() == false && res["reflector"].as<bool>() == true)
+				{
+					std::cerr << "A reflector can't tell classes apart\n";
+					return 1;
+				}
+				// classes carry their stream in every packet, and timestamps
+				// for the server to measure their jitter by
+				std::string header = res["header"].as<std::string>();
+				if (classes.empty() == false)
+					header += (header.empty() == true) ? "timestamp,stream" : ",timestamp,stream";
+				FanOut fanOut((targets.empty() == false) ?
+						FanOut::SplitTargets(targets, res["port"].as<std::string>(), defaults) :
+						FanOut::SplitClasses(res["address"].as<std::string>(),
+							res["port"].as<std::string>(), classes, defaults),
+					res["metrics"].as<std::string>(),
+					res["perf"].as<bool>(),
+					[&makeClient, &header](const FanOut::Flow& flow, const Client::Shared& shared)
+					{
+						return makeClient(flow, header, &shared);
+					});
+				fanOut.Run();
+			}
+			else
+			{
+				const std::unique_ptr<Client> client = makeClient(FanOut::Flow{
+						res["address"].as<std::string>(), res["port"].as<std::string>(), defaults },
+					res["header"].as<std::string>(), nullptr);
+				client->Run();
+			}
 		}
 		else
 		{
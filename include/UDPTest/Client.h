@@ -6,16 +6,28 @@
 /// 6/22/20 21:37
 
 // USPTest includes
+#include <UDPTest/Detail/AckTracker.h>
 #include <UDPTest/Detail/Control.h>
+#include <UDPTest/Detail/CpuMeter.h>
+#include <UDPTest/Detail/EventLog.h>
+#include <UDPTest/Detail/Histogram.h>
+#include <UDPTest/Detail/KernelCounters.h>
+#include <UDPTest/Detail/MetricsSegment.h>
+#include <UDPTest/Detail/Reporter.h>
+#include <UDPTest/Detail/SendPacer.h>
+#include <UDPTest/Detail/SoakRecorder.h>
+#include <UDPTest/Detail/TrafficModel.h>
 #include <UDPTest/Detail/Transport.h>
 
 // asio includes
 #include <asio.hpp>
 
 // STL includes
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace UDPTest
 {
@@ -29,21 +41,220 @@ namespace UDPTest
 		using TCPSocket_t = TCPProto_t::socket;
 		using UDPProto_t = asio::ip::udp;
 		using UDPSocket_t = UDPProto_t::socket;
+		using Clock_t = std::chrono::high_resolution_clock;
+
+		/// @brief The counters of a single print interval, handed to the reporter
+		struct IntervalStats
+		{
+			/// @brief The client's index in a fan-out
+			uint32_t target = 0;
+			uint64_t bytesSent = 0;
+			uint32_t packetsSent = 0;
+			uint32_t packetsReceived = 0;
+			/// @brief Packets given up on as lost during the interval
+			uint32_t packetsLost = 0;
+			uint32_t packetsCorrupted = 0;
+			uint64_t phaseSent = 0;
+			uint64_t phaseReceived = 0;
+			uint64_t phaseCorrupted = 0;
+			/// @brief The transport thread's usage since the client started
+			uint64_t cpuNs = 0;
+			uint64_t contextSwitches = 0;
+			std::chrono::high_resolution_clock::duration totalLatency{};
+			Detail::Histogram latency;
+			/// @brief The phase's jitter as the interval ended
+			std::chrono::high_resolution_clock::duration jitter{};
+			/// @brief True if the interval was spent warming up, so it is
+			/// printed but kept out of the metrics and the soak
+			bool warmup = false;
+
+			/// @brief Adds another client's interval. The thread's usage is
+			/// shared, so it is kept rather than added, and so is the worst
+			/// jitter
+			/// @param other The other interval
+			void Merge(const IntervalStats& other) noexcept
+			{
+				bytesSent += other.bytesSent;
+				packetsSent += other.packetsSent;
+				packetsReceived += other.packetsReceived;
+				packetsLost += other.packetsLost;
+				packetsCorrupted += other.packetsCorrupted;
+				phaseSent += other.phaseSent;
+				phaseReceived += other.phaseReceived;
+				phaseCorrupted += other.phaseCorrupted;
+				cpuNs = std::max(cpuNs, other.cpuNs);
+				contextSwitches = std::max(contextSwitches, other.contextSwitches);
+				totalLatency += other.totalLatency;
+				latency.Merge(other.latency);
+				jitter = std::max(jitter, other.jitter);
+			}
+
+			/// @brief Clears every counter
+			void Reset() noexcept { *this = IntervalStats(); }
+		};
+
+		/// @brief What the clients of a fan-out share. They all run on the
+		/// worker's one thread, since the reporter's queue has a single producer
+		struct Shared
+		{
+			asio::io_context& worker;
+			Detail::Reporter<IntervalStats>& reporter;
+			/// @brief The segment to publish metrics to, or null for none
+			Detail::MetricsSegment* metrics;
+			/// @brief The client's index, which tags its interval stats and
+			/// numbers its stream from 1
+			uint32_t target;
+			/// @brief The name the client reports under
+			std::string name;
+		};
+
+		/// @brief What a client tests and how
+		struct Config
+		{
+			/// @brief The address and port of the server
+			std::string address = "127.0.0.1";
+			std::string port = "5601";
+			/// @brief The bitrate to transfer at
+			std::string bitRate = "1M";
+			/// @brief The packet rate to transfer with. Requires: nonzero
+			uint32_t packetRate = 100;
+			/// @brief The time to test for in seconds
+			uint32_t time = 10;
+			/// @brief The maximum number of in-flight sends. Requires: nonzero
+			uint32_t sendRingSize = 8;
+			/// @brief The catch-up policy, one of burst, drop or stretch
+			std::string catchUpPolicy = "burst";
+			/// @brief The payload sizes to sweep through, one phase of time
+			/// seconds each. Empty to run a single phase sized from the bitrate
+			std::string sweep;
+			/// @brief The phases to run back to back over one session, as
+			/// parsed by ParsePhases. Empty to run the sweep or the single phase
+			std::string phases;
+			/// @brief The shared-memory segment to publish metrics to, or
+			/// empty for none
+			std::string metrics;
+			/// @brief The traffic shape: cbr, poisson, onoff:<burst packets>:<off ms>
+			/// or trace:<file>
+			std::string shape = "cbr";
+			/// @brief The payload size range, as <size> or <min>:<max>, or
+			/// empty to size packets from the bitrate
+			std::string sizes;
+			/// @brief Whether to seal packets with a checksum for the server
+			/// to verify
+			bool integrity = false;
+			/// @brief Whether to share the payload seed so the server can
+			/// check every payload byte
+			bool fresh = false;
+			/// @brief Whether the server is a reflector, which is sent to
+			/// directly without a control connection
+			bool reflector = false;
+			/// @brief The file to record packet events to, or empty for none
+			std::string eventLog;
+			/// @brief The milliseconds to send for before the first measured
+			/// run, without counting anything
+			uint32_t warmup = 0;
+			/// @brief The number of measured runs of each payload size.
+			/// Requires: nonzero
+			uint32_t repeat = 1;
+			/// @brief Whether to read hardware counters with perf_event
+			bool perf = false;
+			/// @brief The optional packet header fields, as parsed by
+			/// Detail::ParseFields
+			std::string header;
+			/// @brief The TOS byte to mark packets, and the server's acks, with
+			uint8_t tos = 0;
+			/// @brief The socket priority to send packets, and the server's
+			/// acks, at. 0 leaves the default
+			uint8_t priority = 0;
+			/// @brief The file to write rolling 1s, 1m and 1h aggregates to,
+			/// or empty for none
+			std::string soak;
+			/// @brief The megabytes to write to a soak file before rotating it
+			uint32_t soakSize = 64;
+			/// @brief The number of rotated soak files to keep
+			uint32_t soakFiles = 8;
+		};
+
+		/// @brief The traffic of every phase a client finished
+		struct Totals
+		{
+			uint64_t sent = 0;
+			uint64_t received = 0;
+			uint64_t corrupted = 0;
+			/// @brief The seqs the loss tracker counted lost
+			uint64_t lost = 0;
+			uint64_t bytes = 0;
+			std::chrono::high_resolution_clock::duration elapsed{};
+			std::chrono::high_resolution_clock::duration totalLatency{};
+			Detail::Histogram latency;
+			/// @brief The jitter of the phase that had the most
+			std::chrono::high_resolution_clock::duration jitter{};
+		};
 
 		/// @brief Creates a client and starts it
-		/// @param address The address of the server
-		/// @param port The port of the server
-		/// @param bitRate The bitrate to transfer at
-		/// @param packetRate The packet rate to transfer with. Requires: nonzero
+		/// @param config What to test and how
+		/// @param shared The worker and reporting pipeline of the fan-out the
+		/// client is part of, or null to run on its own
 		/// @throws ErrorCode_t
 		/// @throws std::runtime_error
-		Client(const std::string& address, const std::string& port,
-			const std::string& bitRate, uint32_t packetRate, uint32_t time);
+		Client(const Config& config, const Shared* shared);
 
-		/// @brief Runs the client
+		/// @brief Runs the client. Requires: not part of a fan-out, whose
+		/// worker runs it instead
 		/// @throws ErrorCode_t
 		void Run();
+
+		/// @brief Reports the stats of an interval. Runs on the reporter thread
+		/// @param stats The interval stats
+		void ReportInterval(const IntervalStats& stats) noexcept;
+		/// @brief Prints the stats of an interval
+		/// @param title The title of the stats
+		/// @param stats The interval stats
+		static void PrintIntervalStats(const std::string& title, const IntervalStats& stats) noexcept;
+
+		/// @brief Gets the name of the client's target, as address:port,
+		/// or the name it was given in a fan-out
+		const std::string& GetTarget() const noexcept { return m_target; }
+		/// @brief Gets the traffic of every phase finished so far
+		const Totals& GetTotals() const noexcept { return m_totals; }
+
+		/// @brief Parses a bitrate
+		/// @param bitrate The bitrate string
+		/// @throws std::runtime_error
+		/// @return The bitrate in bits per second
+		static uint64_t ParseBitrate(const std::string& bitrate);
+		/// @brief Converts a bit count to string, compressing as necessary
+		/// @param bits The number of bits
+		/// @return A string representing the bit count
+		static std::string BitsToString(uint64_t bits) noexcept;
 	private:
+		/// @brief What a phase sends
+		struct PhaseSpec
+		{
+			uint32_t payloadSize;
+			uint32_t packetRate;
+			/// @brief The seconds the phase runs for
+			uint32_t time;
+		};
+
+		/// @brief The results of a finished phase
+		struct PhaseResult
+		{
+			uint32_t payloadSize;
+			uint32_t packetRate;
+			uint32_t time;
+			bool fragmented;
+			uint64_t sent;
+			uint64_t received;
+			uint64_t corrupted;
+			uint64_t lost;
+			uint64_t totalBytes;
+			std::chrono::high_resolution_clock::duration averageLatency;
+			std::chrono::high_resolution_clock::duration maxLatency;
+			uint64_t p50LatencyNs;
+			uint64_t p99LatencyNs;
+		};
+
 		/// @brief Stops the client
 		void Stop() noexcept;
 
@@ -53,68 +264,252 @@ namespace UDPTest
 		/// @brief Waits for signals
 		void WaitSignals() noexcept;
 
-		/// @brief Parses a bitrate
-		/// @param bitrate The bitrate string
+		/// @brief Parses a sweep of payload sizes
+		/// @param sweep A comma separated list of sizes or start:end:step ranges
 		/// @throws std::runtime_error
-		/// @return The bitrate in bits per second
-		uint64_t ParseBitrate(const std::string& bitrate);
+		/// @return The payload sizes, in order
+		static std::vector<uint32_t> ParseSweep(const std::string& sweep);
+		/// @brief Parses the phases of a session
+		/// @param phases A comma separated list of phases, each a slash
+		/// separated list of bitrate=<bitrate>, rate=<packets/s>,
+		/// size=<payload bytes> and time=<seconds>. A size overrides the
+		/// bitrate, and what a phase leaves out comes from the defaults
+		/// @param bitRate The default bitrate
+		/// @param packetRate The default packet rate
+		/// @param time The default seconds
+		/// @param headerSize The header size, which counts towards the bitrate
+		/// @throws std::runtime_error
+		/// @return The phases, in order
+		static std::vector<PhaseSpec> ParsePhases(const std::string& phases,
+			const std::string& bitRate, uint32_t packetRate, uint32_t time, size_t headerSize);
+		/// @brief Parses a payload size range
+		/// @param sizes The range, as <size> or <min>:<max>
+		/// @param minSize The smallest payload size
+		/// @param maxSize The largest payload size
+		/// @throws std::runtime_error
+		static void ParseSizeRange(const std::string& sizes, uint32_t& minSize, uint32_t& maxSize);
 
 		/// @brief Reads a response from the control socket
 		void ReadControl() noexcept;
 		/// @brief Writes a request to the control socket
 		void WriteControl() noexcept;
+		/// @brief Opens the local transport socket towards the server's
+		/// and starts the test
+		/// @param endpoint The server's transport endpoint
+		void OpenTransportLayer(const UDPProto_t::endpoint& endpoint) noexcept;
 
 		/// @brief Reads an ack from the transport socket
 		void ReadTransport() noexcept;
-		/// @brief Writes the random packed to the socket
-		void WriteTransport() noexcept;
+		/// @brief Writes the next random packet to the socket from the send ring
+		/// @param now The time the send is issued at, as GetNow gets it
+		/// @param payloadSize The payload size of the packet
+		void WriteTransport(std::chrono::nanoseconds now, uint32_t payloadSize) noexcept;
 		/// @brief Closes the transport layer
 		void CloseTransportLayer() noexcept;
-		/// @brief Processes the transport queue
+		/// @brief Handles a send slot that is due according to the catch-up policy
+		void ProcessSendSlot() noexcept;
+		/// @brief Sends any slots that were waiting on a free send ring entry
 		void ProcessTransportQueue() noexcept;
 
+		/// @brief Discovers the path MTU by probing with DF set
+		void DiscoverPathMtu() noexcept;
+		/// @brief Bisects to the next path MTU probe, or finishes discovery
+		void ProbePathMtu() noexcept;
+		/// @brief Sends a path MTU probe and waits for its ack
+		/// @param udpSize The UDP payload size of the probe
+		void SendProbe(uint32_t udpSize) noexcept;
+		/// @brief Handles an acknowledged path MTU probe
+		/// @param udpSize The UDP payload size of the probe
+		void HandleProbeAck(uint32_t udpSize) noexcept;
+		/// @brief Handles a lost or rejected path MTU probe
+		/// @param udpSize The UDP payload size of the probe
+		void HandleProbeFailure(uint32_t udpSize) noexcept;
+		/// @brief Checks whether a payload size fragments on the path
+		/// @param payloadSize The payload size
+		/// @return True if the datagram is larger than the path MTU
+		bool IsFragmented(uint32_t payloadSize) const noexcept;
+
+		/// @brief Announces the current phase to the server, which starts it
+		/// once acknowledged. The warm-up and a reflector start right away
+		void BeginPhase() noexcept;
+		/// @brief Starts the current phase, or the warm-up
+		void StartPhase() noexcept;
+		/// @brief Stops sending and waits for the phase's acks to drain
+		void EndPhase() noexcept;
+		/// @brief Ends the warm-up, forgetting everything it sent, and
+		/// starts the first phase once the server's drops are known
+		void EndWarmup() noexcept;
+		/// @brief Records the phase's results and moves on to the next phase,
+		/// or closes the test after the last
+		void FinishPhase() noexcept;
+		/// @brief Asks the server for its kernel drops
+		void RequestServerStats() noexcept;
+		/// @brief Takes the server's drops for the phase that just ended and
+		/// finishes it
+		void HandleServerStats() noexcept;
+		/// @brief Samples the local kernel counters at the start of a phase
+		void SampleKernelCounters() noexcept;
+		/// @brief Takes the local kernel counters' change over the phase
+		void DiffKernelCounters() noexcept;
+		/// @brief Sizes socket buffers to hold twice the bandwidth-delay
+		/// product, padding the delay with scheduling slack
+		/// @param bytesPerSecond The send rate
+		/// @param rtt The round trip time
+		/// @return The buffer size in bytes
+		static uint32_t SizeBuffer(uint64_t bytesPerSecond, Clock_t::duration rtt) noexcept;
+
 		/// @brief Awaits the packet finish
 		void AwaitFinish() noexcept;
 		/// @brief Awaits the socket print
 		void AwaitPrint() noexcept;
+
+		/// @brief How often interval stats are reported
+		static constexpr std::chrono::milliseconds PrintInterval{ 200 };
+		/// @brief The loss window covers this many seconds of sends, an ack
+		/// later than that counts as lost
+		static constexpr size_t LossWindowSeconds = 2;
+		static constexpr size_t LossWindowMin = 4096;
+		/// @brief Time a receiver may stall on top of the round trip before
+		/// its socket buffer has to absorb the traffic
+		static constexpr std::chrono::milliseconds BufferSlack{ 10 };
+		static constexpr uint32_t MinBufferSize = 256 * 1024;
+		static constexpr uint32_t MaxBufferSize = 64 * 1024 * 1024;
 		/// @brief Awaits the next send
 		void AwaitNextSend() noexcept;
+		/// @brief Gets the time since the high resolution clock's epoch, as
+		/// the pacer and the ack tracker take it
+		static std::chrono::nanoseconds GetNow() noexcept
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock_t::now().time_since_epoch());
+		}
 
+		/// @brief Publishes the stats of an interval to the metrics segment.
+		/// Runs on the reporter thread
+		/// @param stats The interval stats
+		void PublishIntervalStats(const IntervalStats& stats) noexcept;
+		/// @brief Adds the stats of an interval to the soak recorder, a
+		/// second at a time. Runs on the reporter thread
+		/// @param stats The interval stats
+		void RecordSoak(const IntervalStats& stats) noexcept;
+		/// @brief Gives up on every seq still in flight, counting the lost
+		/// in the interval
+		void FinalizeLoss() noexcept;
 		/// @brief Prints end stats
 		void PrintEndStats() noexcept;
-		
-		/// @brief Converts a bit count to string, compressing as necessary
-		/// @param bits The number of bits
-		/// @return A string representing the bit count
-		static std::string BitsToString(uint64_t bits) noexcept;
+		/// @brief Adds the phase that just ended to the totals
+		/// @param elapsed How long the phase ran
+		void AccumulateTotals(Clock_t::duration elapsed) noexcept;
+		/// @brief Prints how much of the loss the network, the receive
+		/// queues and the send queue each account for
+		/// @param lost The packets lost in the phase
+		void PrintLossAttribution(uint64_t lost) noexcept;
+		/// @brief Prints the loss episodes, their lengths and the fitted model
+		void PrintLossStats() noexcept;
+		/// @brief Prints the per-size results of a sweep
+		void PrintSweepStats() noexcept;
+		/// @brief Prints the mean, deviation and confidence interval of
+		/// each payload size's repeated runs
+		void PrintRepeatStats() noexcept;
+		/// @brief Prints what the session spent outside of phases: the
+		/// connect, the handshake, the transport setup and the phase changes
+		void PrintSessionStats() noexcept;
+
 
-		asio::io_context m_worker;
+		std::unique_ptr<asio::io_context> m_ownWorker;
+		asio::io_context& m_worker;
 		TCPSocket_t m_controlSocket;
 		UDPSocket_t m_transportSocket;
 		UDPProto_t::endpoint m_transportEndpoint;
 		asio::signal_set m_signals;
 		Detail::Request m_request;
 		Detail::Response m_response;
-		Detail::RandomPacket m_randomPacket;
+		std::vector<Detail::RandomPacket> m_sendRing;
 		Detail::PacketAck m_packetAck;
 		asio::steady_timer m_endTimer;
 		asio::steady_timer m_printTimer;
 		asio::high_resolution_timer m_sendTimer;
+		asio::steady_timer m_probeTimer;
 		std::chrono::high_resolution_clock::time_point m_start;
 		std::chrono::high_resolution_clock::duration m_timeBetweenSend;
-		std::unordered_map<uint32_t, std::chrono::high_resolution_clock::time_point> m_sendTimes;
-		std::chrono::high_resolution_clock::duration m_totalRecvTime;
-		std::chrono::high_resolution_clock::duration m_maxRecvTime;
-		std::chrono::high_resolution_clock::duration m_recvTimeSinceLastCheck;
-		std::chrono::high_resolution_clock::duration m_maxRecvTimeSinceLastCheck;
-		uint32_t m_pending;
+		Detail::Histogram m_latency;
+		/// @brief The accounting of the phase's sends and acks, on the
+		/// high resolution clock's epoch
+		Detail::AckTracker m_ackTracker;
+		IntervalStats m_interval;
+		std::unique_ptr<Detail::MetricsSegment> m_ownMetrics;
+		Detail::MetricsSegment* m_metrics;
+		uint32_t m_metricsSlot;
+		std::array<uint64_t, Detail::MetricsSegment::CounterCount> m_metricsCounters;
+		Detail::Histogram m_metricsLatency;
+		std::unique_ptr<Detail::SoakRecorder> m_soak;
+		Detail::SoakWindow m_soakSecond;
+		uint64_t m_soakIntervals;
+		std::unique_ptr<Detail::Reporter<IntervalStats>> m_ownReporter;
+		Detail::Reporter<IntervalStats>& m_reporter;
+		/// @brief The client's target, as address:port, or the name it was
+		/// given in a fan-out
+		std::string m_target;
+		uint32_t m_targetIndex;
+		Totals m_totals;
+		Detail::CpuMeter m_cpuMeter;
+		Detail::CpuMeter::Usage m_phaseCpu;
+		std::unique_ptr<Detail::EventLog> m_eventLog;
+		size_t m_sendHead;
+		size_t m_inFlight;
+		std::unique_ptr<Detail::TrafficModel> m_trafficModel;
+		/// @brief The send slots of the phase, on the high resolution clock's epoch
+		Detail::SendPacer m_pacer;
 		uint32_t m_packetSize;
-		uint32_t m_seq;
-		uint32_t m_ack;
+		std::vector<PhaseSpec> m_phases;
+		size_t m_phaseIndex;
+		uint32_t m_repeat;
+		uint32_t m_repeatIndex;
+		std::chrono::milliseconds m_warmup;
+		bool m_warmingUp;
+		std::vector<PhaseResult> m_phaseResults;
+		Detail::RandomPacket m_probePacket;
+		uint32_t m_probeLow;
+		uint32_t m_probeHigh;
+		uint32_t m_probeSize;
+		uint32_t m_probeTries;
+		uint32_t m_pathMtu;
+		bool m_reflector;
+		bool m_integrity;
+		bool m_fresh;
+		/// @brief The packet header fields negotiated with the server
+		Detail::FieldSet m_fields;
+		size_t m_headerSize;
+		/// @brief The stream id packets carry, acks with another are dropped
+		uint16_t m_streamId;
+		uint8_t m_tos;
+		uint8_t m_priority;
+		uint32_t m_payloadSeed;
+		uint64_t m_bytesPerSecond;
+		uint32_t m_bufferSize;
+		Clock_t::time_point m_connectStart;
+		/// @brief The TCP connect, the open request's round trip and the
+		/// transport's setup up to the first phase, timed apart
+		Clock_t::duration m_connectTime;
+		Clock_t::time_point m_handshakeStart;
+		Clock_t::duration m_handshakeTime;
+		/// @brief Cleared once the first phase starts
+		Clock_t::time_point m_setupStart;
+		Clock_t::duration m_setupTime;
+		/// @brief When the last phase stopped sending, and the time from
+		/// there to the next phase's start over every change
+		Clock_t::time_point m_phaseEnd;
+		Clock_t::duration m_phaseChangeTime;
+		uint32_t m_phaseChanges;
+		uint32_t m_serverDrops;
+		uint64_t m_phaseServerDrops;
+		uint64_t m_clientDrops;
+		uint64_t m_phaseClientDrops;
+		Detail::UdpCounters m_udpCounters;
+		Detail::UdpCounters m_phaseUdpCounters;
+		bool m_dropsSampled;
+		uint64_t m_sendDropped;
 		uint32_t m_time;
 		uint64_t m_totalBytes;
-		uint64_t m_bytesSinceLastCheck;
-		uint32_t m_packetsSinceLastCheck;
 	};
 }
 
@@ -1,7 +1,7 @@
 #ifndef UDPTEST_COMMON_H_
 #define UDPTEST_COMMON_H_
 
-#ifdef UDPTEST_DEBUG
+#if defined(UDPTEST_DEBUG) || defined(UDPTEST_PACKET_LOG)
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
 #else
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
@@ -10,4 +10,13 @@
 // spdlog includes
 #include <spdlog/spdlog.h>
 
+// Logging every datagram costs a format and a sink write per packet, even in
+// debug builds, so per-packet logs only exist when built with UDPTEST_PACKET_LOG.
+// Use an event log to trace packets in any other build
+#ifdef UDPTEST_PACKET_LOG
+#define UDPTEST_PACKET_DEBUG(...) SPDLOG_DEBUG(__VA_ARGS__)
+#else
+#define UDPTEST_PACKET_DEBUG(...) (void)0
+#endif
+
 #endif
\ No newline at end of file
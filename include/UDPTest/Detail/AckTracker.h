@@ -0,0 +1,135 @@
+#ifndef UDPTEST_DETAIL_ACKTRACKER_H_
+#define UDPTEST_DETAIL_ACKTRACKER_H_
+
+/// @file
+/// Ack Tracker
+/// 10/19/26 23:20
+
+// UDPTest includes
+#include <UDPTest/Detail/LossTracker.h>
+
+// STL includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief AckTracker accounts for the seqs a client sends and the
+		/// acks that come back: loss, round trips, jitter, reordering,
+		/// duplicates and corruption. It never reads a clock, every time is
+		/// handed in, so a client and a simulation of one share it
+		class AckTracker
+		{
+		public:
+			using Duration_t = std::chrono::nanoseconds;
+
+			/// @brief What an ack turned out to be
+			enum class Outcome : uint8_t
+			{
+				/// @brief The first ack of a seq in flight, timed
+				Received,
+				/// @brief An ack of the phase for a seq already given up on as
+				/// lost, counted apart and not timed
+				Late,
+				/// @brief An ack of a seq acked before
+				Duplicate,
+				/// @brief The first ack of a seq in flight whose packet the
+				/// server found corrupted
+				Corrupt,
+				/// @brief An ack of a seq sent before the phase, ignored
+				Straggler,
+				/// @brief An ack of a seq not sent yet, ignored
+				Unsent
+			};
+
+			struct Ack
+			{
+				/// @brief The seq, extended from the wire
+				uint64_t seq;
+				Outcome outcome;
+				/// @brief The round trip of a received ack
+				Duration_t latency;
+			};
+
+			/// @param window The number of seqs that can be in flight
+			/// @param echoesTimestamp Whether acks echo the send timestamp,
+			/// which is preferred over the send time kept for the seq
+			/// @param firstSeq The first seq to send
+			AckTracker(size_t window, bool echoesTimestamp, uint64_t firstSeq);
+
+			/// @brief Starts a phase at the next seq, clearing every stat
+			/// @param now The start of the phase, loss episodes are timed from it
+			void BeginPhase(Duration_t now) noexcept;
+			/// @brief Accounts for sending the next seq
+			/// @param now The send time
+			/// @return The seqs given up on as lost to make room for it
+			uint64_t OnSend(Duration_t now) noexcept;
+			/// @brief Accounts for an ack
+			/// @param wireSeq The seq the ack carries
+			/// @param corrupt Whether the server found the packet corrupted
+			/// @param echoedNs The send timestamp the ack echoes, if it does
+			/// @param now The arrival time
+			/// @return What the ack turned out to be
+			Ack OnAck(uint32_t wireSeq, bool corrupt, uint64_t echoedNs, Duration_t now) noexcept;
+			/// @brief Gives up on every seq still in flight
+			/// @return The seqs lost
+			uint64_t FinalizeLoss() noexcept;
+			/// @brief Closes the loss runs still open at the end of a phase
+			void Close() noexcept { m_lossTracker.Close(); }
+
+			/// @brief Gets the next seq to send, in 64 bits so it never wraps
+			uint64_t GetNextSeq() const noexcept { return m_seq; }
+			/// @brief Gets the seqs sent in the phase
+			uint64_t GetSent() const noexcept { return m_seq - m_phaseFirstSeq; }
+			/// @brief Gets the seqs of the phase acked intact and timed. A seq
+			/// is acked, corrupted or lost, never two of them
+			uint64_t GetAcked() const noexcept { return m_acked; }
+			uint64_t GetCorrupted() const noexcept { return m_corrupted; }
+			/// @brief Gets the acks of seqs already counted lost, copies included
+			uint64_t GetLateAcks() const noexcept { return m_lateAcks; }
+			/// @brief Gets the acks that arrived after a later seq's, as RFC
+			/// 4737 counts reordering, and how far back the furthest was
+			uint64_t GetReordered() const noexcept { return m_reordered; }
+			uint64_t GetMaxDisplacement() const noexcept { return m_maxDisplacement; }
+			uint64_t GetDuplicates() const noexcept { return m_duplicates; }
+			Duration_t GetTotalLatency() const noexcept { return m_totalLatency; }
+			Duration_t GetMaxLatency() const noexcept { return m_maxLatency; }
+			/// @brief Gets the RFC 3550 interarrival jitter of the phase, over
+			/// the round trips of consecutive acks
+			Duration_t GetJitter() const noexcept { return m_jitter; }
+			const LossTracker& GetLossTracker() const noexcept { return m_lossTracker; }
+		private:
+			/// @brief Finalizes the loss of every seq before a seq
+			/// @param endSeq The first seq to leave in flight
+			/// @return The seqs lost
+			uint64_t FinalizeLoss(uint64_t endSeq) noexcept;
+
+			LossTracker m_lossTracker;
+			/// @brief The send time of each seq in the loss window, indexed by
+			/// the seq modulo the window
+			std::vector<Duration_t> m_sendTimes;
+			bool m_echoesTimestamp;
+			Duration_t m_phaseStart;
+			uint64_t m_seq;
+			uint64_t m_phaseFirstSeq;
+			uint64_t m_acked;
+			uint64_t m_corrupted;
+			uint64_t m_lateAcks;
+			uint64_t m_reordered;
+			uint64_t m_maxDisplacement;
+			uint64_t m_highestAcked;
+			uint64_t m_duplicates;
+			Duration_t m_totalLatency;
+			Duration_t m_maxLatency;
+			Duration_t m_jitter;
+			bool m_lastLatencySeen;
+			Duration_t m_lastLatency;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef UDPTEST_DETAIL_CHECKSUM_H_
+#define UDPTEST_DETAIL_CHECKSUM_H_
+
+/// @file
+/// Checksum
+/// 10/19/26 16:10
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief Computes the CRC32C (Castagnoli) of a buffer. Uses the
+		/// SSE4.2 or ARMv8 crc32c instructions when the CPU has them and a
+		/// table otherwise
+		/// @param data The buffer
+		/// @param size The size of the buffer
+		/// @param crc The CRC of the preceding bytes, to checksum a
+		/// datagram in pieces
+		/// @return The CRC of the preceding bytes and the buffer
+		uint32_t Crc32c(const void* data, size_t size, uint32_t crc = 0) noexcept;
+
+		/// @brief Checks if Crc32c runs on hardware instructions
+		bool IsCrc32cAccelerated() noexcept;
+	}
+}
+
+#endif
\ No newline at end of file
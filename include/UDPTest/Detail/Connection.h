@@ -7,13 +7,20 @@
 
 // UDPTest includes
 #include <UDPTest/Detail/Control.h>
+#include <UDPTest/Detail/EventLog.h>
+#include <UDPTest/Detail/Histogram.h>
+#include <UDPTest/Detail/Impairment.h>
+#include <UDPTest/Detail/ReceiveTracker.h>
+#include <UDPTest/Detail/TimingWheel.h>
 #include <UDPTest/Detail/Transport.h>
 
 // asio includes
 #include <asio.hpp>
 
 // STL includes
+#include <chrono>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace UDPTest
@@ -22,6 +29,48 @@ namespace UDPTest
 	{
 		class ConnectionManager;
 
+		/// @brief Statistics for a connection since the last collection
+		struct ConnectionStats
+		{
+			uint64_t packetsReceived = 0;
+			uint64_t bytesReceived = 0;
+			uint64_t acksSent = 0;
+			/// @brief Packets missing from the sequence since the connection opened
+			uint64_t lostTotal = 0;
+			size_t ackQueueDepth = 0;
+			size_t maxAckQueueDepth = 0;
+			/// @brief Acks dropped because the ack queue was full
+			uint64_t acksQueueDropped = 0;
+			/// @brief Acks sent and the nanoseconds from receiving their
+			/// packets to sending them. Their distribution is collected apart
+			uint64_t ackLatencySumNs = 0;
+			uint64_t ackLatencyMaxNs = 0;
+			/// @brief Packets that failed their integrity check
+			uint64_t packetsCorrupted = 0;
+			/// @brief Packets that failed their integrity check since the 
+			/// connection opened
+			uint64_t corruptedTotal = 0;
+			/// @brief Timed integrity checks, one in every VerifySampleInterval
+			uint64_t verifySamples = 0;
+			uint64_t verifySampleBytes = 0;
+			uint64_t verifySampleNs = 0;
+			/// @brief Acks the impairment stage dropped, sent twice and sent
+			/// ahead of the delay
+			uint64_t acksImpairDropped = 0;
+			uint64_t acksDuplicated = 0;
+			uint64_t acksReordered = 0;
+			/// @brief Acks being held back by the impairment stage
+			size_t acksHeld = 0;
+			/// @brief The stream id the connection's packets carry, which
+			/// names the client's traffic class, or 0 if they carry none
+			uint16_t streamId = 0;
+			/// @brief The TOS byte acks are marked with
+			uint8_t tos = 0;
+			/// @brief The RFC 3550 interarrival jitter of packets since the
+			/// connection opened, from their send timestamps, or 0 without
+			double jitterNs = 0;
+		};
+
 		/// @brief Connection represents a client connection
 		class Connection
 			: public std::enable_shared_from_this<Connection>
@@ -33,35 +82,129 @@ namespace UDPTest
 			using UDPProto_t = asio::ip::udp;
 			using UDPSocket_t = UDPProto_t::socket;
 
+			/// @brief Every this many integrity checks one is timed, timing
+			/// them all would cost about as much as the checks themselves
+			static constexpr uint64_t VerifySampleInterval = 16;
+			/// @brief The resolution of impairment delays, the tick of the
+			/// timing wheel holding delayed acks
+			static constexpr std::chrono::microseconds HoldTick{ 10 };
+			/// @brief The most acks waiting to be sent. Acks past it are
+			/// dropped rather than queued without bound. A power of two
+			static constexpr size_t AckQueueDepth = 1024;
+
 			/// @brief Creates a connection with a connected control socket
 			/// @param connectionManager The connection manager
 			/// @param socket The control socket
+			/// @param receiveDepth The number of concurrent transport receives. 
+			/// Requires: nonzero
+			/// @param eventLog The log to record packet events to, or null.
+			/// Must outlive the connection and only be recorded to from its thread
+			/// @param impairment The impairments to apply to acks
 			Connection(ConnectionManager& connectionManager,
-				TCPSocket_t socket) noexcept;
+				TCPSocket_t socket, size_t receiveDepth, EventLog* eventLog,
+				const ImpairmentConfig& impairment) noexcept;
 
 			/// @brief Starts the connection
 			void Start() noexcept;
 			/// @bried Stops the connection
 			void Stop() noexcept;
+
+			/// @brief Gets the remote address of the control socket
+			/// @return The remote address as a string
+			const std::string& GetRemoteAddress() const noexcept { return m_remoteAddress; }
+			/// @brief Collects the stats since the last collection and resets them
+			/// @param stats The collected stats
+			/// @param ackLatency The collected ack latency distribution
+			void CollectStats(ConnectionStats& stats, Histogram& ackLatency) noexcept;
 		private:
+			/// @brief A receive buffer with its own source endpoint
+			struct ReceiveSlot
+			{
+				RandomPacket packet;
+				UDPProto_t::endpoint endpoint;
+			};
+			/// @brief An ack waiting to be written to its endpoint
+			struct PendingAck
+			{
+				PacketAck ack;
+				UDPProto_t::endpoint endpoint;
+				std::chrono::steady_clock::time_point received;
+			};
+
 			/// @brief Reads the request from the control socket
 			void ReadControl() noexcept;
 			/// @brief Writes the response to the control socket
 			void WriteControl() noexcept;
+			/// @brief Opens the transport socket on the control port, or on a
+			/// port of its own if another transport holds it
+			/// @param ec The error code
+			void OpenTransport(ErrorCode_t& ec) noexcept;
 
-			/// @brief Reads from the transport socket
-			void ReadTransport() noexcept;
-			/// @brief Writes to the transport socket
+			/// @brief Reads from the transport socket into a receive slot
+			/// @param slot The index of the receive slot
+			void ReadTransport(size_t slot) noexcept;
+			/// @brief Writes the front of the ack queue to the transport socket
 			void WriteTransport() noexcept;
+			/// @brief Pushes an ack onto the ack queue, starting the writer
+			/// if it is idle
+			/// @param pending The ack
+			void QueueAck(const PendingAck& pending) noexcept;
+			/// @brief Drops, duplicates or holds an ack as the impairment
+			/// stage draws, queueing whatever goes out now
+			/// @param pending The ack
+			void ImpairAck(const PendingAck& pending) noexcept;
+			/// @brief Arms the hold timer for the wheel's next tick, unless
+			/// it is already armed for an earlier one
+			void ArmHoldTimer() noexcept;
+			/// @brief Queues the held acks that are due
+			void ReleaseHeldAcks() noexcept;
+			/// @brief Sizes the transport socket's buffers, warning if the
+			/// kernel grants less
+			/// @param size The size of each buffer in bytes
+			void SizeBuffers(uint32_t size) noexcept;
+			/// @brief Verifies the checksum and payload of a received packet, 
+			/// as negotiated, timing a sample of the checks
+			/// @param packet The received packet
+			/// @param bytes The size of the received datagram
+			/// @return Whether the packet is intact
+			bool VerifyPacket(const RandomPacket& packet, size_t bytes) noexcept;
 
 			ConnectionManager& m_connectionManager;
 			TCPSocket_t m_controlSocket;
 			UDPSocket_t m_transportSocket;
-			UDPProto_t::endpoint m_transportEndpoint;
+			std::string m_remoteAddress;
 			Detail::Request m_request;
 			Detail::Response m_response;
-			Detail::RandomPacket m_randomPacket;
-			Detail::PacketAck m_packetAck;
+			EventLog* m_eventLog;
+			std::vector<ReceiveSlot> m_receiveSlots;
+			/// @brief The fields acks echo back, as negotiated on open
+			FieldSet m_ackFields;
+			/// @brief A ring of AckQueueDepth acks, m_ackCount of them
+			/// waiting from m_ackHead on
+			std::vector<PendingAck> m_ackQueue;
+			size_t m_ackHead;
+			size_t m_ackCount;
+			bool m_writing;
+			ConnectionStats m_stats;
+			Histogram m_ackLatency;
+			ReceiveTracker m_receiveTracker;
+			bool m_verify;
+			bool m_checkPayload;
+			uint32_t m_payloadSeed;
+			uint64_t m_packetsVerified;
+			/// @brief The phases the client announced since it opened
+			uint32_t m_phases;
+			uint8_t m_tos;
+			uint8_t m_priority;
+			uint16_t m_streamId;
+			Impairment m_impairment;
+			bool m_impaired;
+			TimingWheel<PendingAck> m_heldAcks;
+			/// @brief Tick 0 of the wheel
+			std::chrono::steady_clock::time_point m_holdEpoch;
+			asio::steady_timer m_holdTimer;
+			bool m_holdTimerArmed;
+			uint64_t m_holdTimerTick;
 		};
 	}
 }
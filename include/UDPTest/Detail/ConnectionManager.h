@@ -37,6 +37,10 @@ namespace UDPTest
 
 			/// @brief Stops all connections and stop tracking them
 			void StopAll() noexcept;
+
+			/// @brief Gets the tracked connections
+			/// @return The set of tracked connections
+			const ConnectionSet_t& GetConnections() const noexcept { return m_connections; }
 		private:
 			ConnectionSet_t m_connections;
 		};
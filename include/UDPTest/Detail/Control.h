@@ -5,6 +5,9 @@
 /// Control
 /// 6/22/20 20:03
 
+// UDPTest includes
+#include <UDPTest/Detail/WireFormat.h>
+
 // asio includes
 #include <asio.hpp>
 
@@ -16,35 +19,127 @@ namespace UDPTest
 {
 	namespace Detail
 	{
+		/// @brief Request is a control request, packed into one buffer
 		class Request 
 		{
 		public:
 			enum Command : uint8_t
 			{
 				Open = 0x01,
-				Close = 0x02
+				Close = 0x02,
+				/// @brief Asks for the kernel drops of the transport socket
+				Stats = 0x03,
+				/// @brief Announces the next phase of a session over the open
+				/// transport, laid out on its own. See MakePhase
+				Phase = 0x04
+			};
+
+			enum Flags : uint8_t
+			{
+				/// @brief Payloads come from the generator seeded with the 
+				/// request's seed, the server regenerates and checks them
+				FreshPayload = 0x02
 			};
 
-			Request() = default;
-			Request(Command command, uint32_t payloadSize) 
-				: m_command(command), m_payloadSize(htonl(payloadSize)) {}
+			/// @brief The size of a request on the wire
+			static constexpr size_t Size = 16;
+
+			Request() noexcept : m_data{} {}
+			/// @param fields The packet header fields to use, packets are
+			/// sealed with a checksum the server verifies if it has one
+			Request(Command command, uint32_t payloadSize, uint8_t flags = 0,
+				uint32_t seed = 0, uint32_t bufferSize = 0,
+				FieldSet fields = BasePacketFields) noexcept : m_data{}
+			{
+				m_data[CommandOffset] = command;
+				m_data[FlagsOffset] = flags;
+				StoreBigEndian(m_data.data() + PayloadSizeOffset, payloadSize);
+				StoreBigEndian(m_data.data() + SeedOffset, seed);
+				StoreBigEndian(m_data.data() + BufferSizeOffset, bufferSize);
+				m_data[WireVersionOffset] = WireVersion;
+				m_data[FieldsOffset] = fields;
+			}
+
+			/// @brief Creates a phase request
+			/// @param payloadSize The phase's payload size
+			/// @param packetRate The phase's packets per second
+			/// @param duration The seconds the phase runs for
+			/// @param tos The TOS byte to mark the phase's acks with
+			/// @param priority The socket priority to send the phase's acks at
+			/// @return The request
+			static Request MakePhase(uint32_t payloadSize, uint32_t packetRate,
+				uint32_t duration, uint8_t tos, uint8_t priority) noexcept
+			{
+				Request request;
+				request.m_data[CommandOffset] = Command::Phase;
+				StoreBigEndian(request.m_data.data() + PayloadSizeOffset, payloadSize);
+				StoreBigEndian(request.m_data.data() + PacketRateOffset, packetRate);
+				StoreBigEndian(request.m_data.data() + DurationOffset, duration);
+				request.m_data[TosOffset] = tos;
+				request.m_data[PriorityOffset] = priority;
+				return request;
+			}
+
+			Command GetCommand() const noexcept { return static_cast<Command>(m_data[CommandOffset]); }
+
+			uint8_t GetFlags() const noexcept { return m_data[FlagsOffset]; }
+
+			uint32_t GetPayloadSize() const noexcept { return LoadBigEndian<uint32_t>(m_data.data() + PayloadSizeOffset); }
+
+			uint32_t GetSeed() const noexcept { return LoadBigEndian<uint32_t>(m_data.data() + SeedOffset); }
+
+			/// @brief Gets the socket buffer size the client sized for the
+			/// test, or 0 to keep the system default
+			uint32_t GetBufferSize() const noexcept { return LoadBigEndian<uint32_t>(m_data.data() + BufferSizeOffset); }
+
+			/// @brief Gets the packet rate of a phase
+			uint32_t GetPacketRate() const noexcept { return LoadBigEndian<uint32_t>(m_data.data() + PacketRateOffset); }
 
-			Command GetCommand() const noexcept { return m_command; }
+			/// @brief Gets the seconds a phase runs for
+			uint32_t GetDuration() const noexcept { return LoadBigEndian<uint32_t>(m_data.data() + DurationOffset); }
 
-			uint32_t GetPayloadSize() const noexcept { return ntohl(m_payloadSize); }
+			/// @brief Gets the TOS byte to mark a phase's acks with
+			uint8_t GetTos() const noexcept { return m_data[TosOffset]; }
 
-			std::array<asio::mutable_buffer, 2> GetBuffers()
+			/// @brief Gets the socket priority to send a phase's acks at
+			uint8_t GetPriority() const noexcept { return m_data[PriorityOffset]; }
+
+			/// @brief Gets the version of the packet layouts the client speaks
+			uint8_t GetWireVersion() const noexcept { return m_data[WireVersionOffset]; }
+
+			/// @brief Gets the packet header fields the client sends
+			FieldSet GetFields() const noexcept { return m_data[FieldsOffset] | BasePacketFields; }
+
+			asio::mutable_buffer GetBuffers() noexcept
 			{
-				return { 
-					asio::buffer(&m_command, 1),
-					asio::buffer(&m_payloadSize, 4) 
-				};
+				return asio::buffer(m_data);
 			}
 		private:
-			Command m_command;
-			uint32_t m_payloadSize;
+			enum Offset : size_t
+			{
+				CommandOffset = 0,
+				FlagsOffset = 1,
+				PayloadSizeOffset = 2,
+				SeedOffset = 6,
+				BufferSizeOffset = 10,
+				WireVersionOffset = 14,
+				FieldsOffset = 15
+			};
+
+			/// @brief Where a phase request keeps its fields. It shares the
+			/// command and payload size, the rest is its own
+			enum PhaseOffset : size_t
+			{
+				TosOffset = 1,
+				PacketRateOffset = 6,
+				DurationOffset = 10,
+				PriorityOffset = 14
+			};
+
+			std::array<uint8_t, Size> m_data;
 		};
 
+		/// @brief Response is a control response, packed into one buffer
 		class Response
 		{
 		public:
@@ -53,32 +148,55 @@ namespace UDPTest
 				OK,
 				AlreadyOpen,
 				FailedToOpen,
-				FailedToClose
+				FailedToClose,
+				/// @brief The client speaks another wire version
+				UnsupportedWire,
+				/// @brief Nothing is open, or the phase's payloads are larger
+				/// than the receives sized on open
+				InvalidPhase
 			};
 
-			Response() = default;
+			/// @brief The size of a response on the wire
+			static constexpr size_t Size = 11;
+
+			Response() noexcept : m_data{} {}
 			Response(Status status,
-				const asio::ip::udp::endpoint& endpoint) noexcept
-				: m_status(status), m_address(endpoint.address().to_v4().to_bytes()),
-				m_port(htons(endpoint.port())) {}
+				const asio::ip::udp::endpoint& endpoint, uint32_t drops = 0) noexcept
+				: m_data{}
+			{
+				m_data[StatusOffset] = status;
+				StoreBigEndian(m_data.data() + AddressOffset, endpoint.address().to_v4().to_uint());
+				StoreBigEndian(m_data.data() + PortOffset, endpoint.port());
+				StoreBigEndian(m_data.data() + DropsOffset, drops);
+			}
 
-			Status GetStatus() const noexcept { return m_status; }
+			Status GetStatus() const noexcept { return static_cast<Status>(m_data[StatusOffset]); }
+
+			/// @brief Gets the datagrams the kernel dropped on the server's
+			/// transport socket since it opened
+			uint32_t GetDrops() const noexcept { return LoadBigEndian<uint32_t>(m_data.data() + DropsOffset); }
 
 			asio::ip::udp::endpoint GetEndpoint() const noexcept
 			{
-				const asio::ip::address_v4 addr(m_address);
-				const uint16_t port(ntohs(m_port));
+				const asio::ip::address_v4 addr(LoadBigEndian<uint32_t>(m_data.data() + AddressOffset));
+				const uint16_t port(LoadBigEndian<uint16_t>(m_data.data() + PortOffset));
 				return asio::ip::udp::endpoint(addr, port);
 			}
 
-			std::array<asio::mutable_buffer, 3> GetBuffers()
+			asio::mutable_buffer GetBuffers() noexcept
 			{
-				return { asio::buffer(&m_status, 1), asio::buffer(m_address), asio::buffer(&m_port, 2) };
+				return asio::buffer(m_data);
 			}
 		private:
-			Status m_status;
-			asio::ip::address_v4::bytes_type m_address;
-			uint16_t m_port;
+			enum Offset : size_t
+			{
+				StatusOffset = 0,
+				AddressOffset = 1,
+				PortOffset = 5,
+				DropsOffset = 7
+			};
+
+			std::array<uint8_t, Size> m_data;
 		};
 	}
 }
@@ -0,0 +1,103 @@
+#ifndef UDPTEST_DETAIL_CPUMETER_H_
+#define UDPTEST_DETAIL_CPUMETER_H_
+
+/// @file
+/// CPU Meter
+/// 10/19/26 20:45
+
+// STL includes
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief CpuMeter measures the CPU time, context switches and,
+		/// optionally, hardware counters of the thread that starts it. Only
+		/// call it from that thread
+		class CpuMeter
+		{
+		public:
+			/// @brief The resources used since the meter was started
+			struct Usage
+			{
+				uint64_t userNs = 0;
+				uint64_t systemNs = 0;
+				uint64_t voluntarySwitches = 0;
+				uint64_t involuntarySwitches = 0;
+				/// @brief False if the hardware counters below weren't read
+				bool hardware = false;
+				uint64_t cycles = 0;
+				uint64_t instructions = 0;
+				uint64_t cacheMisses = 0;
+
+				uint64_t GetCpuNs() const noexcept { return userNs + systemNs; }
+
+				Usage operator-(const Usage& other) const noexcept
+				{
+					Usage delta = *this;
+					delta.userNs -= other.userNs;
+					delta.systemNs -= other.systemNs;
+					delta.voluntarySwitches -= other.voluntarySwitches;
+					delta.involuntarySwitches -= other.involuntarySwitches;
+					delta.cycles -= other.cycles;
+					delta.instructions -= other.instructions;
+					delta.cacheMisses -= other.cacheMisses;
+					return delta;
+				}
+			};
+
+			/// @brief Creates a meter
+			/// @param hardware Whether to open perf_event hardware counters
+			/// when started
+			explicit CpuMeter(bool hardware) noexcept;
+			CpuMeter(const CpuMeter&) = delete;
+			CpuMeter& operator=(const CpuMeter&) = delete;
+			~CpuMeter();
+
+			/// @brief Starts measuring the calling thread from now, opening
+			/// the hardware counters the first time
+			void Start() noexcept;
+			/// @brief Reads the usage since the last start
+			/// @return The usage
+			Usage Read() const noexcept;
+
+			/// @brief Logs usage normalized to the traffic it carried
+			/// @param usage The usage
+			/// @param packets The packets handled
+			/// @param bytes The bytes handled
+			/// @param elapsed The wall time the usage covers
+			static void Report(const Usage& usage, uint64_t packets, uint64_t bytes,
+				std::chrono::nanoseconds elapsed) noexcept;
+
+			/// @brief Gets why the hardware counters could not be opened
+			/// @return The reason, or empty if they are open or weren't asked for
+			const std::string& GetHardwareError() const noexcept { return m_hardwareError; }
+		private:
+			enum HardwareCounter
+			{
+				Cycles,
+				Instructions,
+				CacheMisses,
+				HardwareCounterCount
+			};
+
+			/// @brief Opens the hardware counters for the calling thread
+			void OpenHardware() noexcept;
+			/// @brief Reads the usage since the thread started
+			/// @return The usage
+			Usage ReadTotal() const noexcept;
+
+			bool m_hardware;
+			bool m_opened;
+			std::array<int, HardwareCounterCount> m_fds;
+			std::string m_hardwareError;
+			Usage m_start;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#ifndef UDPTEST_DETAIL_EVENTLOG_H_
+#define UDPTEST_DETAIL_EVENTLOG_H_
+
+/// @file
+/// Event Log
+/// 10/19/26 18:40
+
+// UDPTest includes
+#include <UDPTest/Detail/SPSCQueue.h>
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief What happened to a packet
+		enum class EventType : uint8_t
+		{
+			PacketSent = 1,
+			AckReceived,
+			AckCorrupt,
+			PacketReceived,
+			PacketCorrupt,
+			AckSent,
+			/// @brief Written last, its value is the number of events dropped
+			/// because the writer fell behind
+			Dropped
+		};
+
+		/// @brief A fixed-size binary record of a packet event
+		struct Event
+		{
+			/// @brief Nanoseconds since the log was opened
+			uint64_t timeNs;
+			uint32_t seq;
+			/// @brief The datagram size
+			uint32_t bytes;
+			/// @brief A latency in nanoseconds for acks, saturating at
+			/// about 4.29 seconds
+			uint32_t value;
+			/// @brief The remote UDP port on a server, 0 on a client
+			uint16_t flow;
+			EventType type;
+			uint8_t reserved;
+		};
+		static_assert(sizeof(Event) == 24, "Events are written as is");
+
+		/// @brief EventLog records packet events from one thread without
+		/// formatting or blocking. Events are copied into a ring that a writer
+		/// thread drains into a binary file, which Decode turns into text
+		/// offline. If the writer falls behind, events are dropped and counted
+		class EventLog
+		{
+		public:
+			static constexpr size_t QueueSize = 65536;
+			/// @brief "UEVT"
+			static constexpr uint32_t Magic = 0x54564555;
+			static constexpr uint16_t Version = 1;
+
+			/// @brief Creates the log file
+			/// @param path The path of the file, truncated if it exists
+			/// @throws std::runtime_error
+			explicit EventLog(const std::string& path);
+			EventLog(const EventLog&) = delete;
+			EventLog& operator=(const EventLog&) = delete;
+			~EventLog() { Stop(); }
+
+			/// @brief Starts the writer thread
+			void Start();
+			/// @brief Stops the writer thread after writing what is queued
+			void Stop() noexcept;
+
+			/// @brief Records an event. Only call from the producer thread
+			/// @param type The event type
+			/// @param seq The sequence number
+			/// @param bytes The datagram size
+			/// @param value The latency in nanoseconds, or 0
+			/// @param flow The flow the event belongs to
+			void Record(EventType type, uint32_t seq, uint32_t bytes,
+				uint64_t value = 0, uint16_t flow = 0) noexcept
+			{
+				Event event;
+				event.timeNs = static_cast<uint64_t>(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - m_start).count());
+				event.seq = seq;
+				event.bytes = bytes;
+				event.value = static_cast<uint32_t>(std::min<uint64_t>(value, UINT32_MAX));
+				event.flow = flow;
+				event.type = type;
+				event.reserved = 0;
+				if (m_queue->TryPush(event) == false)
+					m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1,
+						std::memory_order_relaxed);
+			}
+
+			/// @brief Gets the number of events dropped because the queue was full
+			uint64_t GetDropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+			/// @brief Gets the number of events written to the file
+			uint64_t GetWritten() const noexcept { return m_written.load(std::memory_order_relaxed); }
+
+			/// @brief Decodes a log file into one line per event
+			/// @param path The path of the file
+			/// @param os The stream to write to
+			/// @throws std::runtime_error
+			static void Decode(const std::string& path, std::ostream& os);
+		private:
+			/// @brief The file header
+			struct Header
+			{
+				uint32_t magic;
+				uint16_t version;
+				uint16_t eventSize;
+				/// @brief The wall clock time the log was opened, in
+				/// nanoseconds since the epoch
+				uint64_t startNs;
+			};
+
+			/// @brief Writes events until stopped
+			void Run() noexcept;
+			/// @brief Writes every queued event
+			void Drain() noexcept;
+
+			std::ofstream m_file;
+			std::chrono::steady_clock::time_point m_start;
+			std::unique_ptr<SPSCQueue<Event, QueueSize>> m_queue;
+			std::thread m_thread;
+			std::atomic<bool> m_running;
+			std::atomic<uint64_t> m_dropped;
+			std::atomic<uint64_t> m_written;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+#ifndef UDPTEST_DETAIL_FLOWTABLE_H_
+#define UDPTEST_DETAIL_FLOWTABLE_H_
+
+/// @file
+/// Flow Table
+/// 10/19/26 17:05
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief A source endpoint, with IPv4 addresses mapped into IPv6
+		struct FlowKey
+		{
+			std::array<uint8_t, 16> address{};
+			/// @brief The source port, 0 marks an empty bucket
+			uint16_t port = 0;
+
+			/// @brief Gets whether the key marks an empty bucket
+			bool IsEmpty() const noexcept { return port == 0; }
+
+			bool operator==(const FlowKey& other) const noexcept
+			{
+				return port == other.port && address == other.address;
+			}
+		};
+
+		/// @brief The state a reflector keeps for one source endpoint
+		struct FlowState
+		{
+			FlowKey key;
+			/// @brief The seqs extended to 64 bits, so the sequence survives
+			/// the wire seq wrapping
+			uint64_t firstSeq = 0;
+			uint64_t highestSeq = 0;
+			uint64_t packetsReceived = 0;
+			/// @brief The reflector tick the flow last sent in
+			uint32_t lastSeen = 0;
+
+			/// @brief Gets the packets missing from the flow's sequence
+			uint64_t GetLost() const noexcept
+			{
+				const uint64_t expected = highestSeq - firstSeq + 1;
+				return (expected > packetsReceived) ? expected - packetsReceived : 0;
+			}
+		};
+
+		/// @brief FlowTable is a flat open-addressing hash table of flows with
+		/// linear probing. It never allocates after construction and erases
+		/// by shifting entries back, so lookups stay short without tombstones
+		class FlowTable
+		{
+		public:
+			/// @brief Creates a table
+			/// @param maxFlows The most flows the table holds, it keeps at
+			/// least twice as many buckets
+			explicit FlowTable(size_t maxFlows);
+
+			/// @brief Makes the key of an IPv4 or IPv6 endpoint
+			/// @param endpoint The endpoint
+			/// @return The key, never empty for a real source
+			static FlowKey MakeKey(const asio::ip::udp::endpoint& endpoint) noexcept
+			{
+				FlowKey key;
+				const asio::ip::address& address = endpoint.address();
+				key.address = (address.is_v4() == true) ?
+					asio::ip::make_address_v6(asio::ip::v4_mapped, address.to_v4()).to_bytes() :
+					address.to_v6().to_bytes();
+				key.port = endpoint.port();
+				return key;
+			}
+
+			/// @brief Finds a flow, inserting an empty one if it isn't there
+			/// @param key The flow's key
+			/// @param inserted Set to whether the flow was inserted
+			/// @return The flow, or nullptr if it is new and the table is full
+			FlowState* FindOrInsert(const FlowKey& key, bool& inserted) noexcept;
+
+			/// @brief Removes every flow last seen before a tick
+			/// @param cutoff The oldest tick a flow may have been seen in to stay
+			/// @param onEvict Called with each flow before it is removed
+			/// @return The number of flows removed
+			template<typename Function_t>
+			size_t Evict(uint32_t cutoff, Function_t&& onEvict) noexcept
+			{
+				size_t evicted = 0;
+				for (size_t i = 0; i < m_buckets.size(); ++i)
+				{
+					// an erase shifts a later flow into this bucket, so look again
+					while (m_buckets[i].key.IsEmpty() == false && 
+						static_cast<int32_t>(m_buckets[i].lastSeen - cutoff) < 0)
+					{
+						onEvict(static_cast<const FlowState&>(m_buckets[i]));
+						Erase(i);
+						++evicted;
+					}
+				}
+				return evicted;
+			}
+
+			/// @brief Calls a function with every flow
+			/// @param function The function
+			template<typename Function_t>
+			void ForEach(Function_t&& function) const noexcept
+			{
+				for (const FlowState& flow : m_buckets)
+				{
+					if (flow.key.IsEmpty() == false)
+						function(flow);
+				}
+			}
+
+			/// @brief Gets the number of flows
+			size_t GetSize() const noexcept { return m_size; }
+			/// @brief Gets the most flows the table holds
+			size_t GetMaxSize() const noexcept { return m_maxSize; }
+		private:
+			/// @brief Gets the home bucket of a key
+			size_t Home(const FlowKey& key) const noexcept
+			{
+				uint64_t high;
+				uint64_t low;
+				std::memcpy(&high, key.address.data(), sizeof(high));
+				std::memcpy(&low, key.address.data() + sizeof(high), sizeof(low));
+				const uint64_t mixed = ((high * 0x9E3779B97F4A7C15ULL) ^ low ^ key.port) * 
+					0xC2B2AE3D27D4EB4FULL;
+				return static_cast<size_t>(mixed >> 32) & m_mask;
+			}
+
+			/// @brief Erases a bucket, shifting back the flows probed past it
+			/// @param index The bucket
+			void Erase(size_t index) noexcept;
+
+			std::vector<FlowState> m_buckets;
+			size_t m_mask;
+			size_t m_size;
+			size_t m_maxSize;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+#ifndef UDPTEST_DETAIL_HISTOGRAM_H_
+#define UDPTEST_DETAIL_HISTOGRAM_H_
+
+/// @file
+/// Histogram
+/// 10/19/26 13:45
+
+// STL includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief Histogram is a fixed-size log-linear histogram. Every power 
+		/// of two is split into 16 linear buckets, bounding the relative error
+		/// to ~6% over values up to 2^40
+		class Histogram
+		{
+		public:
+			static constexpr uint32_t SubBucketBits = 4;
+			static constexpr uint32_t SubBuckets = 1 << SubBucketBits;
+			static constexpr uint32_t MaxExponent = 40;
+			static constexpr uint32_t BucketCount = 
+				(MaxExponent - SubBucketBits + 1) * SubBuckets;
+
+			/// @brief Records a value
+			/// @param value The value
+			void Record(uint64_t value) noexcept
+			{
+				++m_counts[Index(value)];
+				++m_count;
+				if (value > m_max)
+					m_max = value;
+			}
+
+			/// @brief Adds every value of another histogram
+			/// @param other The other histogram
+			void Merge(const Histogram& other) noexcept
+			{
+				for (uint32_t i = 0; i < BucketCount; ++i)
+					m_counts[i] += other.m_counts[i];
+				m_count += other.m_count;
+				m_max = std::max(m_max, other.m_max);
+			}
+
+			/// @brief Adds values to a bucket directly, e.g. when rebuilding a copy
+			/// @param bucket The bucket index
+			/// @param count The number of values
+			void AddToBucket(uint32_t bucket, uint64_t count) noexcept
+			{
+				if (count == 0)
+					return;
+				m_counts[bucket] += count;
+				m_count += count;
+				m_max = std::max(m_max, GetBucketUpperBound(bucket));
+			}
+
+			/// @brief Clears every value
+			void Reset() noexcept
+			{
+				m_counts.fill(0);
+				m_count = 0;
+				m_max = 0;
+			}
+
+			/// @brief Gets the number of recorded values
+			uint64_t GetCount() const noexcept { return m_count; }
+			/// @brief Gets the largest recorded value
+			uint64_t GetMax() const noexcept { return m_max; }
+			/// @brief Gets the count of a bucket
+			/// @param bucket The bucket index
+			uint64_t GetBucketCount(uint32_t bucket) const noexcept { return m_counts[bucket]; }
+
+			/// @brief Gets the value at a percentile
+			/// @param percentile The percentile, from 0 to 100
+			/// @return The upper bound of the bucket the percentile lands in,
+			/// or 0 if there are no values
+			uint64_t GetPercentile(double percentile) const noexcept
+			{
+				if (m_count == 0)
+					return 0;
+				const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(
+					std::ceil(percentile / 100. * static_cast<double>(m_count))));
+				uint64_t seen = 0;
+				for (uint32_t i = 0; i < BucketCount; ++i)
+				{
+					seen += m_counts[i];
+					if (seen >= target)
+						return std::min(GetBucketUpperBound(i), m_max);
+				}
+				return m_max;
+			}
+
+			/// @brief Gets the bucket index a value falls in
+			/// @param value The value
+			/// @return The bucket index
+			static uint32_t Index(uint64_t value) noexcept
+			{
+				if (value < SubBuckets)
+					return static_cast<uint32_t>(value);
+				const uint32_t exponent = std::min(HighestBit(value), MaxExponent - 1);
+				if (exponent == MaxExponent - 1 && HighestBit(value) > exponent)
+					return BucketCount - 1;
+				const uint32_t shift = exponent - SubBucketBits;
+				return (exponent - SubBucketBits + 1) * SubBuckets +
+					static_cast<uint32_t>((value >> shift) & (SubBuckets - 1));
+			}
+
+			/// @brief Gets the lowest value of a bucket
+			/// @param bucket The bucket index
+			/// @return The lowest value that lands in the bucket
+			static uint64_t GetBucketLowerBound(uint32_t bucket) noexcept
+			{
+				if (bucket < SubBuckets)
+					return bucket;
+				const uint32_t group = bucket / SubBuckets;
+				const uint32_t shift = group - 1;
+				return static_cast<uint64_t>(SubBuckets + bucket % SubBuckets) << shift;
+			}
+
+			/// @brief Gets the highest value of a bucket
+			/// @param bucket The bucket index
+			/// @return The highest value that lands in the bucket
+			static uint64_t GetBucketUpperBound(uint32_t bucket) noexcept
+			{
+				if (bucket < SubBuckets)
+					return bucket;
+				const uint32_t shift = bucket / SubBuckets - 1;
+				return GetBucketLowerBound(bucket) + (uint64_t(1) << shift) - 1;
+			}
+		private:
+			/// @brief Gets the index of the highest set bit
+			/// @param value The value. Requires: nonzero
+			static uint32_t HighestBit(uint64_t value) noexcept
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanReverse64(&index, value);
+				return static_cast<uint32_t>(index);
+#else
+				return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+			}
+
+			std::array<uint64_t, BucketCount> m_counts{};
+			uint64_t m_count = 0;
+			uint64_t m_max = 0;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
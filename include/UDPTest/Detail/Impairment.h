@@ -0,0 +1,79 @@
+#ifndef UDPTEST_DETAIL_IMPAIRMENT_H_
+#define UDPTEST_DETAIL_IMPAIRMENT_H_
+
+/// @file
+/// Impairment
+/// 10/19/26 21:35
+
+// STL includes
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief The impairments applied to acks before they are sent
+		struct ImpairmentConfig
+		{
+			std::chrono::nanoseconds delay{ 0 };
+			/// @brief The most the delay varies either way, uniformly
+			std::chrono::nanoseconds jitter{ 0 };
+			/// @brief The chances, from 0 to 1, of dropping, sending without
+			/// delay and sending twice
+			double loss = 0;
+			double reorder = 0;
+			double duplicate = 0;
+
+			/// @brief Gets whether any impairment is set
+			bool IsEnabled() const noexcept
+			{
+				return delay.count() != 0 || jitter.count() != 0 ||
+					loss != 0 || reorder != 0 || duplicate != 0;
+			}
+
+			/// @brief Parses a description
+			/// @param spec Comma-separated delay=<ms>, jitter=<ms>, loss=<%>,
+			/// reorder=<%> and duplicate=<%>, or empty for none
+			/// @throws std::runtime_error
+			/// @return The config
+			static ImpairmentConfig Parse(const std::string& spec);
+		};
+
+		/// @brief Impairment draws what happens to each ack, the way netem
+		/// does: reordered acks skip the delay, so they overtake the acks
+		/// held before them
+		class Impairment
+		{
+		public:
+			explicit Impairment(const ImpairmentConfig& config) noexcept
+				: m_config(config) {}
+			/// @brief Creates an impairment whose draws replay for a seed
+			Impairment(const ImpairmentConfig& config, uint64_t seed) noexcept
+				: m_config(config), m_random(seed) {}
+
+			const ImpairmentConfig& GetConfig() const noexcept { return m_config; }
+
+			/// @brief Draws whether to drop an ack
+			bool Drop() noexcept { return Draw(m_config.loss); }
+			/// @brief Draws whether to send an ack twice
+			bool Duplicate() noexcept { return Draw(m_config.duplicate); }
+			/// @brief Draws how long to hold an ack
+			/// @param reordered Set to whether the ack skips the delay
+			/// @return The delay
+			std::chrono::nanoseconds Delay(bool& reordered) noexcept;
+		private:
+			bool Draw(double chance) noexcept
+			{
+				return chance != 0 && std::uniform_real_distribution<double>()(m_random) < chance;
+			}
+
+			ImpairmentConfig m_config;
+			std::mt19937_64 m_random{ std::random_device()() };
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef UDPTEST_DETAIL_KERNELCOUNTERS_H_
+#define UDPTEST_DETAIL_KERNELCOUNTERS_H_
+
+/// @file
+/// Kernel Counters
+/// 10/19/26 20:10
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <cstdint>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief The host-wide UDP error counters of /proc/net/snmp
+		struct UdpCounters
+		{
+			/// @brief Datagrams that could not be delivered, for any reason
+			uint64_t inErrors = 0;
+			/// @brief Datagrams dropped because a receive queue was full
+			uint64_t rcvbufErrors = 0;
+			/// @brief Sends that failed because a send buffer was full
+			uint64_t sndbufErrors = 0;
+
+			UdpCounters operator-(const UdpCounters& other) const noexcept
+			{
+				UdpCounters delta;
+				delta.inErrors = inErrors - other.inErrors;
+				delta.rcvbufErrors = rcvbufErrors - other.rcvbufErrors;
+				delta.sndbufErrors = sndbufErrors - other.sndbufErrors;
+				return delta;
+			}
+		};
+
+		/// @brief Gets the number of datagrams the kernel dropped because a
+		/// socket's receive queue was full. This is the counter SO_RXQ_OVFL
+		/// hands out with each datagram, read from /proc/net/udp instead
+		/// since asio's receives don't surface ancillary data
+		/// @param socket The socket
+		/// @param ec The error code
+		/// @return The drops since the socket was opened
+		uint64_t GetSocketDrops(asio::ip::udp::socket& socket,
+			asio::error_code& ec) noexcept;
+
+		/// @brief Reads the host's UDP error counters
+		/// @param ec The error code
+		/// @return The counters since boot
+		UdpCounters GetUdpCounters(asio::error_code& ec) noexcept;
+	}
+}
+
+#endif
\ No newline at end of file
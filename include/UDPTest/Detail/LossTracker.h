@@ -0,0 +1,139 @@
+#ifndef UDPTEST_DETAIL_LOSSTRACKER_H_
+#define UDPTEST_DETAIL_LOSSTRACKER_H_
+
+/// @file
+/// Loss Tracker
+/// 10/19/26 17:50
+
+// UDPTest includes
+#include <UDPTest/Detail/Histogram.h>
+
+// STL includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief LossTracker turns acks into loss runs. Acks set bits in a
+		/// sliding bitmap over the seqs in flight, and seqs that fall out of
+		/// the window are final: received or lost. Everything it keeps is
+		/// bounded by the window and the episode history
+		class LossTracker
+		{
+		public:
+			/// @brief The most recent episodes kept for the time series
+			static constexpr size_t EpisodeHistory = 256;
+
+			/// @brief A run of consecutive lost packets
+			struct Episode
+			{
+				/// @brief When the first packet of the run was sent, from the
+				/// start of the phase
+				int64_t startNs;
+				uint64_t firstSeq;
+				uint32_t length;
+			};
+
+			/// @brief A fitted Gilbert-Elliott model. The good state loses
+			/// nothing, the bad state delivers with probability h
+			struct GilbertElliott
+			{
+				/// @brief The chance of moving from the good to the bad state
+				double p;
+				/// @brief The chance of moving from the bad to the good state
+				double r;
+				/// @brief The chance of delivery in the bad state
+				double h;
+				/// @brief False if there were too few bursts to fit h, in which
+				/// case h is 0 and p and r describe the simple Gilbert model
+				bool fitted;
+			};
+
+			/// @brief Creates a tracker
+			/// @param window The number of seqs that can be in flight, rounded
+			/// up to a multiple of 64
+			explicit LossTracker(size_t window);
+
+			/// @brief Clears every stat and starts tracking at a seq
+			/// @param firstSeq The first seq to track
+			void Reset(uint64_t firstSeq) noexcept;
+
+			/// @brief Marks a seq as received. Seqs outside the window are ignored
+			/// @param seq The seq
+			void OnReceived(uint64_t seq) noexcept
+			{
+				if (seq - m_nextSeq < m_window)
+					m_bitmap[(seq % m_window) / 64] |= uint64_t(1) << (seq % 64);
+			}
+
+			/// @brief Gets whether a seq was marked received
+			/// @param seq The seq
+			/// @return False if it wasn't, or is outside the window
+			bool IsReceived(uint64_t seq) const noexcept
+			{
+				return seq - m_nextSeq < m_window &&
+					(m_bitmap[(seq % m_window) / 64] & (uint64_t(1) << (seq % 64))) != 0;
+			}
+
+			/// @brief Finalizes the oldest unfinalized seq
+			/// @param sentNs When the seq was sent, from the start of the phase
+			void Finalize(int64_t sentNs) noexcept;
+
+			/// @brief Closes the runs still open, e.g. at the end of a phase
+			void Close() noexcept;
+
+			/// @brief Gets the next seq to be finalized
+			uint64_t GetNextSeq() const noexcept { return m_nextSeq; }
+			/// @brief Gets the number of seqs that can be in flight
+			uint32_t GetWindow() const noexcept { return m_window; }
+			/// @brief Gets the number of finalized seqs
+			uint64_t GetFinalized() const noexcept { return m_finalized; }
+			/// @brief Gets the number of finalized seqs that were lost
+			uint64_t GetLost() const noexcept { return m_lost; }
+			/// @brief Gets the number of loss episodes
+			uint64_t GetEpisodeCount() const noexcept { return m_bursts.GetCount(); }
+			/// @brief Gets the lengths of loss runs
+			const Histogram& GetBurstLengths() const noexcept { return m_bursts; }
+			/// @brief Gets the lengths of runs of received packets
+			const Histogram& GetGapLengths() const noexcept { return m_gaps; }
+
+			/// @brief Fits a Gilbert-Elliott model to the finalized seqs
+			/// @return The fitted model
+			GilbertElliott Fit() const noexcept;
+
+			/// @brief Calls a function with each recent episode, oldest first
+			/// @param function The function
+			template<typename Function_t>
+			void ForEachEpisode(Function_t&& function) const noexcept
+			{
+				const size_t count = std::min<uint64_t>(m_bursts.GetCount(), m_episodes.size());
+				for (size_t i = 0; i < count; ++i)
+					function(m_episodes[(m_episodeHead + m_episodes.size() - count + i) % m_episodes.size()]);
+			}
+		private:
+			std::vector<uint64_t> m_bitmap;
+			uint32_t m_window;
+			uint64_t m_nextSeq;
+			uint64_t m_finalized;
+			uint64_t m_lost;
+			/// @brief Counts of loss pairs and triples for the fit
+			uint64_t m_lostAfterLost;
+			uint64_t m_lostLostLost;
+			uint64_t m_lostReceivedLost;
+			/// @brief The two previous outcomes, bit 0 the most recent, 1 for lost
+			uint32_t m_history;
+			bool m_inBurst;
+			uint32_t m_runLength;
+			Histogram m_bursts;
+			Histogram m_gaps;
+			std::vector<Episode> m_episodes;
+			size_t m_episodeHead;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
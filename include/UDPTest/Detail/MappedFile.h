@@ -0,0 +1,50 @@
+#ifndef UDPTEST_DETAIL_MAPPEDFILE_H_
+#define UDPTEST_DETAIL_MAPPEDFILE_H_
+
+/// @file
+/// Mapped File
+/// 10/19/26 15:00
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <cstddef>
+#include <string>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief MappedFile maps a whole file read-only. Pages are read in 
+		/// as they are touched and can be dropped by the kernel again, so
+		/// files far larger than memory can be streamed through
+		class MappedFile
+		{
+		public:
+			using ErrorCode_t = asio::error_code;
+
+			/// @brief Maps a file
+			/// @param path The path of the file
+			/// @throws ErrorCode_t
+			explicit MappedFile(const std::string& path);
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+			~MappedFile();
+
+			/// @brief Gets the start of the mapping
+			const char* GetData() const noexcept { return m_data; }
+			/// @brief Gets the size of the mapping
+			size_t GetSize() const noexcept { return m_size; }
+		private:
+			const char* m_data;
+			size_t m_size;
+#ifdef _WIN32
+			void* m_file;
+			void* m_mapping;
+#endif
+		};
+	}
+}
+
+#endif
\ No newline at end of file
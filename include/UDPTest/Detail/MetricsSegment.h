@@ -0,0 +1,165 @@
+#ifndef UDPTEST_DETAIL_METRICSSEGMENT_H_
+#define UDPTEST_DETAIL_METRICSSEGMENT_H_
+
+/// @file
+/// Metrics Segment
+/// 10/19/26 14:10
+
+// UDPTest includes
+#include <UDPTest/Detail/Histogram.h>
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief MetricsSegment is a versioned shared-memory segment of metric 
+		/// slots. A single writer publishes each slot under a seqlock, so any 
+		/// number of readers in other processes can copy it without locking
+		class MetricsSegment
+		{
+		public:
+			using ErrorCode_t = asio::error_code;
+
+			static constexpr uint32_t Magic = 0x4D545055;
+			static constexpr uint32_t Version = 3;
+			static constexpr uint32_t SlotCount = 256;
+			static constexpr uint32_t NameSize = 48;
+			/// @brief How many times a read retries a slot in the middle of
+			/// an update before skipping it
+			static constexpr uint32_t ReadAttempts = 64;
+
+			/// @brief Who publishes into the segment
+			enum class Role : uint32_t
+			{
+				Server = 1,
+				Client = 2
+			};
+
+			/// @brief The counters of a slot
+			enum Counter : uint32_t
+			{
+				PacketsPerSecond,
+				BytesPerSecond,
+				PacketsTotal,
+				BytesTotal,
+				LostTotal,
+				AckQueueDepth,
+				MaxAckQueueDepth,
+				LatencyCount,
+				LatencySumNs,
+				LatencyMaxNs,
+				CorruptedTotal,
+				/// @brief CPU time of the transport thread, which a server's
+				/// connections all share
+				CpuTimeNs,
+				ContextSwitches,
+				CounterCount
+			};
+
+			/// @brief A consistent copy of a slot
+			struct SlotSnapshot
+			{
+				std::string name;
+				std::array<uint64_t, CounterCount> counters;
+				Histogram latency;
+			};
+
+			/// @brief Creates a segment for publishing, replacing any stale one
+			/// @param name The segment name
+			/// @param role The role of the publisher
+			/// @throws ErrorCode_t
+			MetricsSegment(const std::string& name, Role role);
+			/// @brief Opens an existing segment for reading
+			/// @param name The segment name
+			/// @throws ErrorCode_t
+			/// @throws std::runtime_error if the segment has another version
+			explicit MetricsSegment(const std::string& name);
+			MetricsSegment(const MetricsSegment&) = delete;
+			MetricsSegment& operator=(const MetricsSegment&) = delete;
+			~MetricsSegment();
+
+			/// @brief Gets the role of the publisher
+			Role GetRole() const noexcept;
+			/// @brief Gets the process id of the publisher
+			uint64_t GetPid() const noexcept;
+
+			/// @brief Claims a free slot. Only call from the writer
+			/// @param name The name of the slot
+			/// @return The slot index, or SlotCount if every slot is taken
+			uint32_t AcquireSlot(const std::string& name) noexcept;
+			/// @brief Frees a slot. Only call from the writer
+			/// @param slot The slot index
+			void ReleaseSlot(uint32_t slot) noexcept;
+			/// @brief Publishes the values of a slot. Only call from the writer
+			/// @param slot The slot index
+			/// @param counters The counter values
+			/// @param latency The cumulative latency histogram
+			void WriteSlot(uint32_t slot, const std::array<uint64_t, CounterCount>& counters,
+				const Histogram& latency) noexcept;
+
+			/// @brief Copies every slot in use. A slot that stays in the
+			/// middle of an update, e.g. because its writer died, is skipped
+			/// @return The slot snapshots
+			std::vector<SlotSnapshot> ReadSlots() const;
+		private:
+			struct Header
+			{
+				uint32_t magic;
+				uint32_t version;
+				uint32_t slotCount;
+				uint32_t slotSize;
+				uint32_t role;
+				uint32_t reserved;
+				uint64_t pid;
+			};
+
+			struct Slot
+			{
+				std::atomic<uint32_t> sequence;
+				std::atomic<uint32_t> inUse;
+				std::array<std::atomic<char>, NameSize> name;
+				std::array<std::atomic<uint64_t>, CounterCount> counters;
+				std::array<std::atomic<uint64_t>, Histogram::BucketCount> latencyBuckets;
+			};
+
+			static_assert(std::atomic<uint64_t>::is_always_lock_free,
+				"Shared counters must be lock-free");
+
+			/// @brief Maps the segment
+			/// @param create True to create it for writing
+			/// @throws ErrorCode_t
+			void Map(bool create);
+			/// @brief Begins a seqlock write of a slot
+			static void BeginWrite(Slot& slot) noexcept;
+			/// @brief Ends a seqlock write of a slot
+			static void EndWrite(Slot& slot) noexcept;
+
+			Header& GetHeader() const noexcept { return *static_cast<Header*>(m_memory); }
+			Slot& GetSlot(uint32_t slot) const noexcept 
+			{ 
+				return reinterpret_cast<Slot*>(static_cast<char*>(m_memory) + sizeof(Header))[slot];
+			}
+
+			static constexpr size_t SegmentSize = sizeof(Header) + sizeof(Slot) * SlotCount;
+
+			std::string m_name;
+			bool m_owner;
+			void* m_memory;
+#ifdef _WIN32
+			void* m_mapping;
+#endif
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef UDPTEST_DETAIL_PAYLOAD_H_
+#define UDPTEST_DETAIL_PAYLOAD_H_
+
+/// @file
+/// Payload
+/// 10/19/26 16:40
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief Fills a payload from a counter-based generator. Every 32-bit
+		/// word is a hash of the seed, the seq and the word's index, so any
+		/// packet can be regenerated on its own and no two packets repeat.
+		/// Uses AVX2 or SSE4.1 when the CPU has them
+		/// @param data The payload
+		/// @param size The size of the payload
+		/// @param seed The generator seed
+		/// @param seq The sequence number of the packet
+		void FillPayload(void* data, size_t size, uint32_t seed, uint32_t seq) noexcept;
+
+		/// @brief Checks a payload against the bytes FillPayload would write
+		/// @param data The payload
+		/// @param size The size of the payload
+		/// @param seed The generator seed
+		/// @param seq The sequence number of the packet
+		/// @param offset The first byte to check. Requires: a multiple of 4
+		/// @return Whether every byte from the offset on matches
+		bool CheckPayload(const void* data, size_t size, uint32_t seed,
+			uint32_t seq, size_t offset = 0) noexcept;
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef UDPTEST_DETAIL_RECEIVETRACKER_H_
+#define UDPTEST_DETAIL_RECEIVETRACKER_H_
+
+/// @file
+/// Receive Tracker
+/// 10/19/26 23:30
+
+// STL includes
+#include <chrono>
+#include <cstdint>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief ReceiveTracker accounts for the packets a server receives:
+		/// their place in the sequence, what is missing from it, what arrived
+		/// corrupted and the jitter of their transit. It never reads a clock,
+		/// every time is handed in, so a connection and a simulation of one
+		/// share it
+		class ReceiveTracker
+		{
+		public:
+			using Duration_t = std::chrono::nanoseconds;
+
+			ReceiveTracker() noexcept;
+
+			/// @brief Accounts for an intact packet of the sequence
+			/// @param seq The seq the packet carries
+			void OnPacket(uint32_t seq) noexcept;
+			/// @brief Folds a packet's transit time into the jitter
+			/// @param sentNs The packet's send timestamp
+			/// @param now The arrival time, on a clock of the receiver's own,
+			/// which differs from the sender's by an offset the jitter cancels out
+			void OnTransit(uint64_t sentNs, Duration_t now) noexcept;
+			/// @brief Accounts for a packet that failed its integrity check.
+			/// The seq may be what got corrupted, so it isn't placed
+			void OnCorrupt() noexcept { ++m_corrupted; }
+			/// @brief Starts the jitter over, e.g. for a new client
+			void ResetJitter() noexcept;
+
+			/// @brief Gets the highest seq received, extended to 64 bits so the
+			/// sequence survives the wire seq wrapping
+			uint64_t GetHighestSeq() const noexcept { return m_highestSeq; }
+			uint64_t GetReceived() const noexcept { return m_received; }
+			uint64_t GetCorrupted() const noexcept { return m_corrupted; }
+			/// @brief Gets the packets missing from the sequence. Corrupted
+			/// packets arrived, they just can't be placed in it
+			uint64_t GetLost() const noexcept
+			{
+				if (m_seqSeen == false)
+					return 0;
+				const uint64_t expected = m_highestSeq - m_firstSeq + 1;
+				const uint64_t arrived = m_received + m_corrupted;
+				return (expected > arrived) ? expected - arrived : 0;
+			}
+			/// @brief Gets the RFC 3550 interarrival jitter, from the send
+			/// timestamps, or 0 without
+			double GetJitterNs() const noexcept { return m_jitterNs; }
+		private:
+			bool m_seqSeen;
+			uint64_t m_firstSeq;
+			uint64_t m_highestSeq;
+			uint64_t m_received;
+			uint64_t m_corrupted;
+			bool m_transitSeen;
+			int64_t m_lastTransitNs;
+			double m_jitterNs;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,99 @@
+#ifndef UDPTEST_DETAIL_REPORTER_H_
+#define UDPTEST_DETAIL_REPORTER_H_
+
+/// @file
+/// Reporter
+/// 10/19/26 13:55
+
+// UDPTest includes
+#include <UDPTest/Detail/SPSCQueue.h>
+
+// STL includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief Reporter formats snapshots on its own thread so the transport
+		/// thread only ever copies a snapshot into a queue
+		/// @tparam Snapshot_t The snapshot type
+		/// @tparam QueueSize The number of snapshots that can be waiting at once
+		template<typename Snapshot_t, size_t QueueSize = 64>
+		class Reporter
+		{
+		public:
+			using Handler_t = std::function<void(const Snapshot_t&)>;
+
+			/// @brief Creates a reporter
+			/// @param handler The handler that reports a snapshot, called on
+			/// the reporter thread
+			explicit Reporter(Handler_t handler) noexcept
+				: m_handler(std::move(handler)), m_running(false), m_dropped(0) {}
+			Reporter(const Reporter&) = delete;
+			Reporter& operator=(const Reporter&) = delete;
+			~Reporter() { Stop(); }
+
+			/// @brief Starts the reporter thread
+			void Start()
+			{
+				m_running.store(true, std::memory_order_relaxed);
+				m_thread = std::thread(&Reporter::Run, this);
+			}
+
+			/// @brief Stops the reporter thread after reporting what is queued
+			void Stop() noexcept
+			{
+				m_running.store(false, std::memory_order_relaxed);
+				if (m_thread.joinable() == true)
+					m_thread.join();
+			}
+
+			/// @brief Queues a snapshot for reporting. Never blocks
+			/// @param snapshot The snapshot
+			/// @return False if the reporter fell behind and the snapshot was dropped
+			bool Publish(const Snapshot_t& snapshot) noexcept
+			{
+				if (m_queue.TryPush(snapshot) == true)
+					return true;
+				m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1,
+					std::memory_order_relaxed);
+				return false;
+			}
+
+			/// @brief Gets how many snapshots can be queued without dropping
+			/// one. Only call from the publishing thread
+			size_t GetFree() const noexcept { return m_queue.GetFree(); }
+
+			/// @brief Gets the number of snapshots dropped because the queue was full
+			uint64_t GetDropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+		private:
+			/// @brief Reports snapshots until stopped
+			void Run() noexcept
+			{
+				Snapshot_t snapshot;
+				while (m_running.load(std::memory_order_relaxed) == true)
+				{
+					while (m_queue.TryPop(snapshot) == true)
+						m_handler(snapshot);
+					// polling keeps the producer free of any wakeup syscall
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				}
+				while (m_queue.TryPop(snapshot) == true)
+					m_handler(snapshot);
+			}
+
+			Handler_t m_handler;
+			SPSCQueue<Snapshot_t, QueueSize> m_queue;
+			std::thread m_thread;
+			std::atomic<bool> m_running;
+			std::atomic<uint64_t> m_dropped;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef UDPTEST_DETAIL_SPSCQUEUE_H_
+#define UDPTEST_DETAIL_SPSCQUEUE_H_
+
+/// @file
+/// SPSC Queue
+/// 10/19/26 13:40
+
+// STL includes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief The cache line size used to keep producer and consumer apart
+		constexpr size_t CacheLineSize = 64;
+
+		/// @brief SPSCQueue is a bounded, wait-free queue between exactly one
+		/// producer thread and one consumer thread. The slots live on the
+		/// heap, so a queue of large elements can sit in an object on the stack
+		/// @tparam T The element type
+		/// @tparam Capacity The number of elements. Requires: a power of two
+		template<typename T, size_t Capacity>
+		class SPSCQueue
+		{
+			static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+				"Capacity must be a power of two");
+		public:
+			SPSCQueue()
+				: m_slots(std::make_unique<T[]>(Capacity))
+			{}
+			SPSCQueue(const SPSCQueue&) = delete;
+			SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+			/// @brief Pushes an element. Only call from the producer
+			/// @param value The value to push
+			/// @return False if the queue was full
+			bool TryPush(const T& value) noexcept
+			{
+				const size_t head = m_head.load(std::memory_order_relaxed);
+				if (head - m_cachedTail == Capacity)
+				{
+					m_cachedTail = m_tail.load(std::memory_order_acquire);
+					if (head - m_cachedTail == Capacity)
+						return false;
+				}
+				m_slots[head & (Capacity - 1)] = value;
+				m_head.store(head + 1, std::memory_order_release);
+				return true;
+			}
+
+			/// @brief Gets how many elements can be pushed without failing.
+			/// Only call from the producer, the consumer only adds room
+			size_t GetFree() const noexcept
+			{
+				return Capacity - (m_head.load(std::memory_order_relaxed) -
+					m_tail.load(std::memory_order_acquire));
+			}
+
+			/// @brief Pops an element. Only call from the consumer
+			/// @param value The popped value
+			/// @return False if the queue was empty
+			bool TryPop(T& value) noexcept
+			{
+				const size_t tail = m_tail.load(std::memory_order_relaxed);
+				if (tail == m_cachedHead)
+				{
+					m_cachedHead = m_head.load(std::memory_order_acquire);
+					if (tail == m_cachedHead)
+						return false;
+				}
+				value = std::move(m_slots[tail & (Capacity - 1)]);
+				m_tail.store(tail + 1, std::memory_order_release);
+				return true;
+			}
+		private:
+			alignas(CacheLineSize) std::atomic<size_t> m_head{ 0 };
+			size_t m_cachedTail = 0;
+			alignas(CacheLineSize) std::atomic<size_t> m_tail{ 0 };
+			size_t m_cachedHead = 0;
+			alignas(CacheLineSize) std::unique_ptr<T[]> m_slots;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+#ifndef UDPTEST_DETAIL_SENDPACER_H_
+#define UDPTEST_DETAIL_SENDPACER_H_
+
+/// @file
+/// Send Pacer
+/// 10/19/26 23:25
+
+// UDPTest includes
+#include <UDPTest/Detail/TrafficModel.h>
+
+// STL includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief SendPacer walks a traffic model's send slots and decides
+		/// what happens to a slot that comes due while the send ring is
+		/// full. It never reads a clock, every time is handed in, so a
+		/// client and a simulation of one share it
+		class SendPacer
+		{
+		public:
+			using Duration_t = std::chrono::nanoseconds;
+
+			/// @brief What to do with send slots that could not be sent on time
+			enum class CatchUpPolicy
+			{
+				/// @brief Queue missed slots and send them as soon as possible,
+				/// skipping those that find the backlog full
+				Burst,
+				/// @brief Skip missed slots entirely
+				Drop,
+				/// @brief Send missed slots late and shift the schedule after them
+				Stretch
+			};
+
+			/// @param policy The catch-up policy
+			/// @param maxBacklog The most slots that can wait on a free send
+			/// ring entry. Requires: nonzero
+			SendPacer(CatchUpPolicy policy, size_t maxBacklog);
+
+			/// @brief Starts pacing a phase with its first slot due now
+			/// @param model The traffic model, which has to outlive the phase
+			/// @param now The start of the phase
+			/// @param meanGap The mean time between slots, a send more than
+			/// one behind its slot is late
+			/// @return False if the model has no packets
+			bool Begin(TrafficModel& model, Duration_t now, Duration_t meanGap) noexcept;
+			/// @brief Draws the slot after the one due
+			/// @return False if the model ran out of packets
+			bool Advance() noexcept;
+
+			/// @brief Handles the slot that is due according to the policy
+			/// @param now The time
+			/// @param hasRoom Whether the send ring has a free entry
+			/// @param send Called with the send time and the payload size of
+			/// every slot to send now
+			/// @return False if the slot stalls the schedule until a send
+			/// finishes, true if the next slot can be drawn
+			template<typename Send_t>
+			bool OnDue(Duration_t now, bool hasRoom, Send_t&& send) noexcept
+			{
+				const Duration_t scheduled = m_due;
+				switch (m_policy)
+				{
+				case CatchUpPolicy::Burst:
+					// slots queue up behind the ring and go out back-to-back,
+					// up to a fixed backlog so a long stall can't grow memory
+					if (hasRoom == true && m_backlogCount == 0)
+						Send(scheduled, now, m_slotSize, send);
+					else if (m_backlogCount < m_backlog.size())
+					{
+						m_backlog[(m_backlogHead + m_backlogCount) % m_backlog.size()] =
+							Slot{ scheduled, m_slotSize };
+						++m_backlogCount;
+					}
+					else
+						++m_skipped;
+					break;
+				case CatchUpPolicy::Drop:
+				{
+					// skip every slot whose successor is already due
+					uint32_t slotSize = m_slotSize;
+					Duration_t gap;
+					uint32_t nextSize;
+					while (m_model->Next(gap, nextSize) == true)
+					{
+						if (m_due + gap > now)
+						{
+							// keep the slot looked ahead at for the next wait
+							m_slotPeeked = true;
+							m_peekedGap = gap;
+							m_peekedSize = nextSize;
+							break;
+						}
+						++m_skipped;
+						m_due += gap;
+						slotSize = nextSize;
+					}
+					if (hasRoom == true)
+						Send(m_due, now, slotSize, send);
+					else
+						++m_skipped;
+					break;
+				}
+				case CatchUpPolicy::Stretch:
+					if (hasRoom == false)
+					{
+						// wait for a send to finish, the schedule resumes from there
+						m_stalled = true;
+						return false;
+					}
+					Send(scheduled, now, m_slotSize, send);
+					// shift the schedule so the next slot is a full gap away
+					if (now - scheduled > m_meanGap)
+						m_due = now;
+					break;
+				}
+				return true;
+			}
+
+			/// @brief Sends the slots that waited on a free send ring entry,
+			/// once a send finished
+			/// @param now The time
+			/// @param hasRoom Called for whether the send ring has a free entry
+			/// @param send Called as OnDue calls it
+			/// @return True if a stalled slot was sent, so the next slot can
+			/// be drawn
+			template<typename HasRoom_t, typename Send_t>
+			bool OnSendDone(Duration_t now, HasRoom_t&& hasRoom, Send_t&& send) noexcept
+			{
+				while (m_backlogCount != 0 && hasRoom() == true)
+				{
+					const Slot slot = m_backlog[m_backlogHead];
+					m_backlogHead = (m_backlogHead + 1) % m_backlog.size();
+					--m_backlogCount;
+					Send(slot.scheduled, now, slot.payloadSize, send);
+				}
+				if (m_stalled == false || hasRoom() == false)
+					return false;
+				m_stalled = false;
+				const Duration_t scheduled = m_due;
+				m_due = now;
+				Send(scheduled, now, m_slotSize, send);
+				return true;
+			}
+
+			/// @brief Gets when the slot is due
+			Duration_t GetDue() const noexcept { return m_due; }
+			/// @brief Gets whether the schedule waits on a send to finish
+			bool IsStalled() const noexcept { return m_stalled; }
+			/// @brief Gets the slots sent more than a mean gap behind schedule
+			uint64_t GetLate() const noexcept { return m_late; }
+			/// @brief Gets the slots the drop policy skipped, or the burst
+			/// policy found no room for in the backlog
+			uint64_t GetSkipped() const noexcept { return m_skipped; }
+			/// @brief Gets the slots waiting on a free send ring entry
+			size_t GetBacklog() const noexcept { return m_backlogCount; }
+
+			/// @brief Parses a catch-up policy
+			/// @param policy One of burst, drop or stretch
+			/// @throws std::runtime_error
+			/// @return The catch-up policy
+			static CatchUpPolicy ParsePolicy(const std::string& policy);
+		private:
+			/// @brief A send slot waiting for a free send ring entry
+			struct Slot
+			{
+				Duration_t scheduled;
+				uint32_t payloadSize;
+			};
+
+			template<typename Send_t>
+			void Send(Duration_t scheduled, Duration_t now, uint32_t payloadSize, Send_t& send) noexcept
+			{
+				// anything more than a mean gap behind its slot is late
+				if (now - scheduled > m_meanGap)
+					++m_late;
+				send(now, payloadSize);
+			}
+
+			CatchUpPolicy m_policy;
+			TrafficModel* m_model;
+			Duration_t m_meanGap;
+			Duration_t m_due;
+			uint32_t m_slotSize;
+			bool m_slotPeeked;
+			Duration_t m_peekedGap;
+			uint32_t m_peekedSize;
+			/// @brief A ring of the slots waiting on a free send ring entry
+			std::vector<Slot> m_backlog;
+			size_t m_backlogHead;
+			size_t m_backlogCount;
+			bool m_stalled;
+			uint64_t m_late;
+			uint64_t m_skipped;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
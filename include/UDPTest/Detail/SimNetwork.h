@@ -0,0 +1,135 @@
+#ifndef UDPTEST_DETAIL_SIMNETWORK_H_
+#define UDPTEST_DETAIL_SIMNETWORK_H_
+
+/// @file
+/// Sim Network
+/// 10/19/26 22:40
+
+// UDPTest includes
+#include <UDPTest/Detail/Impairment.h>
+#include <UDPTest/Detail/TimingWheel.h>
+
+// STL includes
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief SimNetwork carries datagrams between a simulated client and
+		/// server in memory, on a virtual clock that only moves when it is
+		/// advanced. Each direction is impaired the way the server impairs
+		/// acks, and packets to the server can arrive corrupted, with every
+		/// draw seeded, so a run replays exactly
+		class SimNetwork
+		{
+		public:
+			using Duration_t = std::chrono::nanoseconds;
+
+			enum class Side : uint8_t
+			{
+				Client,
+				Server
+			};
+
+			/// @brief What happened to the datagrams sent one way
+			struct PathStats
+			{
+				uint64_t sent = 0;
+				uint64_t dropped = 0;
+				uint64_t duplicated = 0;
+				uint64_t reordered = 0;
+				uint64_t corrupted = 0;
+				uint64_t delivered = 0;
+			};
+
+			/// @brief The resolution of the virtual clock. Every hop takes at
+			/// least one tick
+			static constexpr Duration_t Tick{ 1000 };
+
+			/// @param toServer The impairments of the client to server direction
+			/// @param toClient The impairments of the server to client direction
+			/// @param corrupt The chance, from 0 to 1, of a datagram to the
+			/// server arriving with its last byte flipped. That byte is payload
+			/// for any packet with one, so its seq survives
+			/// @param seed The seed of every draw
+			SimNetwork(const ImpairmentConfig& toServer, const ImpairmentConfig& toClient,
+				double corrupt, uint64_t seed) noexcept;
+
+			/// @brief Gets the virtual time
+			Duration_t GetNow() const noexcept { return m_now; }
+
+			/// @brief Sends a datagram to the other side
+			/// @param from The sending side
+			/// @param data The datagram
+			/// @param size The size of the datagram
+			/// @param tag What the simulation knows the datagram to be, e.g.
+			/// its 64-bit seq, handed over on delivery apart from its bytes
+			void Send(Side from, const uint8_t* data, size_t size, uint64_t tag) noexcept;
+
+			/// @brief Moves the clock forward, delivering every datagram due
+			/// up to the new time in the order they arrive
+			/// @param time The time to advance to. Earlier times are ignored
+			/// @param onDeliver Called with the receiving side, the datagram,
+			/// its size, its tag and whether it was corrupted on the way, with
+			/// the clock at its arrival. It may send
+			/// @return The number of datagrams delivered
+			template<typename Function_t>
+			size_t AdvanceTo(Duration_t time, Function_t&& onDeliver) noexcept
+			{
+				const size_t delivered = m_inFlight.Advance(static_cast<uint64_t>(time / Tick),
+					[this, &onDeliver](const Datagram& datagram)
+					{
+						m_now = std::max(m_now, Tick * static_cast<Duration_t::rep>(m_inFlight.GetNow()));
+						// counted on the path of the side that sent it
+						++m_paths[static_cast<size_t>(datagram.to == Side::Client)].stats.delivered;
+						onDeliver(datagram.to, m_buffers[datagram.buffer].data(), datagram.size, datagram.tag,
+							datagram.corrupted);
+						m_freeBuffers.push_back(datagram.buffer);
+					});
+				m_now = std::max(m_now, time);
+				return delivered;
+			}
+
+			/// @brief Gets what happened to the datagrams one side sent
+			const PathStats& GetPathStats(Side from) const noexcept
+			{
+				return m_paths[static_cast<size_t>(from)].stats;
+			}
+		private:
+			struct Datagram
+			{
+				Side to;
+				/// @brief The index of the buffer holding the bytes
+				uint32_t buffer;
+				uint32_t size;
+				uint64_t tag;
+				bool corrupted;
+			};
+
+			struct Path
+			{
+				Impairment impairment;
+				PathStats stats;
+			};
+
+			/// @brief The paths, indexed by the sending side
+			std::array<Path, 2> m_paths;
+			double m_corrupt;
+			std::mt19937_64 m_random;
+			TimingWheel<Datagram> m_inFlight;
+			/// @brief The bytes of datagrams in flight, pooled so buffers are
+			/// reused once delivered
+			std::vector<std::vector<uint8_t>> m_buffers;
+			std::vector<uint32_t> m_freeBuffers;
+			Duration_t m_now;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef UDPTEST_DETAIL_SOAKRECORDER_H_
+#define UDPTEST_DETAIL_SOAKRECORDER_H_
+
+/// @file
+/// Soak Recorder
+/// 10/19/26 22:10
+
+// UDPTest includes
+#include <UDPTest/Detail/Histogram.h>
+
+// spdlog includes
+#include <spdlog/logger.h>
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief The traffic of a window of a soak test
+		struct SoakWindow
+		{
+			uint64_t sent = 0;
+			uint64_t received = 0;
+			/// @brief Packets given up on in the window, which were sent up to
+			/// a loss window earlier
+			uint64_t lost = 0;
+			uint64_t corrupted = 0;
+			uint64_t bytes = 0;
+			Histogram latency;
+
+			/// @brief Adds another window's traffic
+			/// @param other The other window
+			void Merge(const SoakWindow& other) noexcept
+			{
+				sent += other.sent;
+				received += other.received;
+				lost += other.lost;
+				corrupted += other.corrupted;
+				bytes += other.bytes;
+				latency.Merge(other.latency);
+			}
+
+			/// @brief Clears every counter
+			void Reset() noexcept { *this = SoakWindow(); }
+		};
+
+		/// @brief SoakRecorder keeps rolling 1s, 1m and 1h aggregates of a
+		/// test that runs for hours or days. Seconds roll up into minutes and
+		/// minutes into an hour, each in a fixed ring, so memory stays flat.
+		/// Every window is written as a JSON line to a size-rotated set of
+		/// files, so disk use is bounded too
+		class SoakRecorder
+		{
+		public:
+			static constexpr size_t SecondsPerMinute = 60;
+			static constexpr size_t MinutesPerHour = 60;
+
+			/// @brief Opens the output
+			/// @param path The file to write to. Rotated files get .1, .2
+			/// and so on before the extension
+			/// @param maxFileSize The bytes to write to a file before rotating
+			/// @param maxFiles The number of rotated files to keep
+			/// @throws std::runtime_error
+			SoakRecorder(const std::string& path, size_t maxFileSize, size_t maxFiles);
+			SoakRecorder(const SoakRecorder&) = delete;
+			SoakRecorder& operator=(const SoakRecorder&) = delete;
+
+			/// @brief Adds a second of traffic and writes the windows it ends:
+			/// the second, the rolling minute and, on the minute, the rolling hour
+			/// @param second The second's traffic
+			void AddSecond(const SoakWindow& second) noexcept;
+		private:
+			/// @brief Writes a window
+			/// @param name The window's name
+			/// @param window The window
+			/// @param seconds The seconds the window covers
+			void Write(const char* name, const SoakWindow& window, uint64_t seconds) noexcept;
+
+			std::shared_ptr<spdlog::logger> m_logger;
+			/// @brief The last minute of seconds and the last hour of minutes
+			std::array<SoakWindow, SecondsPerMinute> m_seconds;
+			std::array<SoakWindow, MinutesPerHour> m_minutes;
+			/// @brief The minute in progress
+			SoakWindow m_minute;
+			/// @brief The seconds added so far
+			uint64_t m_elapsed;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
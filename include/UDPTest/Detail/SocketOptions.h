@@ -0,0 +1,147 @@
+#ifndef UDPTEST_DETAIL_SOCKETOPTIONS_H_
+#define UDPTEST_DETAIL_SOCKETOPTIONS_H_
+
+/// @file
+/// Socket Options
+/// 10/19/26 13:10
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <algorithm>
+#include <cstdint>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief The IPv4 and UDP header overhead of a datagram
+		constexpr uint32_t UDPHeaderOverhead = 20 + 8;
+
+#if defined(IP_MTU_DISCOVER) && defined(IP_MTU)
+		using PathMtuDiscovery_t = asio::detail::socket_option::integer<IPPROTO_IP, IP_MTU_DISCOVER>;
+		using PathMtu_t = asio::detail::socket_option::integer<IPPROTO_IP, IP_MTU>;
+
+		/// @brief Sets or clears the don't-fragment bit on outgoing datagrams
+		/// @param socket The socket
+		/// @param dontFragment True to set DF and refuse to fragment
+		/// @param ec The error code
+		inline void SetDontFragment(asio::ip::udp::socket& socket,
+			bool dontFragment, asio::error_code& ec) noexcept
+		{
+			socket.set_option(PathMtuDiscovery_t(
+				dontFragment ? IP_PMTUDISC_DO : IP_PMTUDISC_DONT), ec);
+		}
+
+		/// @brief Gets the path MTU the kernel knows for a connected socket
+		/// @param socket The connected socket
+		/// @param ec The error code
+		/// @return The path MTU in bytes
+		inline uint32_t GetPathMtu(asio::ip::udp::socket& socket,
+			asio::error_code& ec) noexcept
+		{
+			PathMtu_t mtu;
+			socket.get_option(mtu, ec);
+			return static_cast<uint32_t>(mtu.value());
+		}
+#else
+		inline void SetDontFragment(asio::ip::udp::socket&,
+			bool, asio::error_code& ec) noexcept
+		{
+			ec = asio::error::operation_not_supported;
+		}
+
+		inline uint32_t GetPathMtu(asio::ip::udp::socket&,
+			asio::error_code& ec) noexcept
+		{
+			ec = asio::error::operation_not_supported;
+			return 0;
+		}
+#endif
+
+		/// @brief Sets both socket buffers and reads back what was granted.
+		/// Linux doubles the request for its bookkeeping and caps it at
+		/// net.core.rmem_max and net.core.wmem_max
+		/// @param socket The socket
+		/// @param size The size of each buffer in bytes
+		/// @param ec The error code
+		/// @return The smaller of the granted buffer sizes
+		inline uint32_t SetBufferSizes(asio::ip::udp::socket& socket,
+			uint32_t size, asio::error_code& ec) noexcept
+		{
+			asio::socket_base::send_buffer_size sendSize(static_cast<int>(size));
+			asio::socket_base::receive_buffer_size receiveSize(static_cast<int>(size));
+			if (socket.set_option(sendSize, ec), ec ||
+				socket.set_option(receiveSize, ec), ec ||
+				socket.get_option(sendSize, ec), ec ||
+				socket.get_option(receiveSize, ec), ec)
+				return 0;
+			return static_cast<uint32_t>(std::min(sendSize.value(), receiveSize.value()));
+		}
+
+#ifdef IP_TOS
+		using Tos_t = asio::detail::socket_option::integer<IPPROTO_IP, IP_TOS>;
+
+		/// @brief Sets the TOS byte of outgoing datagrams, the DSCP routers
+		/// queue them by and the ECN bits
+		/// @param socket The socket
+		/// @param tos The TOS byte
+		/// @param ec The error code
+		inline void SetTos(asio::ip::udp::socket& socket,
+			uint8_t tos, asio::error_code& ec) noexcept
+		{
+			socket.set_option(Tos_t(tos), ec);
+		}
+#else
+		inline void SetTos(asio::ip::udp::socket&,
+			uint8_t, asio::error_code& ec) noexcept
+		{
+			ec = asio::error::operation_not_supported;
+		}
+#endif
+
+#ifdef SO_PRIORITY
+		using Priority_t = asio::detail::socket_option::integer<SOL_SOCKET, SO_PRIORITY>;
+
+		/// @brief Sets the priority the host queues outgoing datagrams by.
+		/// Priorities above 6 need CAP_NET_ADMIN
+		/// @param socket The socket
+		/// @param priority The priority
+		/// @param ec The error code
+		inline void SetPriority(asio::ip::udp::socket& socket,
+			uint8_t priority, asio::error_code& ec) noexcept
+		{
+			socket.set_option(Priority_t(priority), ec);
+		}
+#else
+		inline void SetPriority(asio::ip::udp::socket&,
+			uint8_t, asio::error_code& ec) noexcept
+		{
+			ec = asio::error::operation_not_supported;
+		}
+#endif
+
+#ifdef SO_REUSEPORT
+		using ReusePort_t = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+		/// @brief Lets several sockets bind the same port, the kernel spreads
+		/// flows across them by hashing their addresses
+		/// @param socket The socket, before it is bound
+		/// @param ec The error code
+		inline void SetReusePort(asio::ip::udp::socket& socket,
+			asio::error_code& ec) noexcept
+		{
+			socket.set_option(ReusePort_t(true), ec);
+		}
+#else
+		inline void SetReusePort(asio::ip::udp::socket&,
+			asio::error_code& ec) noexcept
+		{
+			ec = asio::error::operation_not_supported;
+		}
+#endif
+	}
+}
+
+#endif
\ No newline at end of file
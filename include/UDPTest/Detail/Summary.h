@@ -0,0 +1,41 @@
+#ifndef UDPTEST_DETAIL_SUMMARY_H_
+#define UDPTEST_DETAIL_SUMMARY_H_
+
+/// @file
+/// Summary
+/// 10/19/26 19:40
+
+// STL includes
+#include <cstddef>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief Summary describes a metric measured over repeated runs
+		struct Summary
+		{
+			size_t count = 0;
+			double mean = 0;
+			/// @brief The sample standard deviation
+			double stddev = 0;
+			/// @brief Half the width of the 95% confidence interval of the
+			/// mean, from Student's t distribution since runs are few
+			double confidence = 0;
+
+			/// @brief Summarizes samples
+			/// @param samples One value per run
+			/// @return The summary. The deviation and interval are 0 for
+			/// fewer than two samples
+			static Summary Of(const std::vector<double>& samples) noexcept;
+			/// @brief Gets the two-sided 95% critical value of Student's t
+			/// distribution
+			/// @param degreesOfFreedom The degrees of freedom. Requires: nonzero
+			/// @return The critical value
+			static double GetStudentT95(size_t degreesOfFreedom) noexcept;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
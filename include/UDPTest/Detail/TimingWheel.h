@@ -0,0 +1,275 @@
+#ifndef UDPTEST_DETAIL_TIMINGWHEEL_H_
+#define UDPTEST_DETAIL_TIMINGWHEEL_H_
+
+/// @file
+/// Timing Wheel
+/// 10/19/26 21:20
+
+// STL includes
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief TimingWheel schedules values on a hierarchy of wheels. Level
+		/// 0 has a slot per tick and every level above a slot per revolution of
+		/// the one below; when a higher slot comes round its values cascade
+		/// down. Scheduling and expiring are O(1), values live in a pooled node
+		/// array, and a bitmap of occupied slots lets the owner sleep until
+		/// the next tick with work instead of polling every tick
+		/// @tparam T The value type
+		/// @tparam Levels The number of wheels
+		/// @tparam SlotBits The log2 of the slots per wheel
+		template<typename T, size_t Levels = 4, size_t SlotBits = 8>
+		class TimingWheel
+		{
+			static_assert(Levels != 0 && SlotBits >= 6 && SlotBits * Levels < 64,
+				"The wheels must have at least 64 slots and fit in 64-bit ticks");
+		public:
+			static constexpr size_t SlotCount = size_t(1) << SlotBits;
+			/// @brief The furthest ahead a value can be scheduled, in ticks
+			static constexpr uint64_t MaxDelay = (uint64_t(1) << (SlotBits * Levels)) - 1;
+
+			/// @brief Creates an empty wheel
+			/// @param now The current tick
+			explicit TimingWheel(uint64_t now = 0) noexcept
+				: m_now(now), m_size(0), m_free(Null)
+			{
+				m_slots.fill(Slot{ Null, Null });
+				for (auto& occupied : m_occupied)
+					occupied.fill(0);
+			}
+
+			/// @brief Schedules a value. Values due on the same tick expire in
+			/// the order they were scheduled
+			/// @param tick The tick to expire the value on. Earlier ticks expire
+			/// on the next one and later ones are clamped to MaxDelay
+			/// @param value The value
+			void Schedule(uint64_t tick, T value) noexcept
+			{
+				tick = std::clamp(tick, m_now + 1, m_now + MaxDelay);
+				uint32_t index;
+				if (m_free != Null)
+				{
+					index = m_free;
+					m_free = m_nodes[index].next;
+				}
+				else
+				{
+					index = static_cast<uint32_t>(m_nodes.size());
+					m_nodes.emplace_back();
+				}
+				m_nodes[index].value = std::move(value);
+				m_nodes[index].tick = tick;
+				Place(index);
+				++m_size;
+			}
+
+			/// @brief Expires every value due up to a tick
+			/// @param tick The tick to advance to. Earlier ticks are ignored
+			/// @param onExpire Called with each expired value, in tick order.
+			/// It may schedule more values
+			/// @return The number of values expired
+			template<typename Function_t>
+			size_t Advance(uint64_t tick, Function_t&& onExpire) noexcept
+			{
+				size_t expired = 0;
+				// jump straight between ticks that have work
+				while (m_size != 0 && m_now < tick)
+				{
+					const uint64_t next = GetNextTick();
+					if (next > tick)
+						break;
+					m_now = next;
+					// top down, so a slot can cascade through several levels at once
+					for (size_t level = Levels - 1; level != 0; --level)
+					{
+						if ((m_now & ((uint64_t(1) << (SlotBits * level)) - 1)) == 0)
+							Cascade(level);
+					}
+					uint32_t index = Detach(0, GetDigit(m_now, 0));
+					while (index != Null)
+					{
+						// free the node first, onExpire may reuse it or grow the pool
+						const uint32_t next = m_nodes[index].next;
+						T value = std::move(m_nodes[index].value);
+						m_nodes[index].next = m_free;
+						m_free = index;
+						--m_size;
+						++expired;
+						onExpire(std::move(value));
+						index = next;
+					}
+				}
+				m_now = std::max(m_now, tick);
+				return expired;
+			}
+
+			/// @brief Drops every value, keeping the pool
+			void Clear() noexcept
+			{
+				for (size_t level = 0; level < Levels; ++level)
+				{
+					for (size_t digit = 0; digit < SlotCount; ++digit)
+					{
+						uint32_t index = Detach(level, digit);
+						while (index != Null)
+						{
+							const uint32_t next = m_nodes[index].next;
+							m_nodes[index].value = T();
+							m_nodes[index].next = m_free;
+							m_free = index;
+							index = next;
+						}
+					}
+				}
+				m_size = 0;
+			}
+
+			/// @brief Gets the earliest tick something happens on: a value
+			/// expires or a slot cascades
+			/// @return The tick, or the largest tick if the wheel is empty
+			uint64_t GetNextTick() const noexcept
+			{
+				uint64_t next = std::numeric_limits<uint64_t>::max();
+				for (size_t level = 0; level < Levels; ++level)
+				{
+					const size_t shift = SlotBits * level;
+					const uint64_t base = (m_now >> (shift + SlotBits)) << (shift + SlotBits);
+					size_t digit = FindOccupied(level, GetDigit(m_now, level) + 1);
+					if (digit != SlotCount)
+						next = std::min(next, base + (uint64_t(digit) << shift));
+					// the top wheel also holds values due on its next revolution
+					else if (level == Levels - 1 && (digit = FindOccupied(level, 0)) != SlotCount)
+					{
+						next = std::min(next, base + (uint64_t(1) << (shift + SlotBits)) +
+							(uint64_t(digit) << shift));
+					}
+				}
+				return next;
+			}
+
+			/// @brief Gets the current tick
+			uint64_t GetNow() const noexcept { return m_now; }
+			/// @brief Gets the number of scheduled values
+			size_t GetSize() const noexcept { return m_size; }
+			bool IsEmpty() const noexcept { return m_size == 0; }
+		private:
+			static constexpr uint32_t Null = std::numeric_limits<uint32_t>::max();
+			static constexpr size_t WordsPerLevel = SlotCount / 64;
+
+			struct Node
+			{
+				T value;
+				uint64_t tick = 0;
+				uint32_t next = Null;
+			};
+
+			/// @brief A FIFO list of nodes
+			struct Slot
+			{
+				uint32_t head;
+				uint32_t tail;
+			};
+
+			static size_t GetDigit(uint64_t tick, size_t level) noexcept
+			{
+				return static_cast<size_t>(tick >> (SlotBits * level)) & (SlotCount - 1);
+			}
+
+			/// @brief Links a node into the lowest level whose current
+			/// revolution holds its tick
+			/// @param index The node. Requires: its tick is not before now
+			void Place(uint32_t index) noexcept
+			{
+				const uint64_t tick = m_nodes[index].tick;
+				size_t level = 0;
+				while (level + 1 < Levels &&
+					(tick >> (SlotBits * (level + 1))) != (m_now >> (SlotBits * (level + 1))))
+					++level;
+				const size_t digit = GetDigit(tick, level);
+				Slot& slot = m_slots[level * SlotCount + digit];
+				m_nodes[index].next = Null;
+				if (slot.tail == Null)
+					slot.head = index;
+				else
+					m_nodes[slot.tail].next = index;
+				slot.tail = index;
+				m_occupied[level][digit / 64] |= uint64_t(1) << (digit % 64);
+			}
+
+			/// @brief Empties a slot
+			/// @return The first node of the slot's list
+			uint32_t Detach(size_t level, size_t digit) noexcept
+			{
+				Slot& slot = m_slots[level * SlotCount + digit];
+				const uint32_t head = slot.head;
+				slot = Slot{ Null, Null };
+				m_occupied[level][digit / 64] &= ~(uint64_t(1) << (digit % 64));
+				return head;
+			}
+
+			/// @brief Moves the values of a level's current slot down
+			/// @param level The level. Requires: nonzero
+			void Cascade(size_t level) noexcept
+			{
+				uint32_t index = Detach(level, GetDigit(m_now, level));
+				while (index != Null)
+				{
+					const uint32_t next = m_nodes[index].next;
+					Place(index);
+					index = next;
+				}
+			}
+
+			/// @brief Finds the first occupied slot of a level at or after a digit
+			/// @return The slot's digit, or SlotCount if there is none
+			size_t FindOccupied(size_t level, size_t from) const noexcept
+			{
+				for (size_t word = from / 64; word < WordsPerLevel; ++word)
+				{
+					uint64_t bits = m_occupied[level][word];
+					if (word == from / 64)
+						bits &= ~uint64_t(0) << (from % 64);
+					if (bits != 0)
+						return word * 64 + LowestBit(bits);
+				}
+				return SlotCount;
+			}
+
+			/// @brief Gets the index of the lowest set bit
+			/// @param value The value. Requires: nonzero
+			static size_t LowestBit(uint64_t value) noexcept
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward64(&index, value);
+				return static_cast<size_t>(index);
+#else
+				return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+			}
+
+			uint64_t m_now;
+			size_t m_size;
+			std::vector<Node> m_nodes;
+			/// @brief The head of the list of free nodes
+			uint32_t m_free;
+			std::array<Slot, Levels * SlotCount> m_slots;
+			std::array<std::array<uint64_t, WordsPerLevel>, Levels> m_occupied;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef UDPTEST_DETAIL_TRAFFICCLASS_H_
+#define UDPTEST_DETAIL_TRAFFICCLASS_H_
+
+/// @file
+/// Traffic Class
+/// 10/19/26 23:05
+
+// STL includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief A class of traffic with its own rate, sizes, pacing and
+		/// marking, run alongside other classes towards one server
+		struct TrafficClass
+		{
+			/// @brief The name the class reports under
+			std::string name;
+			std::string bitRate;
+			uint32_t packetRate = 0;
+			/// @brief The payload size range, as <size> or <min>:<max>, or
+			/// empty to size packets from the bitrate
+			std::string sizes;
+			/// @brief The traffic shape, as TrafficModel::Create takes it
+			std::string shape;
+			/// @brief The IP TOS byte, with the DSCP in its upper six bits
+			uint8_t tos = 0;
+			/// @brief The socket priority, 0 leaves the default
+			uint8_t priority = 0;
+
+			/// @brief Gets the DSCP the class is marked with
+			uint8_t GetDscp() const noexcept { return static_cast<uint8_t>(tos >> 2); }
+
+			/// @brief Parses a list of classes
+			/// @param classes Comma-separated <name>:<settings>, the settings
+			/// a slash-separated list of dscp=<DSCP>, priority=<priority>,
+			/// bitrate=<bitrate>, rate=<packets/s>, size=<size>|<min>:<max>
+			/// and shape=<shape>. A trace's path runs to the end of its class
+			/// @param defaults What a class leaves out
+			/// @throws std::runtime_error
+			/// @return The classes, in order
+			static std::vector<TrafficClass> ParseList(const std::string& classes,
+				const TrafficClass& defaults);
+			/// @brief Parses a DSCP
+			/// @param dscp A number from 0 to 63, or be, ef, cs<0-7> or
+			/// af<1-4><1-3>
+			/// @throws std::runtime_error
+			/// @return The DSCP
+			static uint8_t ParseDscp(const std::string& dscp);
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,180 @@
+#ifndef UDPTEST_DETAIL_TRAFFICMODEL_H_
+#define UDPTEST_DETAIL_TRAFFICMODEL_H_
+
+/// @file
+/// Traffic Model
+/// 10/19/26 15:05
+
+// UDPTest includes
+#include <UDPTest/Detail/MappedFile.h>
+
+// STL includes
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief TrafficModel decides when each packet is sent and how large it is
+		class TrafficModel
+		{
+		public:
+			using Duration_t = std::chrono::nanoseconds;
+
+			virtual ~TrafficModel() = default;
+
+			/// @brief Draws the next packet
+			/// @param gap The time between the previous packet and this one
+			/// @param payloadSize The payload size of this packet
+			/// @return False if the model has no more packets
+			virtual bool Next(Duration_t& gap, uint32_t& payloadSize) noexcept = 0;
+			/// @brief Sets the range payload sizes are drawn uniformly from
+			/// @param minSize The smallest payload size
+			/// @param maxSize The largest payload size
+			virtual void SetPayloadSizes(uint32_t minSize, uint32_t maxSize) noexcept;
+			/// @brief Sets the mean time between packets
+			/// @param gap The mean time between packets
+			virtual void SetGap(Duration_t gap) noexcept = 0;
+			/// @brief Starts the model over, so repeated runs replay the same
+			/// traffic. Reseeds the draws with the model's seed
+			virtual void Rewind() noexcept { m_random.seed(m_seed); }
+			/// @brief Gets the largest payload size the model produces
+			virtual uint32_t GetMaxPayloadSize() const noexcept { return m_maxSize; }
+			/// @brief Seeds the draws of gaps and sizes, so a run can be replayed
+			/// @param seed The seed
+			void Seed(uint64_t seed) noexcept
+			{
+				m_seed = seed;
+				m_random.seed(seed);
+			}
+
+			/// @brief Gets the mean time between packets of a packet rate, to
+			/// the nanosecond so the rate holds over long runs
+			/// @param packetRate The packets per second. Requires: nonzero
+			/// @return The gap
+			static Duration_t GetGap(uint32_t packetRate) noexcept
+			{
+				return Duration_t(std::chrono::seconds(1)) / packetRate;
+			}
+
+			/// @brief Creates a model from its description
+			/// @param shape One of cbr, poisson, onoff:<burst packets>:<off ms> 
+			/// or trace:<file>
+			/// @param gap The mean time between packets
+			/// @param minSize The smallest payload size
+			/// @param maxSize The largest payload size
+			/// @throws std::runtime_error
+			/// @throws asio::error_code if a trace can't be mapped
+			/// @return The model
+			static std::unique_ptr<TrafficModel> Create(const std::string& shape,
+				Duration_t gap, uint32_t minSize, uint32_t maxSize);
+		protected:
+			/// @brief Draws a payload size from the size range
+			uint32_t NextPayloadSize() noexcept;
+
+			uint64_t m_seed{ std::random_device()() };
+			std::mt19937_64 m_random{ m_seed };
+		private:
+			uint32_t m_minSize = 0;
+			uint32_t m_maxSize = 0;
+		};
+
+		/// @brief ConstantModel sends at a constant rate
+		class ConstantModel : public TrafficModel
+		{
+		public:
+			explicit ConstantModel(Duration_t gap) noexcept : m_gap(gap) {}
+
+			bool Next(Duration_t& gap, uint32_t& payloadSize) noexcept override;
+			void SetGap(Duration_t gap) noexcept override { m_gap = gap; }
+		private:
+			Duration_t m_gap;
+		};
+
+		/// @brief PoissonModel sends with exponentially distributed gaps
+		class PoissonModel : public TrafficModel
+		{
+		public:
+			explicit PoissonModel(Duration_t meanGap) noexcept
+				: m_distribution(1. / static_cast<double>(meanGap.count())) {}
+
+			bool Next(Duration_t& gap, uint32_t& payloadSize) noexcept override;
+			void SetGap(Duration_t meanGap) noexcept override
+			{
+				m_distribution = std::exponential_distribution<double>(1. / static_cast<double>(meanGap.count()));
+			}
+			void Rewind() noexcept override
+			{
+				TrafficModel::Rewind();
+				m_distribution.reset();
+			}
+		private:
+			std::exponential_distribution<double> m_distribution;
+		};
+
+		/// @brief OnOffModel sends bursts at a constant rate separated by silence
+		class OnOffModel : public TrafficModel
+		{
+		public:
+			/// @param gap The time between packets within a burst
+			/// @param burstLength The number of packets in a burst. Requires: nonzero
+			/// @param offTime The silence between bursts
+			OnOffModel(Duration_t gap, uint32_t burstLength, Duration_t offTime) noexcept
+				: m_gap(gap), m_offTime(offTime), m_burstLength(burstLength), m_sentInBurst(0) {}
+
+			bool Next(Duration_t& gap, uint32_t& payloadSize) noexcept override;
+			/// @brief Sets the time between packets within a burst
+			void SetGap(Duration_t gap) noexcept override { m_gap = gap; }
+			void Rewind() noexcept override
+			{
+				TrafficModel::Rewind();
+				m_sentInBurst = 0;
+			}
+		private:
+			Duration_t m_gap;
+			Duration_t m_offTime;
+			uint32_t m_burstLength;
+			uint32_t m_sentInBurst;
+		};
+
+		/// @brief TraceModel replays a text trace of "<timestamp us> <payload size>"
+		/// lines, parsed straight out of a memory-mapped file
+		class TraceModel : public TrafficModel
+		{
+		public:
+			/// @param path The path of the trace
+			/// @throws asio::error_code
+			explicit TraceModel(const std::string& path);
+
+			bool Next(Duration_t& gap, uint32_t& payloadSize) noexcept override;
+			void SetPayloadSizes(uint32_t, uint32_t) noexcept override {}
+			/// @brief The trace brings its own timing
+			void SetGap(Duration_t) noexcept override {}
+			void Rewind() noexcept override;
+			/// @brief The largest size in the trace, found when it was opened
+			uint32_t GetMaxPayloadSize() const noexcept override { return m_maxPayloadSize; }
+		private:
+			/// @brief Parses the next packet line, skipping blank lines,
+			/// comments and malformed lines
+			/// @param position Where to start, moved past the line
+			/// @param end The end of the trace
+			/// @param timestamp The packet's timestamp in microseconds
+			/// @param size The packet's payload size
+			/// @return False at the end of the trace
+			static bool ParseLine(const char*& position, const char* end,
+				uint64_t& timestamp, uint32_t& size) noexcept;
+
+			MappedFile m_file;
+			uint32_t m_maxPayloadSize;
+			const char* m_position;
+			uint64_t m_lastTimestamp;
+			bool m_started;
+		};
+	}
+}
+
+#endif
\ No newline at end of file
@@ -5,64 +5,227 @@
 /// Transport
 /// 6/22/20 21:06
 
+// UDPTest includes
+#include <UDPTest/Detail/Checksum.h>
+#include <UDPTest/Detail/Payload.h>
+#include <UDPTest/Detail/WireFormat.h>
+
 // asio includes
 #include <asio.hpp>
 
 // STL includes
 #include <array>
 #include <cstdint>
-#include <random>
+#include <cstring>
 
 namespace UDPTest
 {
 	namespace Detail
 	{
+		/// @brief RandomPacket is a datagram of a negotiated header and a
+		/// generated payload, laid out in one contiguous cache-aligned buffer
+		/// so it goes out in a single iovec
 		class RandomPacket
 		{
 		public:
-			RandomPacket() = default;
-			RandomPacket(uint32_t size) noexcept : m_payload(size) {}
-			RandomPacket(uint32_t seq, uint32_t size) noexcept 
-				: m_seq(htonl(seq)) 
+			/// @brief The largest UDP datagram
+			static constexpr uint32_t MaxDatagramSize = 65507;
+			/// @brief The largest payload, behind the smallest header
+			static constexpr uint32_t MaxPayloadSize = MaxDatagramSize - sizeof(uint32_t);
+			/// @brief Sequence numbers at and above this are path MTU probes, 
+			/// with the probed payload size in the low 16 bits
+			static constexpr uint32_t ProbeSeqBase = 0xFFFF0000;
+			/// @brief The number of seqs on the wire below the probes. Senders
+			/// count seqs in 64 bits and send them modulo this
+			static constexpr uint64_t SeqSpace = ProbeSeqBase;
+
+			/// @brief Gets the seq a packet carries on the wire
+			/// @param seq The 64-bit seq
+			/// @return The wire seq, which skips the probe range on wrapping
+			static constexpr uint32_t ToWireSeq(uint64_t seq) noexcept
+			{
+				return static_cast<uint32_t>(seq % SeqSpace);
+			}
+
+			/// @brief Extends a wire seq to the 64-bit seq nearest a reference,
+			/// which is unambiguous while seqs stay within half the wire space
+			/// of it
+			/// @param wireSeq The wire seq. Requires: below ProbeSeqBase
+			/// @param reference A 64-bit seq near it, e.g. the highest seen
+			/// @return The 64-bit seq
+			static constexpr uint64_t ExtendSeq(uint32_t wireSeq, uint64_t reference) noexcept
+			{
+				const uint64_t ahead = (wireSeq + SeqSpace - reference % SeqSpace) % SeqSpace;
+				if (ahead < SeqSpace / 2 || SeqSpace - ahead > reference)
+					return reference + ahead;
+				return reference - (SeqSpace - ahead);
+			}
+
+			enum Flags : uint8_t
+			{
+				/// @brief The packet is a path MTU probe
+				Probe = 0x01
+			};
+
+			RandomPacket() noexcept : RandomPacket(BasePacketFields) {}
+			/// @brief Creates an empty packet
+			/// @param fields The header fields, the base fields are always added
+			explicit RandomPacket(FieldSet fields) noexcept
+				: m_layout(&PacketLayouts[fields | BasePacketFields]), m_size(0) {}
+			/// @brief Creates a packet to receive into
+			/// @param fields The header fields, the base fields are always added
+			/// @param payloadSize The largest payload to receive
+			RandomPacket(FieldSet fields, uint32_t payloadSize) : RandomPacket(fields)
+			{
+				Resize(payloadSize);
+			}
+
+			/// @brief Refills the packet in place, reusing its buffer. Fields
+			/// other than the seq are cleared, set them with GetHeader
+			/// @param seq The sequence number
+			/// @param size The payload size
+			/// @param seed The payload generator seed
+			void Fill(uint32_t seq, uint32_t size, uint32_t seed) noexcept
 			{
-				static std::random_device rd;
-				static std::mt19937 mt(rd());
-				static std::uniform_int_distribution<uint16_t> d(0, UCHAR_MAX);
-				for (uint32_t i = 0; i < size; ++i)
-					m_payload.push_back(static_cast<uint8_t>(d(mt)));
+				Resize(size);
+				std::memset(m_buffer.GetData(), 0, m_layout->size);
+				GetHeader().Set<Field::Seq>(seq);
+				FillPayload(m_buffer.GetData() + m_layout->size, size, seed, seq);
 			}
 
-			uint32_t GetSeq() const noexcept { return ntohl(m_seq); }
+			HeaderView<uint8_t> GetHeader() noexcept
+			{
+				return HeaderView<uint8_t>(*m_layout, m_buffer.GetData());
+			}
+			HeaderView<const uint8_t> GetHeader() const noexcept
+			{
+				return HeaderView<const uint8_t>(*m_layout, m_buffer.GetData());
+			}
 
-			size_t GetPayloadSize() const noexcept { return m_payload.size(); }
+			uint32_t GetSeq() const noexcept { return GetHeader().Get<Field::Seq>(); }
+
+			/// @brief Gets whether the packet is a path MTU probe
+			bool IsProbe() const noexcept
+			{
+				return GetSeq() >= ProbeSeqBase ||
+					(GetHeader().Get<Field::Flags>() & Flags::Probe) != 0;
+			}
+
+			size_t GetPayloadSize() const noexcept { return m_size - m_layout->size; }
+
+			size_t GetHeaderSize() const noexcept { return m_layout->size; }
+
+			/// @brief Gets the size of the datagram
+			size_t GetSize() const noexcept { return m_size; }
+
+			/// @brief Writes the checksum into the header.
+			/// Requires: a header with a checksum, and every other field set
+			void Seal() noexcept
+			{
+				GetHeader().Set<Field::Checksum>(Checksum(m_size));
+			}
 
-			std::array<asio::mutable_buffer, 2> GetBuffers() noexcept
+			/// @brief Checks the checksum of a received packet
+			/// @param bytes The size of the received datagram
+			/// @return Whether the packet arrived as it was sealed
+			bool Verify(size_t bytes) const noexcept
 			{
-				return 
-				{
-					asio::buffer(&m_seq, 4),
-					asio::buffer(m_payload)
-				};
+				return bytes >= m_layout->size &&
+					GetHeader().Get<Field::Checksum>() == Checksum(bytes);
+			}
+
+			/// @brief Checks a received payload against the generator
+			/// @param bytes The size of the received datagram
+			/// @param seed The payload generator seed
+			/// @return Whether the payload is what the generator yields
+			bool CheckFill(size_t bytes, uint32_t seed) const noexcept
+			{
+				return bytes >= m_layout->size && CheckPayload(m_buffer.GetData() + m_layout->size,
+					bytes - m_layout->size, seed, GetSeq());
+			}
+
+			asio::mutable_buffer GetBuffers() noexcept
+			{
+				return asio::buffer(m_buffer.GetData(), m_size);
 			}
 		private:
-			uint32_t m_seq = 0;
-			std::vector<uint8_t> m_payload;
+			void Resize(uint32_t payloadSize)
+			{
+				m_size = m_layout->size + payloadSize;
+				m_buffer.Reserve(m_size);
+			}
+
+			/// @brief Computes the CRC32C of everything but the checksum
+			/// @param bytes The size of the datagram
+			uint32_t Checksum(size_t bytes) const noexcept
+			{
+				const uint8_t* const data = m_buffer.GetData();
+				const size_t offset = m_layout->offsets[static_cast<size_t>(Field::Checksum)];
+				const size_t rest = offset + sizeof(FieldType<Field::Checksum>::Type);
+				return Crc32c(data + rest, bytes - rest, Crc32c(data, offset));
+			}
+
+			const HeaderLayout* m_layout;
+			AlignedBuffer m_buffer;
+			size_t m_size;
 		};
 
 		class PacketAck
 		{
 		public:
-			PacketAck() = default;
-			PacketAck(uint32_t seq) noexcept : m_seq(htonl(seq)) {}
+			enum Flags : uint8_t
+			{
+				/// @brief The packet failed its integrity check
+				Corrupt = 0x01
+			};
+
+			PacketAck() noexcept : PacketAck(BaseAckFields) {}
+			/// @brief Creates an ack to receive into
+			/// @param fields The ack's fields, the base fields are always added
+			explicit PacketAck(FieldSet fields) noexcept
+				: m_layout(&AckLayouts[fields | BaseAckFields]), m_data{} {}
+			PacketAck(uint32_t seq, uint8_t flags = 0) noexcept : PacketAck()
+			{
+				GetHeader().Set<Field::Seq>(seq);
+				GetHeader().Set<Field::Flags>(flags);
+			}
+			/// @brief Creates the ack of a packet, echoing the fields they share
+			/// @param fields The ack's fields, the base fields are always added
+			/// @param packet The packet's header
+			/// @param flags The ack flags
+			PacketAck(FieldSet fields, const HeaderView<const uint8_t>& packet,
+				uint8_t flags) noexcept : PacketAck(fields)
+			{
+				const HeaderView<uint8_t> header = GetHeader();
+				header.Set<Field::Seq>(packet.Get<Field::Seq>());
+				header.Set<Field::Flags>(flags);
+				header.Set<Field::Timestamp>(packet.Get<Field::Timestamp>());
+				header.Set<Field::StreamId>(packet.Get<Field::StreamId>());
+			}
+
+			HeaderView<uint8_t> GetHeader() noexcept
+			{
+				return HeaderView<uint8_t>(*m_layout, m_data.data());
+			}
+			HeaderView<const uint8_t> GetHeader() const noexcept
+			{
+				return HeaderView<const uint8_t>(*m_layout, m_data.data());
+			}
+
+			uint32_t GetSeq() const noexcept { return GetHeader().Get<Field::Seq>(); }
+
+			uint8_t GetFlags() const noexcept { return GetHeader().Get<Field::Flags>(); }
 
-			uint32_t GetSeq() const noexcept { return ntohl(m_seq); }
+			/// @brief Gets the size of the ack
+			size_t GetSize() const noexcept { return m_layout->size; }
 
-			std::array<asio::mutable_buffer, 1> GetBuffers() noexcept
+			asio::mutable_buffer GetBuffers() noexcept
 			{
-				return { asio::buffer(&m_seq, 4) };
+				return asio::buffer(m_data.data(), m_layout->size);
 			}
 		private:
-			uint32_t m_seq = 0;
+			const HeaderLayout* m_layout;
+			std::array<uint8_t, MaxAckSize> m_data;
 		};
 	}
 }
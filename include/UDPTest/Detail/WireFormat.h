@@ -0,0 +1,279 @@
+#ifndef UDPTEST_DETAIL_WIREFORMAT_H_
+#define UDPTEST_DETAIL_WIREFORMAT_H_
+
+/// @file
+/// Wire Format
+/// 10/19/26 21:55
+
+// UDPTest includes
+#include <UDPTest/Detail/SPSCQueue.h>
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+
+namespace UDPTest
+{
+	namespace Detail
+	{
+		/// @brief The version of the datagram layouts, checked when a
+		/// transport is opened
+		constexpr uint8_t WireVersion = 1;
+
+		/// @brief The fields a datagram header can carry
+		enum class Field : uint8_t
+		{
+			Seq,
+			/// @brief The CRC32C of the rest of the datagram
+			Checksum,
+			/// @brief The sender's clock when the packet was sent, echoed in
+			/// its ack
+			Timestamp,
+			/// @brief Tells apart the streams sharing a transport, echoed in
+			/// the ack
+			StreamId,
+			Flags,
+			Count
+		};
+
+		/// @brief A set of fields, one bit per field
+		using FieldSet = uint8_t;
+
+		constexpr FieldSet FieldBit(Field field) noexcept
+		{
+			return static_cast<FieldSet>(1 << static_cast<uint8_t>(field));
+		}
+
+		/// @brief The value type of each field, which is also its size on
+		/// the wire
+		template<Field F> struct FieldType;
+		template<> struct FieldType<Field::Seq> { using Type = uint32_t; };
+		template<> struct FieldType<Field::Checksum> { using Type = uint32_t; };
+		template<> struct FieldType<Field::Timestamp> { using Type = uint64_t; };
+		template<> struct FieldType<Field::StreamId> { using Type = uint16_t; };
+		template<> struct FieldType<Field::Flags> { using Type = uint8_t; };
+
+		struct FieldDescriptor
+		{
+			Field field;
+			uint8_t size;
+		};
+
+		template<Field F>
+		constexpr FieldDescriptor Describe() noexcept
+		{
+			return { F, sizeof(typename FieldType<F>::Type) };
+		}
+
+		/// @brief The order fields are laid out in a packet. A packet with
+		/// only a seq, or a seq and a checksum, is laid out as before headers
+		/// were negotiated
+		constexpr std::array<FieldDescriptor, 5> PacketFields =
+		{
+			Describe<Field::Seq>(),
+			Describe<Field::Checksum>(),
+			Describe<Field::Timestamp>(),
+			Describe<Field::StreamId>(),
+			Describe<Field::Flags>()
+		};
+		/// @brief The order fields are laid out in an ack
+		constexpr std::array<FieldDescriptor, 4> AckFields =
+		{
+			Describe<Field::Seq>(),
+			Describe<Field::Flags>(),
+			Describe<Field::Timestamp>(),
+			Describe<Field::StreamId>()
+		};
+
+		/// @brief The fields every packet carries
+		constexpr FieldSet BasePacketFields = FieldBit(Field::Seq);
+		/// @brief The fields every ack carries
+		constexpr FieldSet BaseAckFields = FieldBit(Field::Seq) | FieldBit(Field::Flags);
+		constexpr size_t FieldSetCount = size_t(1) << static_cast<size_t>(Field::Count);
+
+		/// @brief Gets the fields of the ack of a packet, which echoes what
+		/// the sender needs back
+		/// @param packetFields The fields of the packet
+		/// @return The fields of the ack
+		constexpr FieldSet GetAckFields(FieldSet packetFields) noexcept
+		{
+			return BaseAckFields | (packetFields &
+				(FieldBit(Field::Timestamp) | FieldBit(Field::StreamId)));
+		}
+
+		/// @brief Where each field of a field set sits in a header
+		struct HeaderLayout
+		{
+			static constexpr uint8_t Absent = 0xFF;
+
+			FieldSet fields;
+			uint8_t size;
+			std::array<uint8_t, static_cast<size_t>(Field::Count)> offsets;
+
+			constexpr bool Has(Field field) const noexcept
+			{
+				return (fields & FieldBit(field)) != 0;
+			}
+		};
+
+		/// @brief Lays out a field set, skipping the fields it doesn't have
+		/// @param order The order of the fields
+		/// @param fields The field set
+		/// @return The layout
+		template<size_t N>
+		constexpr HeaderLayout MakeLayout(const std::array<FieldDescriptor, N>& order,
+			FieldSet fields) noexcept
+		{
+			HeaderLayout layout{ 0, 0, {} };
+			for (uint8_t& offset : layout.offsets)
+				offset = HeaderLayout::Absent;
+			for (const FieldDescriptor& descriptor : order)
+			{
+				if ((fields & FieldBit(descriptor.field)) == 0)
+					continue;
+				layout.fields |= FieldBit(descriptor.field);
+				layout.offsets[static_cast<size_t>(descriptor.field)] = layout.size;
+				layout.size += descriptor.size;
+			}
+			return layout;
+		}
+
+		/// @brief Lays out every field set
+		template<size_t N>
+		constexpr std::array<HeaderLayout, FieldSetCount> MakeLayouts(
+			const std::array<FieldDescriptor, N>& order) noexcept
+		{
+			std::array<HeaderLayout, FieldSetCount> layouts{};
+			for (size_t fields = 0; fields < FieldSetCount; ++fields)
+				layouts[fields] = MakeLayout(order, static_cast<FieldSet>(fields));
+			return layouts;
+		}
+
+		/// @brief Every packet and ack layout, computed at compile time so a
+		/// negotiated field set costs a table lookup
+		inline constexpr std::array<HeaderLayout, FieldSetCount> PacketLayouts = MakeLayouts(PacketFields);
+		inline constexpr std::array<HeaderLayout, FieldSetCount> AckLayouts = MakeLayouts(AckFields);
+
+		/// @brief The largest ack
+		constexpr size_t MaxAckSize = AckLayouts[FieldSetCount - 1].size;
+
+		static_assert(PacketLayouts[BasePacketFields].size == 4 &&
+			PacketLayouts[BasePacketFields | FieldBit(Field::Checksum)].offsets[
+				static_cast<size_t>(Field::Checksum)] == 4 &&
+			AckLayouts[BaseAckFields].size == 5,
+			"The base layouts must match the layouts before headers were negotiated");
+
+		/// @brief Stores an integer in network byte order
+		template<typename T>
+		void StoreBigEndian(uint8_t* data, T value) noexcept
+		{
+			static_assert(std::is_unsigned_v<T>, "Only unsigned integers go on the wire");
+			for (size_t i = sizeof(T); i-- != 0;)
+			{
+				data[i] = static_cast<uint8_t>(value);
+				value = static_cast<T>(value >> 8);
+			}
+		}
+
+		/// @brief Loads an integer in network byte order
+		template<typename T>
+		T LoadBigEndian(const uint8_t* data) noexcept
+		{
+			static_assert(std::is_unsigned_v<T>, "Only unsigned integers go on the wire");
+			T value = 0;
+			for (size_t i = 0; i < sizeof(T); ++i)
+				value = static_cast<T>((value << 8) | data[i]);
+			return value;
+		}
+
+		/// @brief HeaderView reads, and for mutable bytes writes, the fields
+		/// of a header in place
+		/// @tparam Byte_t uint8_t, or const uint8_t for a read-only view
+		template<typename Byte_t>
+		class HeaderView
+		{
+		public:
+			/// @param layout The header's layout
+			/// @param data The first byte of the header. Requires: at least
+			/// layout.size bytes
+			HeaderView(const HeaderLayout& layout, Byte_t* data) noexcept
+				: m_layout(&layout), m_data(data) {}
+
+			const HeaderLayout& GetLayout() const noexcept { return *m_layout; }
+
+			/// @brief Gets a field
+			/// @return The value, or 0 if the header doesn't carry the field
+			template<Field F>
+			typename FieldType<F>::Type Get() const noexcept
+			{
+				const uint8_t offset = m_layout->offsets[static_cast<size_t>(F)];
+				return (offset != HeaderLayout::Absent) ?
+					LoadBigEndian<typename FieldType<F>::Type>(m_data + offset) : 0;
+			}
+
+			/// @brief Sets a field, if the header carries it
+			template<Field F, typename B = Byte_t,
+				typename = std::enable_if_t<std::is_const_v<B> == false>>
+			void Set(typename FieldType<F>::Type value) const noexcept
+			{
+				const uint8_t offset = m_layout->offsets[static_cast<size_t>(F)];
+				if (offset != HeaderLayout::Absent)
+					StoreBigEndian(m_data + offset, value);
+			}
+		private:
+			const HeaderLayout* m_layout;
+			Byte_t* m_data;
+		};
+
+		/// @brief AlignedBuffer is a byte buffer that starts on a cache line
+		class AlignedBuffer
+		{
+		public:
+			AlignedBuffer() = default;
+
+			/// @brief Makes room for a number of bytes, dropping the contents
+			/// if the buffer has to grow
+			void Reserve(size_t size)
+			{
+				if (size <= m_capacity)
+					return;
+				m_data.reset(static_cast<uint8_t*>(::operator new(size, std::align_val_t(CacheLineSize))));
+				m_capacity = size;
+			}
+
+			uint8_t* GetData() noexcept { return m_data.get(); }
+			const uint8_t* GetData() const noexcept { return m_data.get(); }
+			size_t GetCapacity() const noexcept { return m_capacity; }
+		private:
+			struct Deleter
+			{
+				void operator()(uint8_t* data) const noexcept
+				{
+					::operator delete(data, std::align_val_t(CacheLineSize));
+				}
+			};
+
+			std::unique_ptr<uint8_t, Deleter> m_data;
+			size_t m_capacity = 0;
+		};
+
+		/// @brief Parses the optional packet fields
+		/// @param spec Comma-separated timestamp, stream and flags, or empty
+		/// for none
+		/// @throws std::runtime_error
+		/// @return The fields, without the base fields
+		FieldSet ParseFields(const std::string& spec);
+
+		/// @brief Describes a field set
+		/// @param fields The fields
+		/// @return The field names, separated by commas
+		std::string DescribeFields(FieldSet fields);
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef UDPTEST_EXPORTER_H_
+#define UDPTEST_EXPORTER_H_
+
+/// @file
+/// Exporter
+/// 10/19/26 14:40
+
+// UDPTest includes
+#include <UDPTest/Detail/MetricsSegment.h>
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <ostream>
+#include <string>
+
+namespace UDPTest
+{
+	/// @brief Exporter serves a metrics segment in the Prometheus text format.
+	/// It runs in its own process, so scrapes never touch a transport thread
+	class Exporter
+	{
+	public:
+		using ErrorCode_t = asio::error_code;
+		using Proto_t = asio::ip::tcp;
+		using Socket_t = Proto_t::socket;
+
+		/// @brief Creates an exporter
+		/// @param address The address to serve on
+		/// @param port The port to serve on
+		/// @param segment The name of the metrics segment to export
+		/// @throws ErrorCode_t
+		Exporter(const std::string& address, const std::string& port,
+			const std::string& segment);
+
+		/// @brief Runs the exporter
+		void Run() noexcept;
+
+		/// @brief Prints a human-readable table of a metrics segment
+		/// @param segment The name of the metrics segment
+		/// @param os The stream to print to
+		/// @throws ErrorCode_t
+		/// @throws std::runtime_error
+		static void PrintMetrics(const std::string& segment, std::ostream& os);
+		/// @brief Formats a metrics segment in the Prometheus text format
+		/// @param segment The metrics segment
+		/// @return The formatted metrics
+		static std::string FormatMetrics(const Detail::MetricsSegment& segment);
+	private:
+		/// @brief Accepts a new scrape
+		void Accept() noexcept;
+		/// @brief Answers a scrape with the current metrics
+		/// @param socket The scrape's socket
+		void Serve(Socket_t socket) noexcept;
+		/// @brief Closes the acceptor
+		void Stop() noexcept;
+		/// @brief Waits for a signal
+		void WaitSignals() noexcept;
+
+		asio::io_context m_worker;
+		Proto_t::acceptor m_acceptor;
+		asio::signal_set m_signals;
+		std::string m_segment;
+	};
+}
+
+#endif
\ No newline at end of file
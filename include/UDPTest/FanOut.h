@@ -0,0 +1,119 @@
+#ifndef UDPTEST_FANOUT_H_
+#define UDPTEST_FANOUT_H_
+
+/// @file
+/// Fan Out
+/// 10/19/26 22:25
+
+// UDPTest includes
+#include <UDPTest/Client.h>
+#include <UDPTest/Detail/CpuMeter.h>
+#include <UDPTest/Detail/MetricsSegment.h>
+#include <UDPTest/Detail/Reporter.h>
+#include <UDPTest/Detail/TrafficClass.h>
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace UDPTest
+{
+	/// @brief FanOut runs several flows from one process, each towards a
+	/// target of its own or as a traffic class of its own. Each flow gets
+	/// its own independently paced client, and all of them share one
+	/// transport thread, one reporter thread and one metrics segment
+	class FanOut
+	{
+	public:
+		using ErrorCode_t = asio::error_code;
+
+		/// @brief A flow and the traffic it sends
+		struct Flow
+		{
+			std::string address;
+			std::string port;
+			/// @brief The flow's traffic, named for it
+			Detail::TrafficClass trafficClass;
+		};
+
+		/// @brief Creates the client of a flow on the fan-out's pipeline
+		using MakeClient_t = std::function<std::unique_ptr<Client>(const Flow& flow,
+			const Client::Shared& shared)>;
+
+		/// @brief Creates a client per flow and starts them
+		/// @param flows The flows
+		/// @param metrics The shared-memory segment to publish every
+		/// flow's metrics to, or empty for none
+		/// @param perf Whether to read hardware counters with perf_event
+		/// @param makeClient Creates the client of each flow
+		/// @throws ErrorCode_t
+		/// @throws std::runtime_error
+		FanOut(const std::vector<Flow>& flows, const std::string& metrics, bool perf,
+			const MakeClient_t& makeClient);
+
+		/// @brief Runs every client until the last one finishes
+		void Run();
+
+		/// @brief Makes a flow per target, splitting a budget evenly
+		/// across them
+		/// @param targets Comma-separated <address>[:<port>] targets, with
+		/// IPv6 addresses in brackets
+		/// @param port The port of targets that don't name one
+		/// @param total The traffic of every flow, with the total bitrate
+		/// and packet rate to split
+		/// @throws std::runtime_error
+		/// @return The flows, named for their targets
+		static std::vector<Flow> SplitTargets(const std::string& targets,
+			const std::string& port, const Detail::TrafficClass& total);
+		/// @brief Makes a flow per traffic class, all towards one target
+		/// @param address The address of the target
+		/// @param port The port of the target
+		/// @param classes The classes, as TrafficClass::ParseList takes them
+		/// @param defaults What a class leaves out
+		/// @throws std::runtime_error
+		/// @return The flows, named for their classes
+		static std::vector<Flow> SplitClasses(const std::string& address,
+			const std::string& port, const std::string& classes,
+			const Detail::TrafficClass& defaults);
+
+		/// @brief Parses a list of targets
+		/// @param targets Comma-separated <address>[:<port>] targets, with
+		/// IPv6 addresses in brackets
+		/// @param port The port of targets that don't name one
+		/// @throws std::runtime_error
+		/// @return The address and port of each target, in order
+		static std::vector<std::pair<std::string, std::string>> ParseTargets(
+			const std::string& targets, const std::string& port);
+	private:
+		/// @brief Reports a flow's interval and adds it to the aggregate.
+		/// Runs on the reporter thread
+		/// @param stats The interval stats
+		void ReportInterval(const Client::IntervalStats& stats) noexcept;
+		/// @brief Prints the aggregate interval and starts the next
+		void FlushAggregate() noexcept;
+		/// @brief Prints every flow's totals side by side, and their aggregate
+		/// @param elapsed How long the fan-out ran
+		void PrintEndStats(std::chrono::nanoseconds elapsed) noexcept;
+
+		asio::io_context m_worker;
+		std::unique_ptr<Detail::MetricsSegment> m_metrics;
+		Detail::Reporter<Client::IntervalStats> m_reporter;
+		std::vector<Flow> m_flows;
+		std::vector<std::unique_ptr<Client>> m_clients;
+		Detail::CpuMeter m_cpuMeter;
+		/// @brief The intervals of every flow since the last flush, and
+		/// which flows they came from. A flow reporting twice flushes it
+		Client::IntervalStats m_aggregate;
+		std::vector<bool> m_aggregated;
+		size_t m_aggregatedCount;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef UDPTEST_LOGBENCHMARK_H_
+#define UDPTEST_LOGBENCHMARK_H_
+
+/// @file
+/// Log Benchmark
+/// 10/19/26 19:05
+
+// STL includes
+#include <cstdint>
+#include <ostream>
+
+namespace UDPTest
+{
+	/// @brief LogBenchmark measures what tracing every packet costs the
+	/// transport thread with each way of doing it
+	class LogBenchmark
+	{
+	public:
+		/// @brief Logs a number of packet events with stripped logs, spdlog
+		/// filtered by level, spdlog to a null sink, spdlog to a file and the
+		/// event log, and prints the cost of each per event
+		/// @param events The number of events per mode. Requires: nonzero
+		/// @param os The stream to print to
+		/// @throws std::runtime_error
+		static void Run(uint32_t events, std::ostream& os);
+	};
+}
+
+#endif
\ No newline at end of file
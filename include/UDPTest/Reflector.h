@@ -0,0 +1,153 @@
+#ifndef UDPTEST_REFLECTOR_H_
+#define UDPTEST_REFLECTOR_H_
+
+/// @file
+/// Reflector
+/// 10/19/26 17:20
+
+// UDPTest includes
+#include <UDPTest/Common.h>
+#include <UDPTest/Detail/CpuMeter.h>
+#include <UDPTest/Detail/FlowTable.h>
+#include <UDPTest/Detail/MetricsSegment.h>
+#include <UDPTest/Detail/Transport.h>
+
+// asio includes
+#include <asio.hpp>
+
+// STL includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace UDPTest
+{
+	/// @brief Reflector is a stateless server that acks every client from
+	/// shared UDP sockets, without a control connection. Flows are tracked
+	/// by source endpoint and forgotten once they go idle
+	class Reflector
+	{
+	public:
+		using ErrorCode_t = asio::error_code;
+		using Proto_t = asio::ip::udp;
+		using Socket_t = Proto_t::socket;
+
+		/// @brief Creates a reflector
+		/// @param address The address to use
+		/// @param port The port to use
+		/// @param shards The number of sockets sharing the port, each with
+		/// its own thread. Requires: nonzero
+		/// @param receiveDepth The number of concurrent receives per shard.
+		/// Requires: nonzero
+		/// @param idleTimeout The seconds a flow may be silent before it is
+		/// forgotten
+		/// @param maxFlows The most flows each shard tracks
+		/// @param metrics The shared-memory segment to publish metrics to,
+		/// or empty for none
+		/// @param perf Whether to read hardware counters with perf_event
+		/// @throws ErrorCode_t
+		Reflector(const std::string& address, const std::string& port,
+			size_t shards, size_t receiveDepth, uint32_t idleTimeout,
+			size_t maxFlows, const std::string& metrics, bool perf);
+		~Reflector();
+
+		/// @brief Runs the reflector
+		void Run() noexcept;
+	private:
+		/// @brief Cumulative shard totals, stored once a tick by the shard
+		/// and read by the main thread
+		struct alignas(64) ShardTotals
+		{
+			std::atomic<uint64_t> packetsReceived{ 0 };
+			std::atomic<uint64_t> bytesReceived{ 0 };
+			std::atomic<uint64_t> acksDropped{ 0 };
+			std::atomic<uint64_t> flows{ 0 };
+			std::atomic<uint64_t> flowsOpened{ 0 };
+			std::atomic<uint64_t> flowsEvicted{ 0 };
+			std::atomic<uint64_t> flowsRejected{ 0 };
+			std::atomic<uint64_t> lostTotal{ 0 };
+			std::atomic<uint64_t> cpuNs{ 0 };
+			std::atomic<uint64_t> contextSwitches{ 0 };
+		};
+
+		/// @brief A socket on the shared port with its own thread and flows
+		struct Shard
+		{
+			/// @brief A receive buffer with its own source endpoint
+			struct ReceiveSlot
+			{
+				Detail::RandomPacket packet;
+				Proto_t::endpoint endpoint;
+			};
+
+			Shard(size_t receiveDepth, size_t maxFlows, bool perf);
+
+			asio::io_context worker;
+			Socket_t socket;
+			asio::steady_timer tickTimer;
+			std::vector<ReceiveSlot> receiveSlots;
+			Detail::FlowTable flows;
+			uint32_t tick;
+			uint64_t packetsReceived;
+			uint64_t bytesReceived;
+			uint64_t acksDropped;
+			uint64_t flowsOpened;
+			uint64_t flowsEvicted;
+			uint64_t flowsRejected;
+			/// @brief The loss of flows that were already evicted
+			uint64_t evictedLost;
+			ShardTotals totals;
+			Detail::CpuMeter cpuMeter;
+			/// @brief The shard thread's usage when it stopped, read once
+			/// it is joined
+			Detail::CpuMeter::Usage cpuUsage;
+			std::thread thread;
+		};
+
+		/// @brief What the main thread saw of a shard at the last print
+		struct ShardView
+		{
+			uint64_t packetsReceived = 0;
+			uint64_t bytesReceived = 0;
+			uint64_t flowsOpened = 0;
+			uint64_t flowsEvicted = 0;
+			uint32_t metricsSlot = Detail::MetricsSegment::SlotCount;
+			std::array<uint64_t, Detail::MetricsSegment::CounterCount> counters{};
+		};
+
+		/// @brief Receives into a slot of a shard and acks what arrives
+		/// @param shard The shard
+		/// @param slot The index of the receive slot
+		void ReadTransport(Shard& shard, size_t slot) noexcept;
+		/// @brief Accounts a packet to its flow
+		/// @param shard The shard
+		/// @param endpoint The source of the packet
+		/// @param seq The sequence number of the packet
+		void TrackFlow(Shard& shard, const Proto_t::endpoint& endpoint,
+			uint32_t seq) noexcept;
+		/// @brief Advances a shard's tick every second, evicting idle flows
+		/// and publishing the shard's totals
+		/// @param shard The shard
+		void AwaitTick(Shard& shard) noexcept;
+		/// @brief Stops every shard and the main thread
+		void Stop() noexcept;
+		/// @brief Waits for a signal
+		void WaitSignals() noexcept;
+		/// @brief Awaits the stats print
+		void AwaitPrint() noexcept;
+
+		asio::io_context m_worker;
+		asio::signal_set m_signals;
+		asio::steady_timer m_printTimer;
+		uint32_t m_idleTimeout;
+		std::vector<std::unique_ptr<Shard>> m_shards;
+		std::vector<ShardView> m_views;
+		std::unique_ptr<Detail::MetricsSegment> m_metrics;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -8,14 +8,23 @@
 // UDPTest includes
 #include <UDPTest/Common.h>
 #include <UDPTest/Detail/ConnectionManager.h>
+#include <UDPTest/Detail/CpuMeter.h>
+#include <UDPTest/Detail/EventLog.h>
+#include <UDPTest/Detail/Impairment.h>
+#include <UDPTest/Detail/MetricsSegment.h>
+#include <UDPTest/Detail/Reporter.h>
 
 // asio includes
 #include <asio.hpp>
 
 // STL includes
 #include <cstdint>
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <unordered_map>
 
 namespace UDPTest
 {
@@ -30,23 +39,103 @@ namespace UDPTest
 		/// @brief Creates a UDP test server
 		/// @param address The address to use
 		/// @param port The port to use
+		/// @param receiveDepth The number of concurrent transport receives
+		/// per connection. Requires: nonzero
+		/// @param metrics The shared-memory segment to publish metrics to,
+		/// or empty for none
+		/// @param eventLog The file to record packet events to, or empty for none
+		/// @param perf Whether to read hardware counters with perf_event
+		/// @param impairment The impairments to apply to acks, as parsed by
+		/// Detail::ImpairmentConfig::Parse, or empty for none
 		/// @throws ErrorCode_t
-		Server(const std::string& address, const std::string& port);
+		/// @throws std::runtime_error
+		Server(const std::string& address, const std::string& port,
+			size_t receiveDepth, const std::string& metrics,
+			const std::string& eventLog, bool perf, const std::string& impairment);
 
 		/// @brief Runs the UDP test bench server
 		void Run() noexcept;
 	private:
+		/// @brief The number of snapshots that can wait for the reporter,
+		/// and of ack latency slots handed over with them
+		static constexpr size_t ReporterQueueSize = 256;
+		/// @brief The most connections served at once, so a collection
+		/// round and its marker always fit the reporter queue
+		static constexpr size_t MaxConnections = ReporterQueueSize - 1;
+
+		/// @brief A connection's ack latency, handed to the reporter whole
+		/// with its snapshot
+		struct LatencySlot
+		{
+			Detail::Histogram latency;
+			/// @brief Set by the worker thread when it hands the slot over,
+			/// cleared by the reporter thread once it reported it
+			std::atomic<bool> busy{ false };
+		};
+
+		/// @brief A connection's stats
+		struct ConnectionSnapshot
+		{
+			/// @brief The connection, or 0 to mark the end of a collection round
+			uint64_t id = 0;
+			std::array<char, Detail::MetricsSegment::NameSize> name{};
+			/// @brief The latency slot with the connection's ack latency
+			uint32_t latencySlot = 0;
+			Detail::ConnectionStats stats;
+			/// @brief The worker thread's usage since the server started
+			uint64_t cpuNs = 0;
+			uint64_t contextSwitches = 0;
+		};
+
+		/// @brief The cumulative metrics of a connection. Only touched by
+		/// the reporter thread
+		struct ConnectionMetrics
+		{
+			uint32_t slot;
+			bool seen;
+			std::array<uint64_t, Detail::MetricsSegment::CounterCount> counters;
+			Detail::Histogram latency;
+		};
+
+		/// @brief Collects the stats of every connection and hands them to
+		/// the reporter
+		void CollectStats() noexcept;
 		/// @brief Accepts a new connection
 		void Accept() noexcept;
 		/// @brief Closes all resources and shuts down the test bench
 		void Stop() noexcept;
 		/// @brief Waits for a signal
 		void WaitSignals() noexcept;
+		/// @brief Awaits the stats print
+		void AwaitPrint() noexcept;
+		/// @brief Reports a connection snapshot. Runs on the reporter thread
+		/// @param snapshot The snapshot
+		void ReportStats(const ConnectionSnapshot& snapshot) noexcept;
+		/// @brief Reports a connection's stats
+		/// @param snapshot The snapshot
+		/// @param latency The connection's ack latency
+		void ReportConnection(const ConnectionSnapshot& snapshot,
+			const Detail::Histogram& latency) noexcept;
 
 		asio::io_context m_worker;
 		Proto_t::acceptor m_acceptor;
 		Detail::ConnectionManager m_connectionManager;
 		asio::signal_set m_signals;
+		asio::steady_timer m_printTimer;
+		size_t m_receiveDepth;
+		Detail::ImpairmentConfig m_impairment;
+		std::unique_ptr<Detail::MetricsSegment> m_metrics;
+		std::unordered_map<uint64_t, ConnectionMetrics> m_connectionMetrics;
+		/// @brief The ack latency handed to the reporter, taken in turn
+		std::unique_ptr<LatencySlot[]> m_latencySlots;
+		size_t m_nextLatencySlot;
+		/// @brief The collection rounds put off because the reporter fell behind
+		uint64_t m_deferredRounds;
+		Detail::Reporter<ConnectionSnapshot, ReporterQueueSize> m_reporter;
+		std::unique_ptr<Detail::EventLog> m_eventLog;
+		Detail::CpuMeter m_cpuMeter;
+		uint64_t m_packetsReceived;
+		uint64_t m_bytesReceived;
 	};
 }
 
@@ -0,0 +1,70 @@
+#ifndef UDPTEST_SIMULATION_H_
+#define UDPTEST_SIMULATION_H_
+
+/// @file
+/// Simulation
+/// 10/19/26 22:55
+
+// UDPTest includes
+#include <UDPTest/Detail/Impairment.h>
+#include <UDPTest/Detail/WireFormat.h>
+
+// STL includes
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace UDPTest
+{
+	/// @brief Simulation runs the client's pacing, send ring and ack
+	/// accounting against a server's receive accounting over a SimNetwork,
+	/// through the same Detail classes a client and a connection use, as
+	/// fast as the events can be processed, and checks every stat against
+	/// what the network knows really happened
+	class Simulation
+	{
+	public:
+		struct Config
+		{
+			/// @brief The impairments of each direction
+			Detail::ImpairmentConfig impairment;
+			/// @brief The chance, from 0 to 1, of a packet arriving at the
+			/// server corrupted. Only a checksum lets the server tell
+			double corrupt = 0;
+			/// @brief The bits per second the client's link serializes at,
+			/// a send holding its send ring entry until it is on the wire.
+			/// 0 for no limit
+			uint64_t linkRate = 0;
+			/// @brief The maximum number of in-flight sends. Requires: nonzero
+			uint32_t sendRingSize = 8;
+			/// @brief The catch-up policy, one of burst, drop or stretch
+			std::string catchUpPolicy = "burst";
+			/// @brief The seed of every draw, a run replays exactly for a seed
+			uint64_t seed = 1;
+			/// @brief The simulated seconds to send for
+			uint32_t time = 10;
+			uint32_t packetRate = 100;
+			uint64_t bitRate = 1000000;
+			/// @brief The traffic shape, as TrafficModel::Create takes it
+			std::string shape = "cbr";
+			/// @brief The packet header fields, as negotiated on open
+			Detail::FieldSet fields = Detail::BasePacketFields;
+		};
+
+		/// @brief Parses the network of a simulation
+		/// @param spec Comma-separated impairments as ImpairmentConfig::Parse
+		/// takes them, applied to each direction, plus corrupt=<%> and
+		/// link=<Mbit/s>
+		/// @param config The config to set the network of
+		/// @throws std::runtime_error
+		static void ParseNetwork(const std::string& spec, Config& config);
+		/// @brief Runs a simulation and prints each stat next to its ground truth
+		/// @param config The simulation
+		/// @param os The stream to print to
+		/// @throws std::runtime_error
+		/// @return Whether every stat matched its ground truth
+		static bool Run(const Config& config, std::ostream& os);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -1,40 +1,191 @@
 #include <UDPTest/Client.h>
 
 #include <UDPTest/Common.h>
+#include <UDPTest/Detail/KernelCounters.h>
+#include <UDPTest/Detail/SocketOptions.h>
+#include <UDPTest/Detail/Summary.h>
 
+#include <algorithm>
 #include <charconv>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 
 using UDPTest::Client;
 
-Client::Client(const std::string& address, const std::string& port,
-	const std::string& bitRate, uint32_t packetRate, uint32_t time) : m_worker(),
+Client::Client(const Config& config, const Shared* shared) :
+	m_ownWorker((shared == nullptr) ? std::make_unique<asio::io_context>() : nullptr),
+	m_worker((shared == nullptr) ? *m_ownWorker : shared->worker),
 	m_controlSocket(m_worker), m_transportSocket(m_worker),
-	m_signals(m_worker), m_endTimer(m_worker), m_printTimer(m_worker), 
-	m_sendTimer(m_worker), m_totalRecvTime(), m_maxRecvTime(),
-	m_recvTimeSinceLastCheck(), m_maxRecvTimeSinceLastCheck(0),
-	m_pending(0), m_seq(0), m_ack(0), m_time(time), m_totalBytes(0), 
-	m_bytesSinceLastCheck(0), m_packetsSinceLastCheck(0)
+	m_signals(m_worker), m_sendRing(config.sendRingSize), m_endTimer(m_worker),
+	m_printTimer(m_worker), m_sendTimer(m_worker), m_probeTimer(m_worker),
+	m_ackTracker(std::max<size_t>(LossWindowMin, static_cast<size_t>(config.packetRate) * LossWindowSeconds),
+		(Detail::ParseFields(config.header) & Detail::FieldBit(Detail::Field::Timestamp)) != 0, 0),
+	m_metrics((shared == nullptr) ? nullptr : shared->metrics),
+	m_metricsSlot(Detail::MetricsSegment::SlotCount), m_metricsCounters(), m_soakIntervals(0),
+	m_ownReporter((shared == nullptr) ? std::make_unique<Detail::Reporter<IntervalStats>>(
+		[this](const IntervalStats& stats) { ReportInterval(stats); }) : nullptr),
+	m_reporter((shared == nullptr) ? *m_ownReporter : shared->reporter),
+	m_target((shared == nullptr || shared->name.empty() == true) ? config.address + ':' + config.port : shared->name),
+	m_targetIndex((shared == nullptr) ? 0 : shared->target),
+	m_cpuMeter(config.perf),
+	m_sendHead(0), m_inFlight(0),
+	m_pacer(Detail::SendPacer::ParsePolicy(config.catchUpPolicy), config.sendRingSize),
+	m_phaseIndex(0), m_repeat(config.repeat), m_repeatIndex(0),
+	m_warmup(config.warmup), m_warmingUp(config.warmup != 0),
+	m_probeLow(0), m_probeHigh(0), m_probeSize(0), m_probeTries(0), m_pathMtu(0),
+	m_reflector(config.reflector), m_integrity(config.integrity), m_fresh(config.fresh),
+	m_fields(Detail::BasePacketFields | Detail::ParseFields(config.header) |
+		((config.integrity == true) ? Detail::FieldBit(Detail::Field::Checksum) : 0)),
+	m_headerSize(Detail::PacketLayouts[m_fields].size),
+	// the flows of a fan-out are numbered, so the server can tell them apart
+	m_streamId(((m_fields & Detail::FieldBit(Detail::Field::StreamId)) == 0) ? 0 :
+		(shared != nullptr) ? static_cast<uint16_t>(shared->target + 1) :
+		static_cast<uint16_t>(std::random_device()())),
+	m_tos(config.tos), m_priority(config.priority),
+	m_payloadSeed(std::random_device()()),
+	m_bytesPerSecond(0), m_bufferSize(0), m_connectTime(), m_handshakeTime(), m_setupTime(),
+	m_phaseChangeTime(), m_phaseChanges(0), m_serverDrops(0), m_phaseServerDrops(0),
+	m_clientDrops(0), m_phaseClientDrops(0), m_dropsSampled(false), m_sendDropped(0),
+	m_time(config.time),
+	m_totalBytes(0)
 {
 	spdlog::set_level(spdlog::level::debug);
 	ErrorCode_t ec;
 	// resolve local address
 	TCPProto_t::resolver resolver(m_worker);
-	TCPProto_t::endpoint remoteEndpoint = 
-		*resolver.resolve(address, port, ec);
+	TCPProto_t::endpoint remoteEndpoint =
+		*resolver.resolve(config.address, config.port, ec);
 	if (ec)
 		throw ec;
 	// register signals
 	m_signals.add(SIGINT);
 	m_signals.add(SIGTERM);
-	Connect(remoteEndpoint);
+	if (m_reflector == true)
+	{
+		// a reflector has no control connection, both checks need one
+		if (m_integrity == true || m_fresh == true)
+			throw std::runtime_error("A reflector can't verify integrity or payloads");
+		if (m_fields != Detail::BasePacketFields)
+			throw std::runtime_error("A reflector can't negotiate header fields");
+		const UDPProto_t::endpoint endpoint(remoteEndpoint.address(), remoteEndpoint.port());
+		asio::post(m_worker, [this, endpoint]() { OpenTransportLayer(endpoint); });
+	}
+	else
+		Connect(remoteEndpoint);
 	WaitSignals();
-	// we subtract 4 because the seq sent with every packet takes 4 bytes
-	m_packetSize = static_cast<uint32_t>((ParseBitrate(bitRate) / 8) / packetRate) - 4;
-	if (m_packetSize > 65507)
-		throw std::runtime_error("Packets would be too large with the given bitrate and packetrate");
-	m_timeBetweenSend = std::chrono::microseconds(1000000) / packetRate;
+	uint32_t minSize;
+	uint32_t maxSize;
+	const std::vector<uint32_t> sweepSizes = ParseSweep(config.sweep);
+	if (config.phases.empty() == false)
+	{
+		if (sweepSizes.empty() == false || config.sizes.empty() == false)
+			throw std::runtime_error("Phases can't be combined with a sweep or a payload size range");
+		m_phases = ParsePhases(config.phases, config.bitRate, config.packetRate, config.time, m_headerSize);
+		minSize = maxSize = m_phases.front().payloadSize;
+		SPDLOG_INFO("Running {} phases over one session", m_phases.size());
+	}
+	else if (sweepSizes.empty() == true)
+	{
+		if (config.sizes.empty() == true)
+		{
+			// the header sent with every packet counts towards the bitrate
+			m_packetSize = static_cast<uint32_t>((ParseBitrate(config.bitRate) / 8) / config.packetRate - m_headerSize);
+			if (m_packetSize > Detail::RandomPacket::MaxDatagramSize - m_headerSize)
+				throw std::runtime_error("Packets would be too large with the given bitrate and packetrate");
+			minSize = m_packetSize;
+		}
+		else
+		{
+			ParseSizeRange(config.sizes, minSize, m_packetSize);
+			SPDLOG_INFO("Drawing payload sizes from {} to {} bytes, ignoring the bitrate",
+				minSize, m_packetSize);
+		}
+		maxSize = m_packetSize;
+		m_phases.push_back(PhaseSpec{ m_packetSize, config.packetRate, config.time });
+	}
+	else
+	{
+		for (const uint32_t size : sweepSizes)
+			m_phases.push_back(PhaseSpec{ size, config.packetRate, config.time });
+		minSize = maxSize = m_phases.front().payloadSize;
+		SPDLOG_INFO("Sweeping {} payload sizes for {} seconds each, ignoring the bitrate",
+			m_phases.size(), m_time);
+	}
+	// the server sizes its receives for the largest phase, the socket
+	// buffers and the loss window are sized for the fastest
+	m_packetSize = 0;
+	uint32_t peakPacketRate = 0;
+	for (const PhaseSpec& phase : m_phases)
+	{
+		m_packetSize = std::max(m_packetSize, phase.payloadSize);
+		peakPacketRate = std::max(peakPacketRate, phase.packetRate);
+		m_bytesPerSecond = std::max<uint64_t>(m_bytesPerSecond, static_cast<uint64_t>(
+			phase.payloadSize + m_headerSize + Detail::UDPHeaderOverhead) * phase.packetRate);
+	}
+	if (peakPacketRate > config.packetRate)
+	{
+		m_ackTracker = Detail::AckTracker(std::max<size_t>(LossWindowMin,
+			static_cast<size_t>(peakPacketRate) * LossWindowSeconds),
+			(m_fields & Detail::FieldBit(Detail::Field::Timestamp)) != 0, 0);
+	}
+	m_timeBetweenSend = std::chrono::duration_cast<Clock_t::duration>(
+		Detail::TrafficModel::GetGap(m_phases.front().packetRate));
+	m_trafficModel = Detail::TrafficModel::Create(config.shape,
+		std::chrono::duration_cast<Detail::TrafficModel::Duration_t>(m_timeBetweenSend),
+		minSize, maxSize);
+	if (m_trafficModel->GetMaxPayloadSize() > maxSize)
+	{
+		if (m_phases.size() > 1)
+			throw std::runtime_error("A trace can't be combined with a sweep or phases");
+		// a trace brings its own sizes, so the server has to expect any of them
+		m_packetSize = m_phases.front().payloadSize = m_trafficModel->GetMaxPayloadSize();
+		m_bytesPerSecond = static_cast<uint64_t>(m_packetSize + m_headerSize +
+			Detail::UDPHeaderOverhead) * config.packetRate;
+	}
+	if (m_packetSize > Detail::RandomPacket::MaxDatagramSize - m_headerSize)
+	{
+		throw std::runtime_error("Payloads of " + std::to_string(m_packetSize) +
+			" bytes don't fit in a datagram behind a " + std::to_string(m_headerSize) + " byte header");
+	}
+	// the reflector has no handshake to time, so only the slack is counted
+	if (m_reflector == true)
+		m_bufferSize = SizeBuffer(m_bytesPerSecond, Clock_t::duration::zero());
+	if (m_integrity == true)
+	{
+		SPDLOG_INFO("Sealing packets with a CRC32C{}",
+			(Detail::IsCrc32cAccelerated() == true) ? "" : " (no hardware support)");
+	}
+	if (m_fields != Detail::BasePacketFields)
+		SPDLOG_INFO("Sending {} byte headers: {}", m_headerSize, Detail::DescribeFields(m_fields));
+	// every packet is laid out for the negotiated header
+	for (Detail::RandomPacket& packet : m_sendRing)
+		packet = Detail::RandomPacket(m_fields);
+	m_probePacket = Detail::RandomPacket(m_fields);
+	m_packetAck = Detail::PacketAck(Detail::GetAckFields(m_fields));
+	if (m_fresh == true)
+		SPDLOG_INFO("Sharing payload seed {:#010x} with the server", m_payloadSeed);
+	if (config.metrics.empty() == false && m_metrics == nullptr)
+	{
+		m_ownMetrics = std::make_unique<Detail::MetricsSegment>(config.metrics,
+			Detail::MetricsSegment::Role::Client);
+		m_metrics = m_ownMetrics.get();
+		SPDLOG_INFO("Publishing metrics to {}", config.metrics);
+	}
+	if (m_metrics != nullptr)
+		m_metricsSlot = m_metrics->AcquireSlot(m_target);
+	if (config.eventLog.empty() == false)
+	{
+		m_eventLog = std::make_unique<Detail::EventLog>(config.eventLog);
+		SPDLOG_INFO("Recording packet events to {}", config.eventLog);
+	}
+	if (config.soak.empty() == false)
+	{
+		m_soak = std::make_unique<Detail::SoakRecorder>(config.soak,
+			static_cast<size_t>(config.soakSize) * 1024 * 1024, config.soakFiles);
+		SPDLOG_INFO("Recording 1s, 1m and 1h windows to {}, rotating every {} MB and keeping {} files",
+			config.soak, config.soakSize, config.soakFiles);
+	}
 	SPDLOG_DEBUG("Specified packet size of {} bytes, sending every {} ms",
 		m_packetSize, static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(
 			m_timeBetweenSend).count()) / 1000.f);
@@ -44,7 +195,21 @@ Client::Client(const std::string& address, const std::string& port,
 void Client::Run()
 {
 	SPDLOG_INFO("Running client");
+	// the transport runs on this thread
+	m_cpuMeter.Start();
+	if (m_cpuMeter.GetHardwareError().empty() == false)
+		SPDLOG_WARN("Hardware counters unavailable: {}", m_cpuMeter.GetHardwareError());
+	m_reporter.Start();
+	if (m_eventLog != nullptr)
+		m_eventLog->Start();
 	m_worker.run();
+	m_reporter.Stop();
+	if (m_eventLog != nullptr)
+	{
+		m_eventLog->Stop();
+		SPDLOG_INFO("Recorded {} packet events, dropped {}",
+			m_eventLog->GetWritten(), m_eventLog->GetDropped());
+	}
 }
 
 void Client::Stop() noexcept
@@ -59,17 +224,26 @@ void Client::Stop() noexcept
 
 void Client::Connect(const TCPEndpoint_t& endpoint) noexcept
 {
+	m_connectStart = Clock_t::now();
 	m_controlSocket.async_connect(endpoint,
 		[this, endpoint](const ErrorCode_t& ec)
 		{
 			if (!ec)
 			{
-				SPDLOG_INFO("Connected to server {}:{}",
-					endpoint.address().to_string(),
-					endpoint.port());
-				m_request = Detail::Request(
-					Detail::Request::Command::Open,
-					m_packetSize);
+				// the handshake takes one round trip
+				const auto rtt = Clock_t::now() - m_connectStart;
+				m_connectTime = rtt;
+				m_bufferSize = SizeBuffer(m_bytesPerSecond, rtt);
+				SPDLOG_INFO("Connected to server {}:{} in {:.3f} ms, sizing socket buffers to {} bytes",
+					endpoint.address().to_string(), endpoint.port(),
+					std::chrono::duration_cast<std::chrono::microseconds>(rtt).count() / 1000.,
+					m_bufferSize);
+				uint8_t flags = 0;
+				if (m_fresh == true)
+					flags |= Detail::Request::Flags::FreshPayload;
+				m_request = Detail::Request(Detail::Request::Command::Open,
+					m_packetSize, flags, m_payloadSeed, m_bufferSize, m_fields);
+				m_handshakeStart = Clock_t::now();
 				WriteControl();
 			}
 			else if (ec != asio::error::operation_aborted)
@@ -91,14 +265,15 @@ void Client::WaitSignals() noexcept
 				return;
 			SPDLOG_DEBUG("Intercepted signo {}", signo);
 			PrintEndStats();
+			AccumulateTotals(Clock_t::now() - m_start);
 			Stop();
 		});
 }
 
 uint64_t Client::ParseBitrate(const std::string& bitrate)
 {
-	uint64_t coefficient;
-	auto res = std::from_chars(bitrate.data(), 
+	uint64_t coefficient = 0;
+	auto res = std::from_chars(bitrate.data(),
 		bitrate.data() + bitrate.size(), coefficient, 10);
 	if (res.ec == std::errc::invalid_argument)
 		throw std::runtime_error("Failed to parse bitrate");
@@ -120,6 +295,110 @@ uint64_t Client::ParseBitrate(const std::string& bitrate)
 	}
 }
 
+void Client::ParseSizeRange(const std::string& sizes, uint32_t& minSize, uint32_t& maxSize)
+{
+	const size_t colon = sizes.find(':');
+	const std::vector<uint32_t> bounds = ParseSweep((colon == std::string::npos) ?
+		sizes : sizes.substr(0, colon) + ',' + sizes.substr(colon + 1));
+	if (bounds.empty() == true || bounds.front() > bounds.back())
+		throw std::runtime_error("Invalid payload size range: " + sizes);
+	minSize = bounds.front();
+	maxSize = bounds.back();
+}
+
+std::vector<uint32_t> Client::ParseSweep(const std::string& sweep)
+{
+	const auto parseSize = [](const std::string& size)
+	{
+		uint32_t value = 0;
+		auto res = std::from_chars(size.data(), size.data() + size.size(), value, 10);
+		if (res.ec != std::errc() || res.ptr != size.data() + size.size())
+			throw std::runtime_error("Failed to parse sweep size: " + size);
+		if (value > Detail::RandomPacket::MaxPayloadSize)
+			throw std::runtime_error("Sweep size is too large for a datagram: " + size);
+		return value;
+	};
+	std::vector<uint32_t> sizes;
+	std::istringstream iss(sweep);
+	std::string entry;
+	while (std::getline(iss, entry, ','))
+	{
+		const size_t firstColon = entry.find(':');
+		if (firstColon == std::string::npos)
+		{
+			sizes.push_back(parseSize(entry));
+			continue;
+		}
+		const size_t secondColon = entry.find(':', firstColon + 1);
+		const uint32_t start = parseSize(entry.substr(0, firstColon));
+		const uint32_t end = parseSize(entry.substr(firstColon + 1,
+			(secondColon == std::string::npos) ? std::string::npos : secondColon - firstColon - 1));
+		const uint32_t step = (secondColon == std::string::npos) ?
+			1 : parseSize(entry.substr(secondColon + 1));
+		if (step == 0 || start > end)
+			throw std::runtime_error("Invalid sweep range: " + entry);
+		for (uint64_t size = start; size <= end; size += step)
+			sizes.push_back(static_cast<uint32_t>(size));
+	}
+	return sizes;
+}
+
+std::vector<Client::PhaseSpec> Client::ParsePhases(const std::string& phases,
+	const std::string& bitRate, uint32_t packetRate, uint32_t time, size_t headerSize)
+{
+	const auto parseNumber = [](const std::string& item, const std::string& value)
+	{
+		uint32_t number = 0;
+		auto res = std::from_chars(value.data(), value.data() + value.size(), number, 10);
+		if (res.ec != std::errc() || res.ptr != value.data() + value.size() || number == 0)
+			throw std::runtime_error("Expected a positive number in phase setting " + item);
+		return number;
+	};
+	std::vector<PhaseSpec> specs;
+	std::istringstream phaseStream(phases);
+	std::string entry;
+	while (std::getline(phaseStream, entry, ','))
+	{
+		uint64_t phaseBitRate = ParseBitrate(bitRate);
+		PhaseSpec spec{ 0, packetRate, time };
+		std::istringstream itemStream(entry);
+		std::string item;
+		while (std::getline(itemStream, item, '/'))
+		{
+			const size_t equals = item.find('=');
+			if (equals == std::string::npos)
+				throw std::runtime_error("Expected <setting>=<value> in phase " + entry);
+			const std::string name = item.substr(0, equals);
+			const std::string value = item.substr(equals + 1);
+			if (name == "bitrate")
+				phaseBitRate = ParseBitrate(value);
+			else if (name == "rate")
+				spec.packetRate = parseNumber(item, value);
+			else if (name == "size")
+				spec.payloadSize = parseNumber(item, value);
+			else if (name == "time")
+				spec.time = parseNumber(item, value);
+			else
+				throw std::runtime_error("Unknown phase setting: " + name);
+		}
+		// the header sent with every packet counts towards the bitrate
+		if (spec.payloadSize == 0)
+		{
+			const uint64_t packetBytes = phaseBitRate / 8 / spec.packetRate;
+			if (packetBytes <= headerSize)
+				throw std::runtime_error("Packets of phase " + entry + " would be smaller than their header");
+			spec.payloadSize = static_cast<uint32_t>(std::min<uint64_t>(packetBytes - headerSize,
+				Detail::RandomPacket::MaxDatagramSize));
+		}
+		if (spec.payloadSize > Detail::RandomPacket::MaxDatagramSize - headerSize)
+			throw std::runtime_error("Payloads of phase " + entry + " don't fit in a datagram");
+		specs.push_back(spec);
+	}
+	if (specs.empty() == true)
+		throw std::runtime_error("No phases in " + phases);
+	return specs;
+}
+
 void Client::ReadControl() noexcept
 {
 	asio::async_read(m_controlSocket, m_response.GetBuffers(),
@@ -140,30 +419,10 @@ void Client::ReadControl() noexcept
 							m_response.GetStatus());
 						return Stop();
 					}
-					// open local transport
-					ErrorCode_t ec;
-					if (m_transportSocket.open(UDPProto_t::v4(), ec), ec ||
-						m_transportSocket.bind(UDPProto_t::endpoint(UDPProto_t::v4(), 5602), ec), ec)
-					{
-						SPDLOG_ERROR("Failed to open local transport socket: {}",
-							ec.message());
-						return Stop();
-					}
-					m_transportEndpoint = m_response.GetEndpoint();
+					m_handshakeTime = Clock_t::now() - m_handshakeStart;
 					SPDLOG_DEBUG("Server opened transport socket on {}:{}. Beginning sequence",
-						m_transportEndpoint.address().to_string(), m_transportEndpoint.port());
-					// send the first packet
-					++m_pending;
-					ProcessTransportQueue();
-					// set the timers
-					m_printTimer.expires_at(std::chrono::steady_clock::now());
-					m_sendTimer.expires_at(std::chrono::high_resolution_clock::now());
-					m_start = std::chrono::high_resolution_clock::now();
-					ReadTransport();
-					AwaitNextSend();
-					AwaitPrint();
-					AwaitFinish();
-					SPDLOG_INFO("Started transport");
+						m_response.GetEndpoint().address().to_string(), m_response.GetEndpoint().port());
+					OpenTransportLayer(m_response.GetEndpoint());
 					break;
 				}
 				case Detail::Request::Close:
@@ -176,6 +435,19 @@ void Client::ReadControl() noexcept
 					}
 					return Stop();
 				}
+				case Detail::Request::Stats:
+					return HandleServerStats();
+				case Detail::Request::Phase:
+				{
+					if (m_response.GetStatus() !=
+						Detail::Response::Status::OK)
+					{
+						SPDLOG_ERROR("Server rejected phase {}: {}",
+							m_phaseIndex + 1, m_response.GetStatus());
+						return Stop();
+					}
+					return StartPhase();
+				}
 				}
 			}
 			else if (ec != asio::error::operation_aborted)
@@ -187,6 +459,57 @@ void Client::ReadControl() noexcept
 		});
 }
 
+void Client::OpenTransportLayer(const UDPProto_t::endpoint& endpoint) noexcept
+{
+	m_setupStart = Clock_t::now();
+	// open local transport on a port of its own, so neither back-to-back
+	// runs nor the targets of a fan-out race for one
+	ErrorCode_t ec;
+	if (m_transportSocket.open(UDPProto_t::v4(), ec), ec ||
+		m_transportSocket.bind(UDPProto_t::endpoint(UDPProto_t::v4(), 0), ec), ec)
+	{
+		SPDLOG_ERROR("Failed to open local transport socket: {}",
+			ec.message());
+		return Stop();
+	}
+	const uint32_t granted = Detail::SetBufferSizes(m_transportSocket, m_bufferSize, ec);
+	if (ec)
+		SPDLOG_WARN("Failed to size socket buffers: {}", ec.message());
+	else if (granted < m_bufferSize)
+	{
+		SPDLOG_WARN("Asked for {} byte socket buffers but got {}, raise net.core.rmem_max and wmem_max",
+			m_bufferSize, granted);
+	}
+	if (m_tos != 0 || m_priority != 0)
+	{
+		if (Detail::SetTos(m_transportSocket, m_tos, ec), ec)
+			SPDLOG_WARN("Failed to mark packets with TOS {:#04x}: {}", m_tos, ec.message());
+		if (m_priority != 0 && (Detail::SetPriority(m_transportSocket, m_priority, ec), ec))
+			SPDLOG_WARN("Failed to send packets at priority {}: {}", m_priority, ec.message());
+		SPDLOG_INFO("Marking packets with DSCP {} at priority {}", m_tos >> 2, m_priority);
+	}
+	m_transportEndpoint = endpoint;
+	ReadTransport();
+	// connecting lets the kernel track the path MTU to the server
+	if (m_transportSocket.connect(m_transportEndpoint, ec), ec)
+	{
+		SPDLOG_WARN("Failed to connect transport socket: {}",
+			ec.message());
+	}
+	if (m_phases.size() > 1)
+		return DiscoverPathMtu();
+	// without a sweep, settle for what the kernel already knows
+	const uint32_t pathMtu = Detail::GetPathMtu(m_transportSocket, ec);
+	if (!ec)
+		m_pathMtu = pathMtu;
+	if (IsFragmented(m_packetSize) == true)
+	{
+		SPDLOG_WARN("Datagrams of {} bytes are larger than the path MTU of {} and will fragment",
+			m_packetSize + m_headerSize, m_pathMtu);
+	}
+	BeginPhase();
+}
+
 void Client::WriteControl() noexcept
 {
 	asio::async_write(m_controlSocket, m_request.GetBuffers(),
@@ -194,7 +517,7 @@ void Client::WriteControl() noexcept
 		{
 			if (!ec)
 			{
-				SPDLOG_DEBUG("Sent request with cmd {}", 
+				SPDLOG_DEBUG("Sent request with cmd {}",
 					m_request.GetCommand());
 				ReadControl();
 			}
@@ -210,29 +533,62 @@ void Client::WriteControl() noexcept
 void Client::ReadTransport() noexcept
 {
 	m_transportSocket.async_receive_from(m_packetAck.GetBuffers(),
-		m_transportEndpoint, [this](const ErrorCode_t& ec, size_t)
+		m_transportEndpoint, [this](const ErrorCode_t& ec, size_t bytes)
 		{
 			if (!ec)
 			{
-				SPDLOG_TRACE("Received ack for seq {}",
+				UDPTEST_PACKET_DEBUG("Received ack for seq {}",
 					m_packetAck.GetSeq());
-				const auto seqIt = m_sendTimes.find(m_packetAck.GetSeq());
-				if (seqIt != m_sendTimes.end())
+				if (bytes < m_packetAck.GetSize() ||
+					m_packetAck.GetHeader().Get<Detail::Field::StreamId>() != m_streamId)
+				{
+					UDPTEST_PACKET_DEBUG("Dropped a runt or another stream's ack");
+					return ReadTransport();
+				}
+				if (m_packetAck.GetSeq() >= Detail::RandomPacket::ProbeSeqBase)
+				{
+					HandleProbeAck(m_packetAck.GetSeq() -
+						Detail::RandomPacket::ProbeSeqBase);
+					return ReadTransport();
+				}
+				const bool corrupt = (m_packetAck.GetFlags() & Detail::PacketAck::Flags::Corrupt) != 0;
+				if (corrupt == true && m_eventLog != nullptr)
 				{
-					const auto recvTime = 
-						std::chrono::high_resolution_clock::now() - seqIt->second;
-					if (recvTime > m_maxRecvTime)
-						m_maxRecvTime = recvTime;
-					m_totalRecvTime += recvTime;
-					if (recvTime > m_maxRecvTimeSinceLastCheck)
-						m_maxRecvTimeSinceLastCheck = recvTime;
-					m_recvTimeSinceLastCheck += recvTime;
-					m_sendTimes.erase(seqIt);
+					m_eventLog->Record(Detail::EventType::AckCorrupt,
+						m_packetAck.GetSeq(), static_cast<uint32_t>(bytes));
+				}
+				const Detail::AckTracker::Ack ack = m_ackTracker.OnAck(m_packetAck.GetSeq(), corrupt,
+					m_packetAck.GetHeader().Get<Detail::Field::Timestamp>(),
+					GetNow());
+				switch (ack.outcome)
+				{
+				case Detail::AckTracker::Outcome::Received:
+				{
+					m_interval.totalLatency += std::chrono::duration_cast<Clock_t::duration>(ack.latency);
+					const auto recvNs = static_cast<uint64_t>(ack.latency.count());
+					m_interval.latency.Record(recvNs);
+					if (m_eventLog != nullptr)
+					{
+						m_eventLog->Record(Detail::EventType::AckReceived,
+							m_packetAck.GetSeq(), static_cast<uint32_t>(bytes), recvNs);
+					}
+					++m_interval.packetsReceived;
+					break;
+				}
+				case Detail::AckTracker::Outcome::Late:
+					UDPTEST_PACKET_DEBUG("Ack of seq {} arrived after it was counted lost", ack.seq);
+					break;
+				case Detail::AckTracker::Outcome::Unsent:
+					SPDLOG_WARN("Ack of unsent seq: {}", ack.seq);
+					break;
+				case Detail::AckTracker::Outcome::Corrupt:
+					++m_interval.packetsCorrupted;
+					break;
+				case Detail::AckTracker::Outcome::Duplicate:
+				// stragglers from an earlier phase are expected
+				case Detail::AckTracker::Outcome::Straggler:
+					break;
 				}
-				else
-					SPDLOG_WARN("Untracked seq: {}",
-						m_packetAck.GetSeq());
-				++m_ack;
 				if (m_transportSocket.is_open() == true)
 					ReadTransport();
 			}
@@ -245,21 +601,44 @@ void Client::ReadTransport() noexcept
 		});
 }
 
-void Client::WriteTransport() noexcept
+void Client::WriteTransport(std::chrono::nanoseconds now, uint32_t payloadSize) noexcept
 {
-	m_transportSocket.async_send_to(m_randomPacket.GetBuffers(),
-		m_transportEndpoint, [this](const ErrorCode_t& ec, size_t bytes)
+	const size_t slot = m_sendHead;
+	m_sendHead = (m_sendHead + 1) % m_sendRing.size();
+	++m_inFlight;
+	Detail::RandomPacket& packet = m_sendRing[slot];
+	// refilled in place, the slot keeps its buffer from earlier sends
+	packet.Fill(Detail::RandomPacket::ToWireSeq(m_ackTracker.GetNextSeq()), payloadSize, m_payloadSeed);
+	const Detail::HeaderView<uint8_t> header = packet.GetHeader();
+	header.Set<Detail::Field::Timestamp>(static_cast<uint64_t>(now.count()));
+	header.Set<Detail::Field::StreamId>(m_streamId);
+	if (m_integrity == true)
+		packet.Seal();
+	m_interval.packetsLost += static_cast<uint32_t>(m_ackTracker.OnSend(now));
+	m_transportSocket.async_send_to(packet.GetBuffers(),
+		m_transportEndpoint, [this, slot](const ErrorCode_t& ec, size_t bytes)
 		{
+			--m_inFlight;
 			if (!ec)
 			{
-				SPDLOG_TRACE("Wrote random packet with seq {}",
-					m_randomPacket.GetSeq());
-				m_sendTimes.emplace(m_randomPacket.GetSeq(), std::chrono::high_resolution_clock::now());
-				m_bytesSinceLastCheck += bytes;
+				UDPTEST_PACKET_DEBUG("Wrote random packet with seq {}",
+					m_sendRing[slot].GetSeq());
+				if (m_eventLog != nullptr)
+				{
+					m_eventLog->Record(Detail::EventType::PacketSent,
+						m_sendRing[slot].GetSeq(), static_cast<uint32_t>(bytes));
+				}
+				m_interval.bytesSent += bytes;
 				m_totalBytes += bytes;
-				++m_packetsSinceLastCheck;
-				if (m_transportSocket.is_open() == true &&
-					m_pending != 0)
+				++m_interval.packetsSent;
+				if (m_transportSocket.is_open() == true)
+					ProcessTransportQueue();
+			}
+			else if (ec == asio::error::no_buffer_space)
+			{
+				// the kernel had no room for the datagram, so it never left
+				++m_sendDropped;
+				if (m_transportSocket.is_open() == true)
 					ProcessTransportQueue();
 			}
 			else if (ec != asio::error::operation_aborted)
@@ -278,89 +657,666 @@ void Client::CloseTransportLayer() noexcept
 	m_sendTimer.cancel(ignored);
 	m_endTimer.cancel(ignored);
 	m_printTimer.cancel(ignored);
+	m_probeTimer.cancel(ignored);
+}
+
+void Client::ProcessSendSlot() noexcept
+{
+	const auto send = [this](std::chrono::nanoseconds now, uint32_t payloadSize)
+	{
+		WriteTransport(now, payloadSize);
+	};
+	if (m_pacer.OnDue(GetNow(), m_inFlight < m_sendRing.size(), send) == true)
+		AwaitNextSend();
 }
 
 void Client::ProcessTransportQueue() noexcept
 {
-	--m_pending;
-	m_randomPacket = Detail::RandomPacket(m_seq++, m_packetSize);
-	WriteTransport();
+	const auto hasRoom = [this]() { return m_inFlight < m_sendRing.size(); };
+	const auto send = [this](std::chrono::nanoseconds now, uint32_t payloadSize)
+	{
+		WriteTransport(now, payloadSize);
+	};
+	if (m_pacer.OnSendDone(GetNow(), hasRoom, send) == true)
+		AwaitNextSend();
+}
+
+void Client::DiscoverPathMtu() noexcept
+{
+	ErrorCode_t ec;
+	// probe with DF set so oversized datagrams are dropped, not fragmented
+	if (Detail::SetDontFragment(m_transportSocket, true, ec), ec)
+	{
+		SPDLOG_WARN("Path MTU discovery is unavailable: {}", ec.message());
+		return BeginPhase();
+	}
+	const uint32_t interfaceMtu = Detail::GetPathMtu(m_transportSocket, ec);
+	// every IPv4 path carries at least 68 bytes
+	m_probeLow = 68 - Detail::UDPHeaderOverhead;
+	m_probeHigh = static_cast<uint32_t>(m_packetSize + m_headerSize);
+	if (!ec)
+		m_probeHigh = std::min(m_probeHigh, interfaceMtu - Detail::UDPHeaderOverhead);
+	m_probeHigh = std::max(m_probeHigh, m_probeLow);
+	SPDLOG_INFO("Discovering path MTU up to {} bytes",
+		m_probeHigh + Detail::UDPHeaderOverhead);
+	// try the largest size first, most paths carry it
+	m_probeTries = 0;
+	SendProbe(m_probeHigh);
+}
+
+void Client::ProbePathMtu() noexcept
+{
+	if (m_probeLow >= m_probeHigh)
+	{
+		m_pathMtu = m_probeLow + Detail::UDPHeaderOverhead;
+		SPDLOG_INFO("Path MTU is {} bytes", m_pathMtu);
+		// the sweep deliberately sends sizes that have to fragment
+		ErrorCode_t ec;
+		Detail::SetDontFragment(m_transportSocket, false, ec);
+		return BeginPhase();
+	}
+	m_probeTries = 0;
+	SendProbe(m_probeLow + (m_probeHigh - m_probeLow + 1) / 2);
+}
+
+void Client::SendProbe(uint32_t udpSize) noexcept
+{
+	m_probeSize = udpSize;
+	m_probePacket.Fill(Detail::RandomPacket::ProbeSeqBase + udpSize,
+		static_cast<uint32_t>(udpSize - m_headerSize), m_payloadSeed);
+	m_probePacket.GetHeader().Set<Detail::Field::Flags>(Detail::RandomPacket::Flags::Probe);
+	m_probePacket.GetHeader().Set<Detail::Field::StreamId>(m_streamId);
+	if (m_integrity == true)
+		m_probePacket.Seal();
+	m_transportSocket.async_send_to(m_probePacket.GetBuffers(),
+		m_transportEndpoint, [this, udpSize](const ErrorCode_t& ec, size_t)
+		{
+			if (ec == asio::error::operation_aborted)
+				return;
+			// the kernel refuses sends larger than a path MTU it already knows
+			if (ec)
+				return HandleProbeFailure(udpSize);
+			m_probeTimer.expires_after(std::chrono::milliseconds(250));
+			m_probeTimer.async_wait([this, udpSize](const ErrorCode_t& ec)
+				{
+					if (ec)
+						return;
+					HandleProbeFailure(udpSize);
+				});
+		});
+}
+
+void Client::HandleProbeAck(uint32_t udpSize) noexcept
+{
+	// ignore acks for probes we already gave up on
+	if (udpSize <= m_probeLow || udpSize > m_probeHigh)
+		return;
+	ErrorCode_t ignored;
+	m_probeTimer.cancel(ignored);
+	SPDLOG_DEBUG("Probe of {} bytes got through", udpSize);
+	m_probeLow = udpSize;
+	ProbePathMtu();
+}
+
+void Client::HandleProbeFailure(uint32_t udpSize) noexcept
+{
+	// the probe may have been answered in the meantime
+	if (udpSize != m_probeSize || udpSize <= m_probeLow)
+		return;
+	// give each size a second chance in case of ordinary loss
+	if (++m_probeTries < 2)
+		return SendProbe(udpSize);
+	SPDLOG_DEBUG("Probe of {} bytes did not get through", udpSize);
+	m_probeHigh = udpSize - 1;
+	// an ICMP fragmentation needed may have taught the kernel a tighter bound
+	ErrorCode_t ec;
+	const uint32_t pathMtu = Detail::GetPathMtu(m_transportSocket, ec);
+	if (!ec && pathMtu > Detail::UDPHeaderOverhead)
+		m_probeHigh = std::min(m_probeHigh, pathMtu - Detail::UDPHeaderOverhead);
+	if (m_probeHigh < m_probeLow)
+		m_probeHigh = m_probeLow;
+	ProbePathMtu();
+}
+
+bool Client::IsFragmented(uint32_t payloadSize) const noexcept
+{
+	return m_pathMtu != 0 &&
+		payloadSize + m_headerSize + Detail::UDPHeaderOverhead > m_pathMtu;
+}
+
+void Client::BeginPhase() noexcept
+{
+	if (m_warmingUp == true || m_reflector == true)
+		return StartPhase();
+	const PhaseSpec& phase = m_phases[m_phaseIndex];
+	m_request = Detail::Request::MakePhase(phase.payloadSize, phase.packetRate,
+		phase.time, m_tos, m_priority);
+	WriteControl();
+}
+
+void Client::StartPhase() noexcept
+{
+	const auto now = Clock_t::now();
+	if (m_setupStart != Clock_t::time_point())
+	{
+		m_setupTime = now - m_setupStart;
+		m_setupStart = Clock_t::time_point();
+	}
+	else if (m_phaseEnd != Clock_t::time_point())
+	{
+		m_phaseChangeTime += now - m_phaseEnd;
+		++m_phaseChanges;
+		m_phaseEnd = Clock_t::time_point();
+	}
+	const PhaseSpec& phase = m_phases[m_phaseIndex];
+	if (m_phases.size() > 1)
+	{
+		m_packetSize = phase.payloadSize;
+		m_trafficModel->SetPayloadSizes(m_packetSize, m_packetSize);
+	}
+	m_time = phase.time;
+	m_timeBetweenSend = std::chrono::duration_cast<Clock_t::duration>(
+		Detail::TrafficModel::GetGap(phase.packetRate));
+	m_trafficModel->SetGap(std::chrono::duration_cast<Detail::TrafficModel::Duration_t>(m_timeBetweenSend));
+	if (m_warmingUp == true)
+		SPDLOG_INFO("Warming up for {} ms", m_warmup.count());
+	else if (m_phases.size() > 1 && m_repeatIndex == 0)
+	{
+		SPDLOG_INFO("Starting phase {}/{} with payloads of {} bytes{} at {} packets/s for {} s",
+			m_phaseIndex + 1, m_phases.size(), m_packetSize,
+			IsFragmented(m_packetSize) ? " (fragmented)" : "", phase.packetRate, m_time);
+	}
+	if (m_warmingUp == false && m_repeat > 1)
+		SPDLOG_INFO("Starting run {}/{}", m_repeatIndex + 1, m_repeat);
+	// every run replays the same traffic
+	m_trafficModel->Rewind();
+	// every counter is per phase
+	m_totalBytes = 0;
+	m_latency.Reset();
+	m_interval.Reset();
+	SampleKernelCounters();
+	m_phaseCpu = m_cpuMeter.Read();
+	// set the timers and send the first packet right away
+	m_printTimer.expires_at(std::chrono::steady_clock::now());
+	m_start = std::chrono::high_resolution_clock::now();
+	const auto start = std::chrono::duration_cast<std::chrono::nanoseconds>(m_start.time_since_epoch());
+	m_ackTracker.BeginPhase(start);
+	AwaitPrint();
+	AwaitFinish();
+	if (m_pacer.Begin(*m_trafficModel, start,
+		std::chrono::duration_cast<Detail::SendPacer::Duration_t>(m_timeBetweenSend)) == false)
+	{
+		SPDLOG_WARN("Traffic model has no packets");
+		return EndPhase();
+	}
+	ProcessSendSlot();
+	SPDLOG_INFO("Started transport");
+}
+
+void Client::EndPhase() noexcept
+{
+	if (m_warmingUp == true)
+		return EndWarmup();
+	m_phaseEnd = Clock_t::now();
+	ErrorCode_t ignored;
+	m_sendTimer.cancel(ignored);
+	m_printTimer.cancel(ignored);
+	// give the last acks of the phase a chance to come back
+	m_endTimer.expires_after(std::chrono::milliseconds(250));
+	m_endTimer.async_wait([this](const ErrorCode_t& ec)
+		{
+			if (ec)
+				return;
+			DiffKernelCounters();
+			if (m_reflector == true)
+				return FinishPhase();
+			RequestServerStats();
+		});
+}
+
+void Client::FinishPhase() noexcept
+{
+	m_latency.Merge(m_interval.latency);
+	m_interval.Reset();
+	PrintEndStats();
+	AccumulateTotals(std::chrono::seconds(m_time));
+	const uint64_t acked = m_ackTracker.GetAcked();
+	m_phaseResults.push_back(PhaseResult{ m_packetSize,
+		m_phases[m_phaseIndex].packetRate, m_time, IsFragmented(m_packetSize), m_ackTracker.GetSent(),
+		acked, m_ackTracker.GetCorrupted(), m_ackTracker.GetLossTracker().GetLost(), m_totalBytes,
+		(acked != 0) ? std::chrono::duration_cast<Clock_t::duration>(m_ackTracker.GetTotalLatency() / acked) :
+			Clock_t::duration{},
+		std::chrono::duration_cast<Clock_t::duration>(m_ackTracker.GetMaxLatency()),
+		m_latency.GetPercentile(50), m_latency.GetPercentile(99) });
+	if (++m_repeatIndex < m_repeat)
+		return BeginPhase();
+	m_repeatIndex = 0;
+	if (++m_phaseIndex < m_phases.size())
+		return BeginPhase();
+	if (m_phases.size() > 1)
+		PrintSweepStats();
+	if (m_repeat > 1)
+		PrintRepeatStats();
+	PrintSessionStats();
+	CloseTransportLayer();
+	if (m_reflector == true)
+		return Stop();
+	m_request = Detail::Request(
+		Detail::Request::Command::Close, 0);
+	WriteControl();
+}
+
+void Client::EndWarmup() noexcept
+{
+	ErrorCode_t ignored;
+	m_sendTimer.cancel(ignored);
+	m_printTimer.cancel(ignored);
+	m_endTimer.cancel(ignored);
+	// acks still on their way are stragglers once the first phase starts
+	FinalizeLoss();
+	SPDLOG_INFO("Warmed up with {} packets, {} acked", m_ackTracker.GetSent(), m_ackTracker.GetAcked());
+	if (m_reflector == true)
+	{
+		m_warmingUp = false;
+		return BeginPhase();
+	}
+	// the server's drops so far belong to the warm-up
+	RequestServerStats();
+}
+
+void Client::RequestServerStats() noexcept
+{
+	m_request = Detail::Request(Detail::Request::Command::Stats, 0);
+	WriteControl();
+}
+
+void Client::HandleServerStats() noexcept
+{
+	if (m_response.GetStatus() != Detail::Response::Status::OK)
+		SPDLOG_WARN("Server failed to report stats: {}", m_response.GetStatus());
+	// the counter only grows while the transport socket is open
+	m_phaseServerDrops = m_response.GetDrops() - m_serverDrops;
+	m_serverDrops = m_response.GetDrops();
+	if (m_warmingUp == true)
+	{
+		m_warmingUp = false;
+		return BeginPhase();
+	}
+	m_dropsSampled = true;
+	FinishPhase();
+}
+
+void Client::SampleKernelCounters() noexcept
+{
+	ErrorCode_t ec;
+	m_clientDrops = Detail::GetSocketDrops(m_transportSocket, ec);
+	m_udpCounters = Detail::GetUdpCounters(ec);
+	m_phaseServerDrops = 0;
+	m_phaseClientDrops = 0;
+	m_phaseUdpCounters = Detail::UdpCounters();
+	m_dropsSampled = false;
+	m_sendDropped = 0;
+}
+
+void Client::DiffKernelCounters() noexcept
+{
+	ErrorCode_t ec;
+	const uint64_t clientDrops = Detail::GetSocketDrops(m_transportSocket, ec);
+	if (!ec)
+		m_phaseClientDrops = clientDrops - m_clientDrops;
+	const Detail::UdpCounters udpCounters = Detail::GetUdpCounters(ec);
+	if (!ec)
+		m_phaseUdpCounters = udpCounters - m_udpCounters;
+	// without a control connection only the local side is known
+	m_dropsSampled = m_reflector;
+}
+
+uint32_t Client::SizeBuffer(uint64_t bytesPerSecond, Clock_t::duration rtt) noexcept
+{
+	const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(rtt + BufferSlack);
+	const uint64_t size = 2 * bytesPerSecond * static_cast<uint64_t>(delay.count()) / 1000000;
+	return static_cast<uint32_t>(std::clamp<uint64_t>(size, MinBufferSize, MaxBufferSize));
 }
 
 void Client::AwaitFinish() noexcept
 {
-	m_endTimer.expires_after(std::chrono::seconds(m_time));
+	if (m_warmingUp == true)
+		m_endTimer.expires_after(m_warmup);
+	else
+		m_endTimer.expires_after(std::chrono::seconds(m_time));
 	m_endTimer.async_wait([this](const ErrorCode_t& ec)
 		{
 			if (ec)
 				return;
 			SPDLOG_DEBUG("Finished");
-			--m_seq;
-			CloseTransportLayer();
-			PrintEndStats();
-			ErrorCode_t ignored;
-			// cancel any outgoing packets
-			m_request = Detail::Request(
-				Detail::Request::Command::Close, 0);
-			WriteControl();
+			EndPhase();
 		});
 }
 
 void Client::AwaitPrint() noexcept
 {
-	m_printTimer.expires_at(m_printTimer.expiry() + std::chrono::milliseconds(200));
+	m_printTimer.expires_at(m_printTimer.expiry() + PrintInterval);
 	m_printTimer.async_wait([this](const ErrorCode_t& ec)
 		{
 			if (ec)
 				return;
 			AwaitPrint();
-			SPDLOG_INFO("-------- Info --------");
-			SPDLOG_INFO("Bits sent: {}\tPackets sent: {}",
-				BitsToString(m_bytesSinceLastCheck * 8), m_packetsSinceLastCheck);
-			SPDLOG_INFO("Average latency: {} ms\tMax latency: {} ms",
-				(m_packetsSinceLastCheck != 0) ? std::chrono::duration_cast<std::chrono::microseconds>(
-					m_recvTimeSinceLastCheck / m_packetsSinceLastCheck).count() / 1000.f : 0,
-				std::chrono::duration_cast<std::chrono::microseconds>(
-					m_maxRecvTimeSinceLastCheck).count() / 1000.f);
-			m_bytesSinceLastCheck = 0;
-			m_packetsSinceLastCheck = 0;
-			m_recvTimeSinceLastCheck = {};
-			m_maxRecvTimeSinceLastCheck = {};
+			// formatting happens on the reporter thread, only copy here
+			m_interval.phaseSent = m_ackTracker.GetSent();
+			m_interval.phaseReceived = m_ackTracker.GetAcked();
+			m_interval.phaseCorrupted = m_ackTracker.GetCorrupted();
+			const Detail::CpuMeter::Usage usage = m_cpuMeter.Read();
+			m_interval.cpuNs = usage.GetCpuNs();
+			m_interval.contextSwitches = usage.voluntarySwitches + usage.involuntarySwitches;
+			m_latency.Merge(m_interval.latency);
+			m_interval.jitter = std::chrono::duration_cast<Clock_t::duration>(m_ackTracker.GetJitter());
+			m_interval.target = m_targetIndex;
+			m_interval.warmup = m_warmingUp;
+			m_reporter.Publish(m_interval);
+			m_interval.Reset();
 		});
 }
 
+void Client::ReportInterval(const IntervalStats& stats) noexcept
+{
+	// the targets of a fan-out share the output, so each is named
+	PrintIntervalStats((m_ownReporter != nullptr) ? std::string("Info") : m_target, stats);
+	if (stats.warmup == true)
+		return;
+	PublishIntervalStats(stats);
+	RecordSoak(stats);
+}
+
+void Client::PrintIntervalStats(const std::string& title, const IntervalStats& stats) noexcept
+{
+	const auto toMs = [](uint64_t ns) { return static_cast<float>(ns / 1000) / 1000.f; };
+	SPDLOG_INFO("-------- {} --------", title);
+	SPDLOG_INFO("Bits sent: {}\tPackets sent: {}\tPackets received: {}",
+		BitsToString(stats.bytesSent * 8), stats.packetsSent, stats.packetsReceived);
+	SPDLOG_INFO("Average latency: {} ms\tP50: {} ms\tP99: {} ms\tMax latency: {} ms\tJitter: {} ms",
+		(stats.packetsReceived != 0) ? std::chrono::duration_cast<std::chrono::microseconds>(
+			stats.totalLatency / stats.packetsReceived).count() / 1000.f : 0,
+		toMs(stats.latency.GetPercentile(50)), toMs(stats.latency.GetPercentile(99)),
+		toMs(stats.latency.GetMax()), std::chrono::duration_cast<std::chrono::microseconds>(
+			stats.jitter).count() / 1000.f);
+}
+
+void Client::PublishIntervalStats(const IntervalStats& stats) noexcept
+{
+	using Counter = Detail::MetricsSegment::Counter;
+	if (m_metrics == nullptr ||
+		m_metricsSlot == Detail::MetricsSegment::SlotCount)
+		return;
+	constexpr auto intervalsPerSecond = std::chrono::milliseconds(1000) / PrintInterval;
+	m_metricsCounters[Counter::PacketsPerSecond] = stats.packetsSent * intervalsPerSecond;
+	m_metricsCounters[Counter::BytesPerSecond] = stats.bytesSent * intervalsPerSecond;
+	m_metricsCounters[Counter::PacketsTotal] += stats.packetsSent;
+	m_metricsCounters[Counter::BytesTotal] += stats.bytesSent;
+	// packets still in flight count as lost until their ack shows up
+	m_metricsCounters[Counter::LostTotal] = stats.phaseSent - stats.phaseReceived - stats.phaseCorrupted;
+	m_metricsCounters[Counter::CorruptedTotal] = stats.phaseCorrupted;
+	m_metricsCounters[Counter::CpuTimeNs] = stats.cpuNs;
+	m_metricsCounters[Counter::ContextSwitches] = stats.contextSwitches;
+	m_metricsCounters[Counter::LatencyCount] += stats.latency.GetCount();
+	m_metricsCounters[Counter::LatencySumNs] += static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(stats.totalLatency).count());
+	m_metricsCounters[Counter::LatencyMaxNs] = std::max(
+		m_metricsCounters[Counter::LatencyMaxNs], stats.latency.GetMax());
+	m_metricsLatency.Merge(stats.latency);
+	m_metrics->WriteSlot(m_metricsSlot, m_metricsCounters, m_metricsLatency);
+}
+
+void Client::RecordSoak(const IntervalStats& stats) noexcept
+{
+	if (m_soak == nullptr)
+		return;
+	m_soakSecond.sent += stats.packetsSent;
+	m_soakSecond.received += stats.packetsReceived;
+	m_soakSecond.lost += stats.packetsLost;
+	m_soakSecond.corrupted += stats.packetsCorrupted;
+	m_soakSecond.bytes += stats.bytesSent;
+	m_soakSecond.latency.Merge(stats.latency);
+	// the print timer never drifts, so counting intervals keeps the time
+	constexpr auto intervalsPerSecond = std::chrono::milliseconds(1000) / PrintInterval;
+	if (++m_soakIntervals % intervalsPerSecond != 0)
+		return;
+	m_soak->AddSecond(m_soakSecond);
+	m_soakSecond.Reset();
+}
+
 void Client::AwaitNextSend() noexcept
 {
-	m_sendTimer.expires_at(m_sendTimer.expiry() + m_timeBetweenSend);
+	if (m_pacer.Advance() == false)
+	{
+		SPDLOG_INFO("Traffic model ran out of packets");
+		return EndPhase();
+	}
+	m_sendTimer.expires_at(Clock_t::time_point(
+		std::chrono::duration_cast<Clock_t::duration>(m_pacer.GetDue())));
 	m_sendTimer.async_wait([this](const ErrorCode_t& ec)
 		{
 			if (ec)
 				return;
-			AwaitNextSend();
-			bool sendInProgress = (m_pending != 0);
-			++m_pending;
-			if (sendInProgress == false)
-				ProcessTransportQueue();
+			ProcessSendSlot();
 		});
 }
 
+void Client::FinalizeLoss() noexcept
+{
+	m_interval.packetsLost += static_cast<uint32_t>(m_ackTracker.FinalizeLoss());
+}
+
 void Client::PrintEndStats() noexcept
 {
-	SPDLOG_INFO("End stats:");
+	// whatever is still in flight now counts as lost
+	FinalizeLoss();
+	m_ackTracker.Close();
+	const uint64_t sent = m_ackTracker.GetSent();
+	const uint64_t acked = m_ackTracker.GetAcked();
+	const uint64_t corrupted = m_ackTracker.GetCorrupted();
+	const uint64_t unsent = m_pacer.GetBacklog();
+	if (m_ownReporter != nullptr)
+		SPDLOG_INFO("End stats:");
+	else
+		SPDLOG_INFO("End stats of {}:", m_target);
 	SPDLOG_INFO("Total packets sent: {}\tTotal packets received: {}",
-		m_seq, m_ack);
+		sent, acked);
 	SPDLOG_INFO("Sent per second: {}\tReceived per second: {}",
-		m_seq / m_time, m_ack / m_time);
+		sent / m_time, acked / m_time);
+	const uint64_t lost = m_ackTracker.GetLossTracker().GetLost();
 	SPDLOG_INFO("Packets lost: {} ({:.3f}%)\tPackets unsent: {} ({:.3f}%)",
-		m_seq - m_ack, (static_cast<float>(m_seq - m_ack) / m_seq) * 100,
-		m_pending, static_cast<float>(m_pending) / (m_pending + m_seq) * 100);
+		lost, (sent != 0) ? static_cast<float>(lost) / sent * 100 : 0.f,
+		unsent, (unsent + sent != 0) ? static_cast<float>(unsent) / (unsent + sent) * 100 : 0.f);
+	if (m_dropsSampled == true)
+		PrintLossAttribution(lost);
+	if (m_integrity == true || m_fresh == true)
+	{
+		SPDLOG_INFO("Packets corrupted: {} ({:.3f}%)",
+			corrupted, (sent != 0) ? static_cast<float>(corrupted) / sent * 100 : 0.f);
+	}
+	const uint64_t reordered = m_ackTracker.GetReordered();
+	if (reordered != 0 || m_ackTracker.GetDuplicates() != 0)
+	{
+		SPDLOG_INFO("Acks reordered: {} ({:.3f}%)\tMax displacement: {}\tDuplicate acks: {}",
+			reordered, (acked != 0) ? static_cast<float>(reordered) / acked * 100 : 0.f,
+			m_ackTracker.GetMaxDisplacement(), m_ackTracker.GetDuplicates());
+	}
+	if (m_ackTracker.GetLateAcks() != 0)
+		SPDLOG_INFO("Acks after their packet was counted lost: {}", m_ackTracker.GetLateAcks());
+	const uint64_t late = m_pacer.GetLate();
+	const uint64_t skipped = m_pacer.GetSkipped();
+	SPDLOG_INFO("Packets sent late: {} ({:.3f}%)\tSlots skipped: {} ({:.3f}%)",
+		late, (sent != 0) ? static_cast<float>(late) / sent * 100 : 0.f,
+		skipped, (skipped + sent != 0) ? static_cast<float>(skipped) / (skipped + sent) * 100 : 0.f);
 	SPDLOG_INFO("Total bits sent: {}\tEnding bitrate: {}",
 		BitsToString(m_totalBytes * 8), BitsToString(m_totalBytes / m_time * 8));
 	SPDLOG_INFO("Average latency: {} ms\tMax latency: {} ms",
-		(m_ack != 0) ? std::chrono::duration_cast<std::chrono::microseconds>(
-			m_totalRecvTime / m_ack).count() / 1000.f : 0,
+		(acked != 0) ? std::chrono::duration_cast<std::chrono::microseconds>(
+			m_ackTracker.GetTotalLatency() / acked).count() / 1000.f : 0,
 		std::chrono::duration_cast<std::chrono::microseconds>(
-			m_maxRecvTime).count() / 1000.f);
+			m_ackTracker.GetMaxLatency()).count() / 1000.f);
+	const auto toMs = [](uint64_t ns) { return static_cast<float>(ns / 1000) / 1000.f; };
+	SPDLOG_INFO("Latency P50: {} ms\tP90: {} ms\tP99: {} ms\tP99.9: {} ms\tJitter: {} ms",
+		toMs(m_latency.GetPercentile(50)), toMs(m_latency.GetPercentile(90)),
+		toMs(m_latency.GetPercentile(99)), toMs(m_latency.GetPercentile(99.9)),
+		std::chrono::duration_cast<std::chrono::microseconds>(m_ackTracker.GetJitter()).count() / 1000.f);
+	// each packet costs a send and an ack receive. The thread of a fan-out
+	// is shared, so its usage is reported once for every target
+	if (m_ownReporter != nullptr)
+	{
+		Detail::CpuMeter::Report(m_cpuMeter.Read() - m_phaseCpu, sent, m_totalBytes,
+			Clock_t::now() - m_start);
+	}
+	PrintLossStats();
+	if (m_reporter.GetDropped() != 0)
+		SPDLOG_WARN("Reporter fell behind and dropped {} intervals", m_reporter.GetDropped());
+}
+
+void Client::AccumulateTotals(Clock_t::duration elapsed) noexcept
+{
+	m_totals.sent += m_ackTracker.GetSent();
+	m_totals.received += m_ackTracker.GetAcked();
+	m_totals.corrupted += m_ackTracker.GetCorrupted();
+	m_totals.lost += m_ackTracker.GetLossTracker().GetLost();
+	m_totals.bytes += m_totalBytes;
+	m_totals.elapsed += elapsed;
+	m_totals.totalLatency += std::chrono::duration_cast<Clock_t::duration>(m_ackTracker.GetTotalLatency());
+	m_totals.latency.Merge(m_latency);
+	m_totals.jitter = std::max(m_totals.jitter,
+		std::chrono::duration_cast<Clock_t::duration>(m_ackTracker.GetJitter()));
+}
+
+void Client::PrintLossAttribution(uint64_t lost) noexcept
+{
+	// a dropped ack loses its packet as far as the client can tell
+	const uint64_t receiverBuffer = m_phaseServerDrops + m_phaseClientDrops;
+	const uint64_t attributed = std::min(lost, receiverBuffer + m_sendDropped);
+	// a reflector can't be asked, so its drops count as network loss
+	SPDLOG_INFO("Lost to the network: {}\tReceive queues: {} (server {}, client {})\tSend queue: {}",
+		lost - attributed, receiverBuffer,
+		(m_reflector == true) ? std::string("unknown") : std::to_string(m_phaseServerDrops),
+		m_phaseClientDrops, m_sendDropped);
+	if (m_phaseUdpCounters.inErrors != 0 || m_phaseUdpCounters.sndbufErrors != 0)
+	{
+		SPDLOG_INFO("Host UDP errors: InErrors: {}\tRcvbufErrors: {}\tSndbufErrors: {}",
+			m_phaseUdpCounters.inErrors, m_phaseUdpCounters.rcvbufErrors,
+			m_phaseUdpCounters.sndbufErrors);
+	}
+}
+
+void Client::PrintLossStats() noexcept
+{
+	const Detail::LossTracker& lossTracker = m_ackTracker.GetLossTracker();
+	const Detail::Histogram& bursts = lossTracker.GetBurstLengths();
+	const Detail::Histogram& gaps = lossTracker.GetGapLengths();
+	SPDLOG_INFO("Loss episodes: {}\tBurst length P50: {}\tP99: {}\tMax: {}",
+		lossTracker.GetEpisodeCount(), bursts.GetPercentile(50),
+		bursts.GetPercentile(99), bursts.GetMax());
+	if (lossTracker.GetEpisodeCount() == 0)
+		return;
+	SPDLOG_INFO("Gap length P50: {}\tP99: {}\tMax: {}", gaps.GetPercentile(50),
+		gaps.GetPercentile(99), gaps.GetMax());
+	const Detail::LossTracker::GilbertElliott model = lossTracker.Fit();
+	SPDLOG_INFO("{} fit: p (good to bad): {:.5f}\tr (bad to good): {:.5f}\th (bad state delivery): {:.5f}",
+		(model.fitted == true) ? "Gilbert-Elliott" : "Gilbert", model.p, model.r, model.h);
+	SPDLOG_INFO("Burst lengths:");
+	for (uint32_t i = 0; i < Detail::Histogram::BucketCount; ++i)
+	{
+		if (bursts.GetBucketCount(i) == 0)
+			continue;
+		const uint64_t lower = Detail::Histogram::GetBucketLowerBound(i);
+		const uint64_t upper = Detail::Histogram::GetBucketUpperBound(i);
+		if (lower == upper)
+			SPDLOG_INFO("  {}: {}", lower, bursts.GetBucketCount(i));
+		else
+			SPDLOG_INFO("  {}-{}: {}", lower, upper, bursts.GetBucketCount(i));
+	}
+	SPDLOG_INFO("Recent loss episodes:");
+	lossTracker.ForEachEpisode([](const Detail::LossTracker::Episode& episode)
+		{
+			SPDLOG_INFO("  +{:.3f} s\tseq {}\t{} lost", 
+				static_cast<double>(episode.startNs) / 1e9, episode.firstSeq, episode.length);
+		});
+}
+
+void Client::PrintSweepStats() noexcept
+{
+	SPDLOG_INFO("Sweep stats (path MTU: {}):", (m_pathMtu != 0) ?
+		std::to_string(m_pathMtu) : std::string("unknown"));
+	SPDLOG_INFO("Payload\tRate\tBitrate\tSent/s\tRecv/s\tLoss\tCorrupt\tAvg latency\tMax latency");
+	for (size_t i = 0; i < m_phaseResults.size(); ++i)
+	{
+		const PhaseResult& result = m_phaseResults[i];
+		SPDLOG_INFO("{}{}{}\t{}\t{}\t{}\t{}\t{:.3f}%\t{}\t{} ms\t{} ms", result.payloadSize,
+			result.fragmented ? " (frag)" : "",
+			(m_repeat > 1) ? " #" + std::to_string(i % m_repeat + 1) : std::string(), result.packetRate,
+			BitsToString(result.totalBytes / result.time * 8),
+			result.sent / result.time, result.received / result.time,
+			(result.sent != 0) ? static_cast<float>(result.lost) / result.sent * 100 : 0.f, result.corrupted,
+			std::chrono::duration_cast<std::chrono::microseconds>(
+				result.averageLatency).count() / 1000.f,
+			std::chrono::duration_cast<std::chrono::microseconds>(
+				result.maxLatency).count() / 1000.f);
+	}
+}
+
+void Client::PrintRepeatStats() noexcept
+{
+	const auto print = [](const char* name, const std::vector<double>& samples, const char* unit)
+	{
+		const Detail::Summary summary = Detail::Summary::Of(samples);
+		SPDLOG_INFO("  {}: {:.3f} +/- {:.3f} {}\t(stddev {:.3f})", name,
+			summary.mean, summary.confidence, unit, summary.stddev);
+	};
+	for (size_t phase = 0; phase < m_phases.size(); ++phase)
+	{
+		std::vector<double> bitrate;
+		std::vector<double> received;
+		std::vector<double> loss;
+		std::vector<double> p50;
+		std::vector<double> p99;
+		for (size_t i = phase * m_repeat; i < std::min<size_t>((phase + 1) * m_repeat,
+			m_phaseResults.size()); ++i)
+		{
+			const PhaseResult& result = m_phaseResults[i];
+			bitrate.push_back(static_cast<double>(result.totalBytes * 8) / result.time / 1e6);
+			received.push_back(static_cast<double>(result.received) / result.time);
+			loss.push_back((result.sent != 0) ? static_cast<double>(result.lost) / result.sent * 100 : 0.);
+			p50.push_back(static_cast<double>(result.p50LatencyNs) / 1e6);
+			p99.push_back(static_cast<double>(result.p99LatencyNs) / 1e6);
+		}
+		SPDLOG_INFO("{} runs of {} byte payloads at {} packets/s, mean +/- 95% confidence interval:",
+			bitrate.size(), m_phaseResults[phase * m_repeat].payloadSize,
+			m_phaseResults[phase * m_repeat].packetRate);
+		print("Bitrate", bitrate, "Mbit/s");
+		print("Received", received, "packets/s");
+		print("Loss", loss, "%");
+		print("Latency P50", p50, "ms");
+		print("Latency P99", p99, "ms");
+	}
+}
+
+void Client::PrintSessionStats() noexcept
+{
+	const auto toMs = [](Clock_t::duration duration)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000.;
+	};
+	const std::string title = (m_ownReporter != nullptr) ?
+		std::string("Session") : "Session of " + m_target;
+	// a reflector is sent to without a connect or a handshake
+	if (m_reflector == true)
+		SPDLOG_INFO("{}: setup {:.3f} ms", title, toMs(m_setupTime));
+	else
+	{
+		SPDLOG_INFO("{}: connect {:.3f} ms\thandshake {:.3f} ms\tsetup {:.3f} ms", title,
+			toMs(m_connectTime), toMs(m_handshakeTime), toMs(m_setupTime));
+	}
+	if (m_phaseChanges != 0)
+	{
+		SPDLOG_INFO("{}: {} phase changes averaging {:.3f} ms, draining acks included", title,
+			m_phaseChanges, toMs(m_phaseChangeTime / m_phaseChanges));
+	}
 }
 
 std::string Client::BitsToString(uint64_t bits) noexcept
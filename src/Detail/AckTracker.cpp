@@ -0,0 +1,122 @@
+#include <UDPTest/Detail/AckTracker.h>
+
+#include <UDPTest/Detail/Transport.h>
+
+#include <algorithm>
+
+using UDPTest::Detail::AckTracker;
+
+AckTracker::AckTracker(size_t window, bool echoesTimestamp, uint64_t firstSeq)
+	: m_lossTracker(window), m_sendTimes(m_lossTracker.GetWindow()),
+	m_echoesTimestamp(echoesTimestamp), m_phaseStart(0), m_seq(firstSeq)
+{
+	BeginPhase(Duration_t(0));
+}
+
+void AckTracker::BeginPhase(Duration_t now) noexcept
+{
+	m_lossTracker.Reset(m_seq);
+	m_phaseStart = now;
+	m_phaseFirstSeq = m_seq;
+	m_acked = 0;
+	m_corrupted = 0;
+	m_lateAcks = 0;
+	m_reordered = 0;
+	m_maxDisplacement = 0;
+	m_highestAcked = m_seq;
+	m_duplicates = 0;
+	m_totalLatency = {};
+	m_maxLatency = {};
+	m_jitter = {};
+	m_lastLatencySeen = false;
+	m_lastLatency = {};
+}
+
+uint64_t AckTracker::OnSend(Duration_t now) noexcept
+{
+	const uint64_t seq = m_seq++;
+	// an ack a whole window late counts as lost, which frees the send
+	// time slot this seq takes over
+	uint64_t lost = 0;
+	if (m_seq - m_lossTracker.GetNextSeq() > m_lossTracker.GetWindow())
+		lost = FinalizeLoss(m_seq - m_lossTracker.GetWindow());
+	m_sendTimes[seq % m_sendTimes.size()] = now;
+	return lost;
+}
+
+AckTracker::Ack AckTracker::OnAck(uint32_t wireSeq, bool corrupt, uint64_t echoedNs,
+	Duration_t now) noexcept
+{
+	Ack ack{ RandomPacket::ExtendSeq(wireSeq, m_seq), Outcome::Straggler, Duration_t(0) };
+	// stragglers from an earlier phase are expected
+	if (ack.seq < m_phaseFirstSeq)
+		return ack;
+	if (ack.seq >= m_seq)
+	{
+		ack.outcome = Outcome::Unsent;
+		return ack;
+	}
+	// the loss tracker already counted it lost, and can't tell copies apart
+	if (ack.seq < m_lossTracker.GetNextSeq())
+	{
+		ack.outcome = Outcome::Late;
+		++m_lateAcks;
+		return ack;
+	}
+	// in flight, so the window tells whether it was acked before
+	if (m_lossTracker.IsReceived(ack.seq) == true)
+	{
+		// the ack was duplicated on the way back
+		ack.outcome = Outcome::Duplicate;
+		++m_duplicates;
+		return ack;
+	}
+	m_lossTracker.OnReceived(ack.seq);
+	if (corrupt == true)
+	{
+		// arrived, but not as sent, so it's neither received nor lost
+		ack.outcome = Outcome::Corrupt;
+		++m_corrupted;
+		return ack;
+	}
+	++m_acked;
+	ack.outcome = Outcome::Received;
+	// prefer the send time the ack echoes
+	ack.latency = (m_echoesTimestamp == true) ? now - Duration_t(echoedNs) :
+		now - m_sendTimes[ack.seq % m_sendTimes.size()];
+	m_maxLatency = std::max(m_maxLatency, ack.latency);
+	m_totalLatency += ack.latency;
+	// J += (|D| - J) / 16, as RFC 3550 smooths it
+	if (m_lastLatencySeen == true)
+	{
+		const Duration_t difference = (ack.latency > m_lastLatency) ?
+			ack.latency - m_lastLatency : m_lastLatency - ack.latency;
+		m_jitter += (difference - m_jitter) / 16;
+	}
+	m_lastLatencySeen = true;
+	m_lastLatency = ack.latency;
+	if (ack.seq < m_highestAcked)
+	{
+		++m_reordered;
+		m_maxDisplacement = std::max(m_maxDisplacement, m_highestAcked - ack.seq);
+	}
+	else
+		m_highestAcked = ack.seq;
+	return ack;
+}
+
+uint64_t AckTracker::FinalizeLoss() noexcept
+{
+	return FinalizeLoss(m_seq);
+}
+
+uint64_t AckTracker::FinalizeLoss(uint64_t endSeq) noexcept
+{
+	const uint64_t lost = m_lossTracker.GetLost();
+	while (m_lossTracker.GetNextSeq() != endSeq)
+	{
+		m_lossTracker.Finalize((m_sendTimes[m_lossTracker.GetNextSeq() % m_sendTimes.size()] -
+			m_phaseStart).count());
+	}
+	return m_lossTracker.GetLost() - lost;
+}
\ No newline at end of file
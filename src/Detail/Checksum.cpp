@@ -0,0 +1,104 @@
+#include <UDPTest/Detail/Checksum.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define UDPTEST_CRC32C_SSE42
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define UDPTEST_CRC32C_ARM
+#include <arm_acle.h>
+#endif
+
+// STL includes
+#include <array>
+#include <cstring>
+
+namespace
+{
+	using Crc32cFunction_t = uint32_t(*)(uint32_t, const uint8_t*, size_t);
+
+	uint32_t Crc32cTable(uint32_t crc, const uint8_t* data, size_t size) noexcept
+	{
+		static const std::array<uint32_t, 256> table = []()
+		{
+			std::array<uint32_t, 256> table{};
+			for (uint32_t i = 0; i < table.size(); ++i)
+			{
+				uint32_t entry = i;
+				for (int bit = 0; bit < 8; ++bit)
+					entry = (entry >> 1) ^ (0x82F63B78 & (0 - (entry & 1)));
+				table[i] = entry;
+			}
+			return table;
+		}();
+		for (size_t i = 0; i < size; ++i)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return crc;
+	}
+
+#ifdef UDPTEST_CRC32C_SSE42
+#ifndef _MSC_VER
+	__attribute__((target("sse4.2")))
+#endif
+	uint32_t Crc32cSSE42(uint32_t crc, const uint8_t* data, size_t size) noexcept
+	{
+		uint64_t crc64 = crc;
+		for (; size >= 8; size -= 8, data += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, data, 8);
+			crc64 = _mm_crc32_u64(crc64, word);
+		}
+		crc = static_cast<uint32_t>(crc64);
+		for (; size > 0; --size, ++data)
+			crc = _mm_crc32_u8(crc, *data);
+		return crc;
+	}
+#endif
+
+#ifdef UDPTEST_CRC32C_ARM
+	uint32_t Crc32cARM(uint32_t crc, const uint8_t* data, size_t size) noexcept
+	{
+		for (; size >= 8; size -= 8, data += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, data, 8);
+			crc = __crc32cd(crc, word);
+		}
+		for (; size > 0; --size, ++data)
+			crc = __crc32cb(crc, *data);
+		return crc;
+	}
+#endif
+
+	Crc32cFunction_t SelectCrc32c() noexcept
+	{
+#if defined(UDPTEST_CRC32C_SSE42) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 20)) != 0)
+			return Crc32cSSE42;
+#elif defined(UDPTEST_CRC32C_SSE42)
+		if (__builtin_cpu_supports("sse4.2"))
+			return Crc32cSSE42;
+#elif defined(UDPTEST_CRC32C_ARM)
+		return Crc32cARM;
+#endif
+		return Crc32cTable;
+	}
+
+	// picked once, the CPU doesn't change under us
+	const Crc32cFunction_t crc32cFunction = SelectCrc32c();
+}
+
+uint32_t UDPTest::Detail::Crc32c(const void* data, size_t size, uint32_t crc) noexcept
+{
+	return ~crc32cFunction(~crc, static_cast<const uint8_t*>(data), size);
+}
+
+bool UDPTest::Detail::IsCrc32cAccelerated() noexcept
+{
+	return crc32cFunction != Crc32cTable;
+}
\ No newline at end of file
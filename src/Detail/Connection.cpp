@@ -3,15 +3,33 @@
 #include <UDPTest/Common.h>
 #include <UDPTest/Detail/ConnectionManager.h>
 #include <UDPTest/Detail/Control.h>
+#include <UDPTest/Detail/KernelCounters.h>
+#include <UDPTest/Detail/SocketOptions.h>
 
 using UDPTest::Detail::Connection;
 
 Connection::Connection(ConnectionManager& connectionManager,
-	TCPSocket_t socket) noexcept
+	TCPSocket_t socket, size_t receiveDepth, EventLog* eventLog,
+	const ImpairmentConfig& impairment) noexcept
 	: m_connectionManager(connectionManager),
 		m_controlSocket(std::move(socket)),
-		m_transportSocket(socket.get_executor()),
-		m_randomPacket(0) {}
+		m_transportSocket(m_controlSocket.get_executor()),
+		m_eventLog(eventLog), m_receiveSlots(receiveDepth), m_ackFields(BaseAckFields),
+		m_ackQueue(AckQueueDepth), m_ackHead(0), m_ackCount(0), m_writing(false),
+		m_verify(false), m_checkPayload(false), m_payloadSeed(0), m_packetsVerified(0),
+		m_phases(0), m_tos(0), m_priority(0), m_streamId(0),
+		m_impairment(impairment), m_impaired(impairment.IsEnabled()),
+		m_holdEpoch(std::chrono::steady_clock::now()),
+		m_holdTimer(m_controlSocket.get_executor()), m_holdTimerArmed(false), m_holdTimerTick(0)
+{
+	ErrorCode_t ec;
+	const auto remoteEndpoint = m_controlSocket.remote_endpoint(ec);
+	if (!ec)
+	{
+		m_remoteAddress = remoteEndpoint.address().to_string() + ':' + 
+			std::to_string(remoteEndpoint.port());
+	}
+}
 
 void Connection::Start() noexcept
 {
@@ -25,9 +43,26 @@ void Connection::Stop() noexcept
 	m_controlSocket.close(ignored);
 	m_transportSocket.shutdown(UDPSocket_t::shutdown_both, ignored);
 	m_transportSocket.close(ignored);
+	m_holdTimer.cancel(ignored);
 	SPDLOG_INFO("Stopped connection");
 }
 
+void Connection::CollectStats(ConnectionStats& stats, Histogram& ackLatency) noexcept
+{
+	m_stats.ackQueueDepth = m_ackCount;
+	m_stats.acksHeld = m_heldAcks.GetSize();
+	m_stats.lostTotal = m_receiveTracker.GetLost();
+	m_stats.corruptedTotal = m_receiveTracker.GetCorrupted();
+	m_stats.streamId = m_streamId;
+	m_stats.tos = m_tos;
+	m_stats.jitterNs = m_receiveTracker.GetJitterNs();
+	stats = m_stats;
+	ackLatency = m_ackLatency;
+	m_ackLatency.Reset();
+	m_stats = ConnectionStats();
+	m_stats.maxAckQueueDepth = m_ackCount;
+}
+
 void Connection::ReadControl() noexcept
 {
 	auto self = shared_from_this();
@@ -47,10 +82,14 @@ void Connection::ReadControl() noexcept
 						m_response = Response(Response::Status::AlreadyOpen,
 							UDPProto_t::endpoint());
 					}
-					else if (m_transportSocket.open(UDPProto_t::v4(), ec), ec ||
-						m_transportSocket.bind(UDPProto_t::endpoint(
-							m_controlSocket.local_endpoint().address(),
-							m_controlSocket.local_endpoint().port()), ec), ec)
+					else if (m_request.GetWireVersion() != WireVersion)
+					{
+						SPDLOG_ERROR("{}: Client speaks wire version {}, expected {}",
+							m_remoteAddress, m_request.GetWireVersion(), WireVersion);
+						m_response = Response(Response::Status::UnsupportedWire,
+							UDPProto_t::endpoint());
+					}
+					else if (OpenTransport(ec), ec)
 					{
 						m_transportSocket.close(ec);
 						m_response = Response(Response::Status::FailedToOpen, 
@@ -63,11 +102,25 @@ void Connection::ReadControl() noexcept
 							m_transportSocket.local_endpoint().port());
 						m_response = Response(Response::Status::OK,
 							m_transportSocket.local_endpoint());
-						// resize packet
-						m_randomPacket = RandomPacket(m_request.GetPayloadSize());
-						SPDLOG_DEBUG("Reading for payloads of size {}",
-							m_randomPacket.GetPayloadSize());
-						ReadTransport();
+						if (m_request.GetBufferSize() != 0)
+							SizeBuffers(m_request.GetBufferSize());
+						const FieldSet fields = m_request.GetFields();
+						m_ackFields = GetAckFields(fields);
+						m_verify = (fields & FieldBit(Field::Checksum)) != 0;
+						m_checkPayload = (m_request.GetFlags() & Request::Flags::FreshPayload) != 0;
+						m_payloadSeed = m_request.GetSeed();
+						m_phases = 0;
+						m_streamId = 0;
+						m_receiveTracker.ResetJitter();
+						// resize the receive ring and post every receive
+						for (ReceiveSlot& slot : m_receiveSlots)
+							slot.packet = RandomPacket(fields, m_request.GetPayloadSize());
+						SPDLOG_DEBUG("Reading for payloads of size {} behind a {} header with {} receives{}{}",
+							m_request.GetPayloadSize(), DescribeFields(fields), m_receiveSlots.size(),
+							(m_verify == true) ? ", verifying integrity" : "",
+							(m_checkPayload == true) ? ", checking payloads" : "");
+						for (size_t i = 0; i < m_receiveSlots.size(); ++i)
+							ReadTransport(i);
 					}
 					break;
 				case Request::Command::Close:
@@ -83,6 +136,60 @@ void Connection::ReadControl() noexcept
 						m_response = Response(Response::Status::OK,
 							UDPProto_t::endpoint());
 					}
+					// held acks have nowhere to go
+					m_heldAcks.Clear();
+					m_holdTimer.cancel(ec);
+					m_holdTimerArmed = false;
+					break;
+				}
+				case Request::Command::Stats:
+				{
+					uint64_t drops = 0;
+					if (m_transportSocket.is_open() == true)
+					{
+						drops = GetSocketDrops(m_transportSocket, ec);
+						if (ec)
+							SPDLOG_DEBUG("Failed to read socket drops: {}", ec.message());
+						else if (drops != 0)
+						{
+							SPDLOG_INFO("{}: {} datagrams dropped by a full receive queue",
+								m_remoteAddress, drops);
+						}
+					}
+					m_response = Response(Response::Status::OK,
+						UDPProto_t::endpoint(), static_cast<uint32_t>(drops));
+					break;
+				}
+				case Request::Command::Phase:
+				{
+					// the receives stay posted across phases, so they must
+					// already be large enough
+					if (m_transportSocket.is_open() == false ||
+						m_request.GetPayloadSize() > m_receiveSlots.front().packet.GetPayloadSize())
+					{
+						SPDLOG_ERROR("{}: Rejected a phase with payloads of {} bytes",
+							m_remoteAddress, m_request.GetPayloadSize());
+						m_response = Response(Response::Status::InvalidPhase,
+							UDPProto_t::endpoint());
+						break;
+					}
+					SPDLOG_INFO("{}: Phase {}: payloads of {} bytes at {} packets/s for {} s",
+						m_remoteAddress, ++m_phases, m_request.GetPayloadSize(),
+						m_request.GetPacketRate(), m_request.GetDuration());
+					// acks travel back marked as the client's packets are
+					if (m_request.GetTos() != m_tos || m_request.GetPriority() != m_priority)
+					{
+						m_tos = m_request.GetTos();
+						m_priority = m_request.GetPriority();
+						if (SetTos(m_transportSocket, m_tos, ec), ec)
+							SPDLOG_WARN("{}: Failed to mark acks with TOS {:#04x}: {}", m_remoteAddress, m_tos, ec.message());
+						if (SetPriority(m_transportSocket, m_priority, ec), ec)
+							SPDLOG_WARN("{}: Failed to send acks at priority {}: {}", m_remoteAddress, m_priority, ec.message());
+						SPDLOG_INFO("{}: Marking acks with DSCP {} at priority {}",
+							m_remoteAddress, m_tos >> 2, m_priority);
+					}
+					m_response = Response(Response::Status::OK,
+						UDPProto_t::endpoint());
 					break;
 				}
 				}
@@ -97,6 +204,18 @@ void Connection::ReadControl() noexcept
 		});
 }
 
+void Connection::OpenTransport(ErrorCode_t& ec) noexcept
+{
+	const TCPProto_t::endpoint local = m_controlSocket.local_endpoint(ec);
+	if (ec || (m_transportSocket.open(UDPProto_t::v4(), ec), ec))
+		return;
+	// the first transport takes the control port, any other open at the
+	// same time, like another traffic class of the same client, one of its own
+	if (m_transportSocket.bind(UDPProto_t::endpoint(local.address(), local.port()), ec),
+		ec == asio::error::address_in_use)
+		m_transportSocket.bind(UDPProto_t::endpoint(local.address(), 0), ec);
+}
+
 void Connection::WriteControl() noexcept
 {
 	auto self = shared_from_this();
@@ -116,18 +235,60 @@ void Connection::WriteControl() noexcept
 		});
 }
 
-void Connection::ReadTransport() noexcept
+void Connection::ReadTransport(size_t slot) noexcept
 {
 	auto self = shared_from_this();
-	m_transportSocket.async_receive_from(m_randomPacket.GetBuffers(), 
-		m_transportEndpoint, [this, self](const ErrorCode_t& ec, size_t)
+	ReceiveSlot& receiveSlot = m_receiveSlots[slot];
+	m_transportSocket.async_receive_from(receiveSlot.packet.GetBuffers(), 
+		receiveSlot.endpoint, [this, self, slot](const ErrorCode_t& ec, size_t bytes)
 		{
 			if (!ec)
 			{
-				SPDLOG_DEBUG("Received random packet of seq {}",
-					m_randomPacket.GetSeq());
-				m_packetAck = PacketAck(m_randomPacket.GetSeq());
-				WriteTransport();
+				const ReceiveSlot& receiveSlot = m_receiveSlots[slot];
+				const uint32_t seq = receiveSlot.packet.GetSeq();
+				UDPTEST_PACKET_DEBUG("Received random packet of seq {}", seq);
+				++m_stats.packetsReceived;
+				m_stats.bytesReceived += bytes;
+				uint8_t flags = 0;
+				// a runt's header is partly left over from an earlier packet
+				if (bytes < receiveSlot.packet.GetHeaderSize() ||
+					((m_verify == true || m_checkPayload == true) &&
+						VerifyPacket(receiveSlot.packet, bytes) == false))
+				{
+					// the seq may be what got corrupted, so it isn't tracked
+					UDPTEST_PACKET_DEBUG("Packet of seq {} failed its integrity check", seq);
+					++m_stats.packetsCorrupted;
+					m_receiveTracker.OnCorrupt();
+					flags = PacketAck::Flags::Corrupt;
+				}
+				// path MTU probes are not part of the sequence
+				else if (receiveSlot.packet.IsProbe() == false)
+				{
+					m_receiveTracker.OnPacket(seq);
+					m_streamId = receiveSlot.packet.GetHeader().Get<Field::StreamId>();
+					if (receiveSlot.packet.GetHeader().GetLayout().Has(Field::Timestamp) == true)
+					{
+						m_receiveTracker.OnTransit(receiveSlot.packet.GetHeader().Get<Field::Timestamp>(),
+							std::chrono::steady_clock::now().time_since_epoch());
+					}
+				}
+				if (m_eventLog != nullptr)
+				{
+					m_eventLog->Record((flags == 0) ? EventType::PacketReceived :
+						EventType::PacketCorrupt, seq, static_cast<uint32_t>(bytes), 0,
+						receiveSlot.endpoint.port());
+				}
+				// the transport may have been closed by a request
+				if (m_transportSocket.is_open() == false)
+					return;
+				const PendingAck pending{ PacketAck(m_ackFields, receiveSlot.packet.GetHeader(), flags),
+					receiveSlot.endpoint,
+					std::chrono::steady_clock::now() };
+				if (m_impaired == true)
+					ImpairAck(pending);
+				else
+					QueueAck(pending);
+				ReadTransport(slot);
 			}
 			else if (ec != asio::error::operation_aborted)
 			{
@@ -141,14 +302,34 @@ void Connection::ReadTransport() noexcept
 void Connection::WriteTransport() noexcept
 {
 	auto self = shared_from_this();
-	m_transportSocket.async_send_to(m_packetAck.GetBuffers(),
-		m_transportEndpoint, [this, self](const ErrorCode_t& ec, size_t)
+	m_writing = true;
+	PendingAck& pending = m_ackQueue[m_ackHead];
+	m_transportSocket.async_send_to(pending.ack.GetBuffers(),
+		pending.endpoint, [this, self](const ErrorCode_t& ec, size_t bytes)
 		{
 			if (!ec)
 			{
-				SPDLOG_DEBUG("Wrote ack {}",
-					m_packetAck.GetSeq());
-				ReadTransport();
+				const PendingAck& sent = m_ackQueue[m_ackHead];
+				UDPTEST_PACKET_DEBUG("Wrote ack {}", sent.ack.GetSeq());
+				++m_stats.acksSent;
+				const auto ackLatency = static_cast<uint64_t>(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - sent.received).count());
+				m_ackLatency.Record(ackLatency);
+				m_stats.ackLatencySumNs += ackLatency;
+				m_stats.ackLatencyMaxNs = std::max(m_stats.ackLatencyMaxNs, ackLatency);
+				if (m_eventLog != nullptr)
+				{
+					m_eventLog->Record(EventType::AckSent, sent.ack.GetSeq(),
+						static_cast<uint32_t>(bytes), ackLatency, sent.endpoint.port());
+				}
+				m_ackHead = (m_ackHead + 1) & (AckQueueDepth - 1);
+				--m_ackCount;
+				if (m_ackCount != 0 &&
+					m_transportSocket.is_open() == true)
+					return WriteTransport();
+				m_ackCount = 0;
+				m_writing = false;
 			}
 			else if (ec != asio::error::operation_aborted)
 			{
@@ -156,5 +337,126 @@ void Connection::WriteTransport() noexcept
 					ec.message());
 				m_connectionManager.Stop(self);
 			}
+			else
+			{
+				// the transport was closed, drop whatever is left
+				m_ackCount = 0;
+				m_writing = false;
+			}
 		});
+}
+
+void Connection::SizeBuffers(uint32_t size) noexcept
+{
+	ErrorCode_t ec;
+	const uint32_t granted = SetBufferSizes(m_transportSocket, size, ec);
+	if (ec)
+		SPDLOG_WARN("Failed to size socket buffers: {}", ec.message());
+	else if (granted < size)
+	{
+		SPDLOG_WARN("Asked for {} byte socket buffers but got {}, raise net.core.rmem_max and wmem_max",
+			size, granted);
+	}
+	else
+		SPDLOG_DEBUG("Sized socket buffers to {} bytes", granted);
+}
+
+bool Connection::VerifyPacket(const RandomPacket& packet, size_t bytes) noexcept
+{
+	// the checksum is a header field right after the seq, and the CRC
+	// covers every byte of the datagram but its own
+	const auto check = [this, &packet, bytes]()
+	{
+		return (m_verify == false || packet.Verify(bytes) == true) &&
+			(m_checkPayload == false || packet.CheckFill(bytes, m_payloadSeed) == true);
+	};
+	if (m_packetsVerified++ % VerifySampleInterval != 0)
+		return check();
+	const auto start = std::chrono::steady_clock::now();
+	const bool intact = check();
+	m_stats.verifySampleNs += static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count());
+	m_stats.verifySampleBytes += bytes;
+	++m_stats.verifySamples;
+	return intact;
+}
+
+void Connection::QueueAck(const PendingAck& pending) noexcept
+{
+	if (m_ackCount == AckQueueDepth)
+	{
+		++m_stats.acksQueueDropped;
+		return;
+	}
+	m_ackQueue[(m_ackHead + m_ackCount) & (AckQueueDepth - 1)] = pending;
+	++m_ackCount;
+	if (m_ackCount > m_stats.maxAckQueueDepth)
+		m_stats.maxAckQueueDepth = m_ackCount;
+	if (m_writing == false)
+		WriteTransport();
+}
+
+void Connection::ImpairAck(const PendingAck& pending) noexcept
+{
+	if (m_impairment.Drop() == true)
+	{
+		++m_stats.acksImpairDropped;
+		return;
+	}
+	const int copies = (m_impairment.Duplicate() == true) ? 2 : 1;
+	if (copies == 2)
+		++m_stats.acksDuplicated;
+	for (int i = 0; i < copies; ++i)
+	{
+		// every copy draws its own delay, so duplicates can arrive apart
+		bool reordered = false;
+		const auto delay = m_impairment.Delay(reordered);
+		if (reordered == true)
+			++m_stats.acksReordered;
+		if (delay.count() == 0)
+		{
+			QueueAck(pending);
+			continue;
+		}
+		// round up so no ack leaves early
+		const auto due = pending.received + delay - m_holdEpoch;
+		m_heldAcks.Schedule(static_cast<uint64_t>((due + HoldTick - std::chrono::nanoseconds(1)) / HoldTick),
+			pending);
+	}
+	if (m_heldAcks.IsEmpty() == false)
+		ArmHoldTimer();
+}
+
+void Connection::ArmHoldTimer() noexcept
+{
+	const uint64_t next = m_heldAcks.GetNextTick();
+	if (m_holdTimerArmed == true && next >= m_holdTimerTick)
+		return;
+	// re-arming aborts the earlier wait
+	m_holdTimerArmed = true;
+	m_holdTimerTick = next;
+	m_holdTimer.expires_at(m_holdEpoch + next * HoldTick);
+	auto self = shared_from_this();
+	m_holdTimer.async_wait([this, self](const ErrorCode_t& ec)
+		{
+			if (ec)
+				return;
+			m_holdTimerArmed = false;
+			ReleaseHeldAcks();
+		});
+}
+
+void Connection::ReleaseHeldAcks() noexcept
+{
+	if (m_transportSocket.is_open() == false)
+	{
+		m_heldAcks.Clear();
+		return;
+	}
+	const auto now = static_cast<uint64_t>(
+		(std::chrono::steady_clock::now() - m_holdEpoch) / HoldTick);
+	m_heldAcks.Advance(now, [this](PendingAck&& pending) { QueueAck(pending); });
+	if (m_heldAcks.IsEmpty() == false)
+		ArmHoldTimer();
 }
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include <UDPTest/Detail/CpuMeter.h>
+
+#include <UDPTest/Common.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using UDPTest::Detail::CpuMeter;
+
+CpuMeter::CpuMeter(bool hardware) noexcept
+	: m_hardware(hardware), m_opened(false)
+{
+	m_fds.fill(-1);
+}
+
+CpuMeter::~CpuMeter()
+{
+#ifdef __linux__
+	for (const int fd : m_fds)
+	{
+		if (fd != -1)
+			close(fd);
+	}
+#endif
+}
+
+void CpuMeter::Start() noexcept
+{
+	if (m_hardware == true && m_opened == false)
+		OpenHardware();
+	m_opened = true;
+	m_start = ReadTotal();
+}
+
+CpuMeter::Usage CpuMeter::Read() const noexcept
+{
+	return ReadTotal() - m_start;
+}
+
+void CpuMeter::Report(const Usage& usage, uint64_t packets, uint64_t bytes,
+	std::chrono::nanoseconds elapsed) noexcept
+{
+	const double cpuNs = static_cast<double>(usage.GetCpuNs());
+	SPDLOG_INFO("CPU: {:.3f} s user, {:.3f} s system ({:.1f}% of a core)\tContext switches: {} voluntary, {} involuntary",
+		usage.userNs / 1e9, usage.systemNs / 1e9,
+		(elapsed.count() != 0) ? cpuNs / elapsed.count() * 100 : 0.,
+		usage.voluntarySwitches, usage.involuntarySwitches);
+	if (packets == 0 || bytes == 0)
+		return;
+	SPDLOG_INFO("CPU per packet: {:.0f} ns\tPer gigabit: {:.3f} core seconds",
+		cpuNs / packets, cpuNs / (static_cast<double>(bytes) * 8));
+	if (usage.hardware == true)
+	{
+		SPDLOG_INFO("Cycles/byte: {:.2f}\tCycles/packet: {:.0f}\tInstructions/cycle: {:.2f}\tCache misses/packet: {:.2f}",
+			static_cast<double>(usage.cycles) / bytes, static_cast<double>(usage.cycles) / packets,
+			(usage.cycles != 0) ? static_cast<double>(usage.instructions) / usage.cycles : 0.,
+			static_cast<double>(usage.cacheMisses) / packets);
+	}
+}
+
+#ifdef __linux__
+void CpuMeter::OpenHardware() noexcept
+{
+	static constexpr uint64_t configs[HardwareCounterCount] =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES
+	};
+	// the network stack runs in the kernel, so count it unless that's forbidden
+	for (const bool excludeKernel : { false, true })
+	{
+		int error = 0;
+		for (int i = 0; i < HardwareCounterCount && error == 0; ++i)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[i];
+			attr.exclude_kernel = excludeKernel ? 1 : 0;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			// this thread on any CPU, in one group so the counters line up
+			m_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1,
+				(i == 0) ? -1 : m_fds[0], 0));
+			if (m_fds[i] == -1)
+				error = errno;
+		}
+		if (error == 0)
+		{
+			m_hardwareError.clear();
+			return;
+		}
+		m_hardwareError = std::strerror(error);
+		for (int& fd : m_fds)
+		{
+			if (fd != -1)
+				close(fd);
+			fd = -1;
+		}
+	}
+}
+#else
+void CpuMeter::OpenHardware() noexcept
+{
+	m_hardwareError = "perf_event is only available on Linux";
+}
+#endif
+
+CpuMeter::Usage CpuMeter::ReadTotal() const noexcept
+{
+	Usage usage;
+#ifdef _WIN32
+	FILETIME creation;
+	FILETIME exit;
+	FILETIME kernel;
+	FILETIME user;
+	if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user) != 0)
+	{
+		// file times count 100 ns ticks
+		usage.userNs = ((static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime) * 100;
+		usage.systemNs = ((static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime) * 100;
+	}
+#else
+	rusage resources;
+#ifdef RUSAGE_THREAD
+	const int who = RUSAGE_THREAD;
+#else
+	// without per-thread usage the whole process is counted
+	const int who = RUSAGE_SELF;
+#endif
+	if (getrusage(who, &resources) == 0)
+	{
+		const auto toNs = [](const timeval& time)
+		{
+			return static_cast<uint64_t>(time.tv_sec) * 1000000000 +
+				static_cast<uint64_t>(time.tv_usec) * 1000;
+		};
+		usage.userNs = toNs(resources.ru_utime);
+		usage.systemNs = toNs(resources.ru_stime);
+		usage.voluntarySwitches = static_cast<uint64_t>(resources.ru_nvcsw);
+		usage.involuntarySwitches = static_cast<uint64_t>(resources.ru_nivcsw);
+	}
+#endif
+#ifdef __linux__
+	if (m_fds[0] == -1)
+		return usage;
+	uint64_t* const values[HardwareCounterCount] =
+		{ &usage.cycles, &usage.instructions, &usage.cacheMisses };
+	for (int i = 0; i < HardwareCounterCount; ++i)
+	{
+		// value, time enabled, time running
+		uint64_t read[3];
+		if (::read(m_fds[i], read, sizeof(read)) != static_cast<ssize_t>(sizeof(read)))
+			return usage;
+		// scale up for the time the counter was multiplexed out
+		*values[i] = (read[2] != 0 && read[2] < read[1]) ?
+			static_cast<uint64_t>(static_cast<double>(read[0]) * read[1] / read[2]) : read[0];
+	}
+	usage.hardware = true;
+#endif
+	return usage;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include <UDPTest/Detail/EventLog.h>
+
+#include <array>
+#include <ctime>
+#include <iomanip>
+#include <stdexcept>
+
+using UDPTest::Detail::EventLog;
+using UDPTest::Detail::EventType;
+
+namespace
+{
+	/// @brief Events written with a single call
+	constexpr size_t WriteBatch = 1024;
+
+	const char* GetEventName(EventType type) noexcept
+	{
+		switch (type)
+		{
+		case EventType::PacketSent: return "sent";
+		case EventType::AckReceived: return "ack";
+		case EventType::AckCorrupt: return "ack-corrupt";
+		case EventType::PacketReceived: return "received";
+		case EventType::PacketCorrupt: return "corrupt";
+		case EventType::AckSent: return "ack-sent";
+		case EventType::Dropped: return "dropped";
+		}
+		return "unknown";
+	}
+}
+
+EventLog::EventLog(const std::string& path)
+	: m_file(path, std::ios::binary | std::ios::trunc),
+		m_start(std::chrono::steady_clock::now()),
+		m_queue(std::make_unique<SPSCQueue<Event, QueueSize>>()),
+		m_running(false), m_dropped(0), m_written(0)
+{
+	if (m_file.is_open() == false)
+		throw std::runtime_error("Failed to create event log " + path);
+	Header header;
+	header.magic = Magic;
+	header.version = Version;
+	header.eventSize = static_cast<uint16_t>(sizeof(Event));
+	header.startNs = static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count());
+	if (m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)).good() == false)
+		throw std::runtime_error("Failed to write event log " + path);
+}
+
+void EventLog::Start()
+{
+	m_running.store(true, std::memory_order_relaxed);
+	m_thread = std::thread(&EventLog::Run, this);
+}
+
+void EventLog::Stop() noexcept
+{
+	m_running.store(false, std::memory_order_relaxed);
+	if (m_thread.joinable() == true)
+		m_thread.join();
+	if (m_file.is_open() == false)
+		return;
+	Drain();
+	// the trailer says how much of the run is missing
+	Event trailer{};
+	trailer.timeNs = static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - m_start).count());
+	trailer.value = static_cast<uint32_t>(std::min<uint64_t>(GetDropped(), UINT32_MAX));
+	trailer.type = EventType::Dropped;
+	m_file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+	m_file.close();
+}
+
+void EventLog::Run() noexcept
+{
+	while (m_running.load(std::memory_order_relaxed) == true)
+	{
+		Drain();
+		// polling keeps the producer free of any wakeup syscall
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void EventLog::Drain() noexcept
+{
+	std::array<Event, WriteBatch> batch;
+	size_t count = 0;
+	do
+	{
+		count = 0;
+		while (count < batch.size() && m_queue->TryPop(batch[count]) == true)
+			++count;
+		if (count != 0)
+		{
+			m_file.write(reinterpret_cast<const char*>(batch.data()),
+				static_cast<std::streamsize>(count * sizeof(Event)));
+			m_written.store(m_written.load(std::memory_order_relaxed) + count,
+				std::memory_order_relaxed);
+		}
+	} while (count == batch.size());
+}
+
+void EventLog::Decode(const std::string& path, std::ostream& os)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (file.is_open() == false)
+		throw std::runtime_error("Failed to open event log " + path);
+	Header header;
+	if (file.read(reinterpret_cast<char*>(&header), sizeof(header)).good() == false ||
+		header.magic != Magic)
+		throw std::runtime_error(path + " is not an event log");
+	if (header.version != Version || header.eventSize != sizeof(Event))
+		throw std::runtime_error(path + " was written by an incompatible version");
+	const std::time_t start = static_cast<std::time_t>(header.startNs / 1000000000);
+	os << "Event log " << path << " opened " <<
+		std::put_time(std::localtime(&start), "%Y-%m-%d %H:%M:%S") << '\n';
+	os << std::right << std::setw(14) << "time s" << "  " << std::left <<
+		std::setw(12) << "event" << std::right << std::setw(8) << "flow" <<
+		std::setw(12) << "seq" << std::setw(8) << "bytes" << std::setw(14) << "latency us" << '\n';
+	std::array<uint64_t, static_cast<size_t>(EventType::Dropped) + 1> counts{};
+	uint64_t dropped = 0;
+	bool trailer = false;
+	Event event;
+	while (file.read(reinterpret_cast<char*>(&event), sizeof(event)).good() == true)
+	{
+		if (event.type == EventType::Dropped)
+		{
+			dropped = event.value;
+			trailer = true;
+			continue;
+		}
+		const size_t type = static_cast<size_t>(event.type);
+		if (type < counts.size())
+			++counts[type];
+		os << std::right << std::fixed << std::setprecision(9) << std::setw(14) <<
+			static_cast<double>(event.timeNs) / 1000000000. << "  " << std::left <<
+			std::setw(12) << GetEventName(event.type) << std::right << std::setw(8) <<
+			event.flow << std::setw(12) << event.seq << std::setw(8) << event.bytes;
+		if (event.value != 0)
+			os << std::setprecision(3) << std::setw(14) << static_cast<double>(event.value) / 1000.;
+		os << '\n';
+	}
+	os << "Totals:";
+	for (size_t type = 1; type < static_cast<size_t>(EventType::Dropped); ++type)
+	{
+		if (counts[type] != 0)
+			os << ' ' << GetEventName(static_cast<EventType>(type)) << ' ' << counts[type];
+	}
+	os << '\n';
+	if (trailer == false)
+		os << "The log was not closed, the run may have ended abnormally\n";
+	else if (dropped != 0)
+		os << dropped << " events were dropped because the writer fell behind\n";
+}
\ No newline at end of file
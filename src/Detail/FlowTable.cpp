@@ -0,0 +1,54 @@
+#include <UDPTest/Detail/FlowTable.h>
+
+using UDPTest::Detail::FlowState;
+using UDPTest::Detail::FlowTable;
+
+FlowTable::FlowTable(size_t maxFlows)
+	: m_mask(0), m_size(0), m_maxSize(maxFlows)
+{
+	// keep the load at or under a half so probes stay short
+	size_t buckets = 16;
+	while (buckets < maxFlows * 2)
+		buckets *= 2;
+	m_buckets.resize(buckets);
+	m_mask = buckets - 1;
+}
+
+FlowState* FlowTable::FindOrInsert(const FlowKey& key, bool& inserted) noexcept
+{
+	inserted = false;
+	for (size_t i = Home(key);; i = (i + 1) & m_mask)
+	{
+		FlowState& flow = m_buckets[i];
+		if (flow.key == key)
+			return &flow;
+		if (flow.key.IsEmpty() == true)
+		{
+			if (m_size == m_maxSize)
+				return nullptr;
+			flow = FlowState();
+			flow.key = key;
+			++m_size;
+			inserted = true;
+			return &flow;
+		}
+	}
+}
+
+void FlowTable::Erase(size_t index) noexcept
+{
+	size_t hole = index;
+	for (size_t next = (hole + 1) & m_mask; m_buckets[next].key.IsEmpty() == false; 
+		next = (next + 1) & m_mask)
+	{
+		// a flow can fill the hole if its home isn't between the hole and it
+		const size_t home = Home(m_buckets[next].key);
+		if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+		{
+			m_buckets[hole] = m_buckets[next];
+			hole = next;
+		}
+	}
+	m_buckets[hole].key = FlowKey();
+	--m_size;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include <UDPTest/Detail/Impairment.h>
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+using UDPTest::Detail::ImpairmentConfig;
+using UDPTest::Detail::Impairment;
+
+ImpairmentConfig ImpairmentConfig::Parse(const std::string& spec)
+{
+	ImpairmentConfig config;
+	size_t start = 0;
+	while (start < spec.size())
+	{
+		size_t end = spec.find(',', start);
+		if (end == std::string::npos)
+			end = spec.size();
+		const size_t equals = spec.find('=', start);
+		const std::string item = spec.substr(start, end - start);
+		double value = 0;
+		if (equals >= end ||
+			std::from_chars(spec.data() + equals + 1, spec.data() + end, value).ptr != spec.data() + end ||
+			value < 0)
+			throw std::runtime_error("Expected <impairment>=<non-negative number>, got " + item);
+		const std::string name = spec.substr(start, equals - start);
+		const auto toNs = [](double ms)
+		{
+			return std::chrono::nanoseconds(static_cast<int64_t>(ms * 1e6));
+		};
+		if (name == "delay")
+			config.delay = toNs(value);
+		else if (name == "jitter")
+			config.jitter = toNs(value);
+		else if (name == "loss" || name == "reorder" || name == "duplicate")
+		{
+			if (value > 100)
+				throw std::runtime_error("Impairment chances are percentages, got " + item);
+			(name == "loss" ? config.loss : name == "reorder" ? config.reorder : config.duplicate) = value / 100;
+		}
+		else
+			throw std::runtime_error("Unknown impairment: " + name);
+		start = end + 1;
+	}
+	// without a delay there is nothing to overtake
+	if (config.reorder != 0 && config.delay.count() == 0)
+		throw std::runtime_error("Reordering needs a delay");
+	return config;
+}
+
+std::chrono::nanoseconds Impairment::Delay(bool& reordered) noexcept
+{
+	reordered = Draw(m_config.reorder);
+	if (reordered == true)
+		return std::chrono::nanoseconds(0);
+	if (m_config.jitter.count() == 0)
+		return m_config.delay;
+	const int64_t jitter = std::uniform_int_distribution<int64_t>(
+		-m_config.jitter.count(), m_config.jitter.count())(m_random);
+	return std::chrono::nanoseconds(std::max<int64_t>(m_config.delay.count() + jitter, 0));
+}
\ No newline at end of file
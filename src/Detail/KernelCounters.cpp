@@ -0,0 +1,105 @@
+#include <UDPTest/Detail/KernelCounters.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+uint64_t UDPTest::Detail::GetSocketDrops(asio::ip::udp::socket& socket,
+	asio::error_code& ec) noexcept
+{
+	struct stat status;
+	if (fstat(socket.native_handle(), &status) != 0)
+	{
+		ec = asio::error_code(errno, asio::error::get_system_category());
+		return 0;
+	}
+	std::ifstream table("/proc/net/udp");
+	if (table.is_open() == false)
+	{
+		ec = asio::error::operation_not_supported;
+		return 0;
+	}
+	// sl local rem st tx:rx tr:when retrnsmt uid timeout inode ref pointer drops
+	std::string line;
+	std::getline(table, line);
+	while (std::getline(table, line))
+	{
+		std::istringstream fields(line);
+		std::string field;
+		uint64_t inode = 0;
+		for (int column = 0; column < 9; ++column)
+			fields >> field;
+		if ((fields >> inode) && inode == status.st_ino)
+		{
+			uint64_t drops = 0;
+			fields >> field >> field >> drops;
+			ec = asio::error_code();
+			return drops;
+		}
+	}
+	ec = asio::error::not_found;
+	return 0;
+}
+
+UDPTest::Detail::UdpCounters UDPTest::Detail::GetUdpCounters(asio::error_code& ec) noexcept
+{
+	UdpCounters counters;
+	std::ifstream snmp("/proc/net/snmp");
+	// the names come on one "Udp:" line and the values on the next
+	std::string names;
+	std::string values;
+	std::string line;
+	while (std::getline(snmp, line))
+	{
+		if (line.compare(0, 5, "Udp: ") != 0)
+			continue;
+		if (names.empty() == true)
+			names = line;
+		else
+		{
+			values = line;
+			break;
+		}
+	}
+	if (values.empty() == true)
+	{
+		ec = asio::error::operation_not_supported;
+		return counters;
+	}
+	std::istringstream nameFields(names);
+	std::istringstream valueFields(values);
+	std::string name;
+	uint64_t value;
+	nameFields >> name;
+	valueFields >> name;
+	while ((nameFields >> name) && (valueFields >> value))
+	{
+		if (name == "InErrors")
+			counters.inErrors = value;
+		else if (name == "RcvbufErrors")
+			counters.rcvbufErrors = value;
+		else if (name == "SndbufErrors")
+			counters.sndbufErrors = value;
+	}
+	ec = asio::error_code();
+	return counters;
+}
+#else
+uint64_t UDPTest::Detail::GetSocketDrops(asio::ip::udp::socket&,
+	asio::error_code& ec) noexcept
+{
+	ec = asio::error::operation_not_supported;
+	return 0;
+}
+
+UDPTest::Detail::UdpCounters UDPTest::Detail::GetUdpCounters(asio::error_code& ec) noexcept
+{
+	ec = asio::error::operation_not_supported;
+	return UdpCounters();
+}
+#endif
\ No newline at end of file
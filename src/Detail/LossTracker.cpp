@@ -0,0 +1,105 @@
+#include <UDPTest/Detail/LossTracker.h>
+
+using UDPTest::Detail::LossTracker;
+
+LossTracker::LossTracker(size_t window)
+	: m_bitmap((window + 63) / 64), m_window(static_cast<uint32_t>(m_bitmap.size() * 64)),
+	m_episodes(EpisodeHistory)
+{
+	Reset(0);
+}
+
+void LossTracker::Reset(uint64_t firstSeq) noexcept
+{
+	std::fill(m_bitmap.begin(), m_bitmap.end(), 0);
+	m_nextSeq = firstSeq;
+	m_finalized = 0;
+	m_lost = 0;
+	m_lostAfterLost = 0;
+	m_lostLostLost = 0;
+	m_lostReceivedLost = 0;
+	m_history = 0;
+	m_inBurst = false;
+	m_runLength = 0;
+	m_bursts.Reset();
+	m_gaps.Reset();
+	m_episodeHead = 0;
+}
+
+void LossTracker::Finalize(int64_t sentNs) noexcept
+{
+	uint64_t& word = m_bitmap[(m_nextSeq % m_window) / 64];
+	const uint64_t bit = uint64_t(1) << (m_nextSeq % 64);
+	const bool lost = (word & bit) == 0;
+	// the bit is reused by the seq a window ahead
+	word &= ~bit;
+	if (lost == true)
+	{
+		++m_lost;
+		if (m_finalized >= 1 && (m_history & 1) != 0)
+			++m_lostAfterLost;
+		if (m_finalized >= 2 && (m_history & 3) == 3)
+			++m_lostLostLost;
+		if (m_finalized >= 2 && (m_history & 3) == 2)
+			++m_lostReceivedLost;
+	}
+	m_history = ((m_history << 1) | (lost ? 1 : 0)) & 3;
+	++m_finalized;
+	// extend the current run or close it and start the other kind
+	if (lost == m_inBurst && m_runLength != 0)
+		++m_runLength;
+	else
+	{
+		if (m_runLength != 0)
+			(m_inBurst ? m_bursts : m_gaps).Record(m_runLength);
+		m_inBurst = lost;
+		m_runLength = 1;
+		if (lost == true)
+		{
+			m_episodes[m_episodeHead] = Episode{ sentNs, m_nextSeq, 0 };
+			m_episodeHead = (m_episodeHead + 1) % m_episodes.size();
+		}
+	}
+	if (lost == true)
+		m_episodes[(m_episodeHead + m_episodes.size() - 1) % m_episodes.size()].length = m_runLength;
+	++m_nextSeq;
+}
+
+void LossTracker::Close() noexcept
+{
+	if (m_runLength != 0)
+		(m_inBurst ? m_bursts : m_gaps).Record(m_runLength);
+	m_runLength = 0;
+}
+
+LossTracker::GilbertElliott LossTracker::Fit() const noexcept
+{
+	GilbertElliott model{ 0., 0., 0., false };
+	if (m_lost == 0 || m_lost == m_finalized)
+		return model;
+	// Gilbert's estimates from the loss rate, P(1|1) and P(1 | 1?1)
+	const double a = static_cast<double>(m_lost) / m_finalized;
+	const double b = static_cast<double>(m_lostAfterLost) / m_lost;
+	if (m_lostLostLost + m_lostReceivedLost != 0)
+	{
+		const double c = static_cast<double>(m_lostLostLost) / 
+			(m_lostLostLost + m_lostReceivedLost);
+		const double denominator = 2 * a * c - b * (a + c);
+		if (denominator != 0.)
+		{
+			model.r = 1. - (a * c - b * b) / denominator;
+			model.h = 1. - b / (1. - model.r);
+			model.p = a * model.r / (1. - model.h - a);
+			model.fitted = model.r > 0. && model.r <= 1. && 
+				model.h >= 0. && model.h < 1. && model.p > 0. && model.p <= 1.;
+			if (model.fitted == true)
+				return model;
+		}
+	}
+	// fall back to the two-state model where the bad state loses everything
+	model.p = static_cast<double>(m_lost - m_lostAfterLost) / (m_finalized - m_lost);
+	model.r = 1. - b;
+	model.h = 0.;
+	model.fitted = false;
+	return model;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <UDPTest/Detail/MappedFile.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using UDPTest::Detail::MappedFile;
+
+MappedFile::MappedFile(const std::string& path)
+	: m_data(nullptr), m_size(0)
+{
+#ifdef _WIN32
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+		throw ErrorCode_t(static_cast<int>(GetLastError()), asio::error::get_system_category());
+	LARGE_INTEGER size;
+	GetFileSizeEx(m_file, &size);
+	m_size = static_cast<size_t>(size.QuadPart);
+	m_mapping = nullptr;
+	if (m_size == 0)
+		return;
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr ||
+		(m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0))) == nullptr)
+	{
+		const ErrorCode_t ec(static_cast<int>(GetLastError()), asio::error::get_system_category());
+		if (m_mapping != nullptr)
+			CloseHandle(m_mapping);
+		CloseHandle(m_file);
+		throw ec;
+	}
+#else
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw ErrorCode_t(errno, asio::error::get_system_category());
+	struct stat info;
+	if (fstat(fd, &info) == -1)
+	{
+		const ErrorCode_t ec(errno, asio::error::get_system_category());
+		close(fd);
+		throw ec;
+	}
+	m_size = static_cast<size_t>(info.st_size);
+	if (m_size == 0)
+	{
+		close(fd);
+		return;
+	}
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		throw ErrorCode_t(errno, asio::error::get_system_category());
+	// read ahead aggressively and let pages behind us go
+	madvise(data, m_size, MADV_SEQUENTIAL);
+	m_data = static_cast<const char*>(data);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+	CloseHandle(m_file);
+#else
+	if (m_data != nullptr)
+		munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <UDPTest/Detail/MetricsSegment.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using UDPTest::Detail::MetricsSegment;
+
+namespace
+{
+	/// @brief Gets the error code of the last failed system call
+	asio::error_code LastError() noexcept
+	{
+#ifdef _WIN32
+		return asio::error_code(static_cast<int>(GetLastError()), asio::error::get_system_category());
+#else
+		return asio::error_code(errno, asio::error::get_system_category());
+#endif
+	}
+
+	/// @brief Gets the platform name of a segment
+	std::string GetSegmentName(const std::string& name)
+	{
+#ifdef _WIN32
+		return "Local\\" + name;
+#else
+		return (name.empty() == false && name.front() == '/') ? name : '/' + name;
+#endif
+	}
+}
+
+MetricsSegment::MetricsSegment(const std::string& name, Role role)
+	: m_name(GetSegmentName(name)), m_owner(true), m_memory(nullptr)
+{
+	Map(true);
+	// start from a clean slate in case a crashed publisher left one behind
+	std::memset(m_memory, 0, SegmentSize);
+	Header& header = GetHeader();
+	header.version = Version;
+	header.slotCount = SlotCount;
+	header.slotSize = sizeof(Slot);
+	header.role = static_cast<uint32_t>(role);
+#ifdef _WIN32
+	header.pid = GetCurrentProcessId();
+#else
+	header.pid = static_cast<uint64_t>(getpid());
+#endif
+	// readers check the magic last
+	std::atomic_thread_fence(std::memory_order_release);
+	header.magic = Magic;
+}
+
+MetricsSegment::MetricsSegment(const std::string& name)
+	: m_name(GetSegmentName(name)), m_owner(false), m_memory(nullptr)
+{
+	Map(false);
+	const Header& header = GetHeader();
+	if (header.magic != Magic ||
+		header.version != Version ||
+		header.slotCount != SlotCount ||
+		header.slotSize != sizeof(Slot))
+	{
+		throw std::runtime_error("Metrics segment " + name + 
+			" has an unsupported version " + std::to_string(header.version));
+	}
+}
+
+MetricsSegment::~MetricsSegment()
+{
+	if (m_memory == nullptr)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(m_memory);
+	CloseHandle(m_mapping);
+#else
+	munmap(m_memory, SegmentSize);
+	if (m_owner == true)
+		shm_unlink(m_name.c_str());
+#endif
+}
+
+MetricsSegment::Role MetricsSegment::GetRole() const noexcept
+{
+	return static_cast<Role>(GetHeader().role);
+}
+
+uint64_t MetricsSegment::GetPid() const noexcept
+{
+	return GetHeader().pid;
+}
+
+uint32_t MetricsSegment::AcquireSlot(const std::string& name) noexcept
+{
+	for (uint32_t i = 0; i < SlotCount; ++i)
+	{
+		Slot& slot = GetSlot(i);
+		if (slot.inUse.load(std::memory_order_relaxed) != 0)
+			continue;
+		BeginWrite(slot);
+		const size_t nameSize = std::min<size_t>(name.size(), NameSize - 1);
+		for (size_t j = 0; j < NameSize; ++j)
+			slot.name[j].store((j < nameSize) ? name[j] : '\0', std::memory_order_relaxed);
+		for (auto& counter : slot.counters)
+			counter.store(0, std::memory_order_relaxed);
+		for (auto& bucket : slot.latencyBuckets)
+			bucket.store(0, std::memory_order_relaxed);
+		slot.inUse.store(1, std::memory_order_relaxed);
+		EndWrite(slot);
+		return i;
+	}
+	return SlotCount;
+}
+
+void MetricsSegment::ReleaseSlot(uint32_t slot) noexcept
+{
+	Slot& releasedSlot = GetSlot(slot);
+	BeginWrite(releasedSlot);
+	releasedSlot.inUse.store(0, std::memory_order_relaxed);
+	EndWrite(releasedSlot);
+}
+
+void MetricsSegment::WriteSlot(uint32_t slot, 
+	const std::array<uint64_t, CounterCount>& counters,
+	const Histogram& latency) noexcept
+{
+	Slot& writtenSlot = GetSlot(slot);
+	BeginWrite(writtenSlot);
+	for (uint32_t i = 0; i < CounterCount; ++i)
+		writtenSlot.counters[i].store(counters[i], std::memory_order_relaxed);
+	for (uint32_t i = 0; i < Histogram::BucketCount; ++i)
+		writtenSlot.latencyBuckets[i].store(latency.GetBucketCount(i), std::memory_order_relaxed);
+	EndWrite(writtenSlot);
+}
+
+std::vector<MetricsSegment::SlotSnapshot> MetricsSegment::ReadSlots() const
+{
+	std::vector<SlotSnapshot> snapshots;
+	for (uint32_t i = 0; i < SlotCount; ++i)
+	{
+		const Slot& slot = GetSlot(i);
+		SlotSnapshot snapshot;
+		bool inUse = false;
+		bool consistent = false;
+		for (uint32_t attempt = 0; attempt < ReadAttempts && consistent == false; ++attempt)
+		{
+			// an odd sequence means the writer is in the middle of an update
+			const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+			if ((before & 1) != 0)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			inUse = (slot.inUse.load(std::memory_order_relaxed) != 0);
+			snapshot.name.clear();
+			for (const auto& c : slot.name)
+			{
+				const char value = c.load(std::memory_order_relaxed);
+				if (value == '\0')
+					break;
+				snapshot.name.push_back(value);
+			}
+			for (uint32_t j = 0; j < CounterCount; ++j)
+				snapshot.counters[j] = slot.counters[j].load(std::memory_order_relaxed);
+			snapshot.latency.Reset();
+			for (uint32_t j = 0; j < Histogram::BucketCount; ++j)
+				snapshot.latency.AddToBucket(j, slot.latencyBuckets[j].load(std::memory_order_relaxed));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			consistent = (slot.sequence.load(std::memory_order_relaxed) == before);
+		}
+		if (consistent == true && inUse == true)
+			snapshots.push_back(std::move(snapshot));
+	}
+	return snapshots;
+}
+
+void MetricsSegment::Map(bool create)
+{
+#ifdef _WIN32
+	if (create == true)
+	{
+		m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+			0, static_cast<DWORD>(SegmentSize), m_name.c_str());
+	}
+	else
+		m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, m_name.c_str());
+	if (m_mapping == nullptr)
+		throw LastError();
+	m_memory = MapViewOfFile(m_mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ,
+		0, 0, SegmentSize);
+	if (m_memory == nullptr)
+	{
+		const auto ec = LastError();
+		CloseHandle(m_mapping);
+		throw ec;
+	}
+#else
+	const int fd = create ? 
+		shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0644) :
+		shm_open(m_name.c_str(), O_RDONLY, 0);
+	if (fd == -1)
+		throw LastError();
+	struct stat info;
+	if ((create == true && ftruncate(fd, SegmentSize) == -1) ||
+		(create == false && fstat(fd, &info) == -1))
+	{
+		const auto ec = LastError();
+		close(fd);
+		throw ec;
+	}
+	// a segment of another layout could be smaller than ours
+	if (create == false && static_cast<size_t>(info.st_size) < SegmentSize)
+	{
+		close(fd);
+		throw asio::error_code(asio::error::message_size);
+	}
+	void* memory = mmap(nullptr, SegmentSize, create ? 
+		PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED)
+		throw LastError();
+	m_memory = memory;
+#endif
+}
+
+void MetricsSegment::BeginWrite(Slot& slot) noexcept
+{
+	slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, 
+		std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void MetricsSegment::EndWrite(Slot& slot) noexcept
+{
+	slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1,
+		std::memory_order_release);
+}
\ No newline at end of file
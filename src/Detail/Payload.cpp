@@ -0,0 +1,161 @@
+#include <UDPTest/Detail/Payload.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define UDPTEST_PAYLOAD_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	using FillFunction_t = void(*)(uint8_t*, size_t, uint32_t, uint32_t);
+
+	/// @brief The Weyl increment between the counters of adjacent words
+	constexpr uint32_t WordStep = 0x9E3779B9;
+
+	/// @brief A 32-bit finalizer with full avalanche, two multiplies per word
+	inline uint32_t Mix(uint32_t x) noexcept
+	{
+		x ^= x >> 16;
+		x *= 0x7FEB352D;
+		x ^= x >> 15;
+		x *= 0x846CA68B;
+		x ^= x >> 16;
+		return x;
+	}
+
+	inline uint32_t PacketKey(uint32_t seed, uint32_t seq) noexcept
+	{
+		return Mix(seed ^ Mix(seq + WordStep));
+	}
+
+	/// @brief Writes whole or partial words, little-endian on every host
+	void FillScalar(uint8_t* out, size_t size, uint32_t key, uint32_t word) noexcept
+	{
+		uint32_t counter = key + word * WordStep;
+		for (; size >= 4; size -= 4, out += 4, counter += WordStep)
+		{
+			const uint32_t value = Mix(counter);
+			out[0] = static_cast<uint8_t>(value);
+			out[1] = static_cast<uint8_t>(value >> 8);
+			out[2] = static_cast<uint8_t>(value >> 16);
+			out[3] = static_cast<uint8_t>(value >> 24);
+		}
+		const uint32_t value = Mix(counter);
+		for (size_t i = 0; i < size; ++i)
+			out[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+
+#ifdef UDPTEST_PAYLOAD_SIMD
+#ifndef _MSC_VER
+	__attribute__((target("sse4.1")))
+#endif
+	void FillSSE41(uint8_t* out, size_t size, uint32_t key, uint32_t word) noexcept
+	{
+		const uint32_t first = key + word * WordStep;
+		__m128i counter = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first)),
+			_mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(WordStep))));
+		const __m128i step = _mm_set1_epi32(static_cast<int>(4 * WordStep));
+		const __m128i m1 = _mm_set1_epi32(0x7FEB352D);
+		const __m128i m2 = _mm_set1_epi32(static_cast<int>(0x846CA68B));
+		size_t done = 0;
+		for (; size - done >= 16; done += 16)
+		{
+			__m128i x = counter;
+			x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+			x = _mm_mullo_epi32(x, m1);
+			x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+			x = _mm_mullo_epi32(x, m2);
+			x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + done), x);
+			counter = _mm_add_epi32(counter, step);
+		}
+		FillScalar(out + done, size - done, key, word + static_cast<uint32_t>(done / 4));
+	}
+
+#ifndef _MSC_VER
+	__attribute__((target("avx2")))
+#endif
+	void FillAVX2(uint8_t* out, size_t size, uint32_t key, uint32_t word) noexcept
+	{
+		const uint32_t first = key + word * WordStep;
+		__m256i counter = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)),
+			_mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+				_mm256_set1_epi32(static_cast<int>(WordStep))));
+		const __m256i step = _mm256_set1_epi32(static_cast<int>(8 * WordStep));
+		const __m256i m1 = _mm256_set1_epi32(0x7FEB352D);
+		const __m256i m2 = _mm256_set1_epi32(static_cast<int>(0x846CA68B));
+		size_t done = 0;
+		for (; size - done >= 32; done += 32)
+		{
+			__m256i x = counter;
+			x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+			x = _mm256_mullo_epi32(x, m1);
+			x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+			x = _mm256_mullo_epi32(x, m2);
+			x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + done), x);
+			counter = _mm256_add_epi32(counter, step);
+		}
+		FillScalar(out + done, size - done, key, word + static_cast<uint32_t>(done / 4));
+	}
+#endif
+
+	FillFunction_t SelectFill() noexcept
+	{
+#if defined(UDPTEST_PAYLOAD_SIMD) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+		__cpuid(info, 1);
+		const bool sse41 = (info[2] & (1 << 19)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		if (maxLeaf >= 7 && osxsave == true &&
+			(_xgetbv(0) & 0x6) == 0x6)
+		{
+			__cpuidex(info, 7, 0);
+			if ((info[1] & (1 << 5)) != 0)
+				return FillAVX2;
+		}
+		if (sse41 == true)
+			return FillSSE41;
+#elif defined(UDPTEST_PAYLOAD_SIMD)
+		if (__builtin_cpu_supports("avx2"))
+			return FillAVX2;
+		if (__builtin_cpu_supports("sse4.1"))
+			return FillSSE41;
+#endif
+		return FillScalar;
+	}
+
+	const FillFunction_t fillFunction = SelectFill();
+}
+
+void UDPTest::Detail::FillPayload(void* data, size_t size, uint32_t seed, uint32_t seq) noexcept
+{
+	fillFunction(static_cast<uint8_t*>(data), size, PacketKey(seed, seq), 0);
+}
+
+bool UDPTest::Detail::CheckPayload(const void* data, size_t size, uint32_t seed,
+	uint32_t seq, size_t offset) noexcept
+{
+	// regenerate a chunk at a time so the expected bytes stay in L1
+	constexpr size_t ChunkSize = 1024;
+	alignas(32) uint8_t expected[ChunkSize];
+	const uint32_t key = PacketKey(seed, seq);
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t done = offset; done < size; done += ChunkSize)
+	{
+		const size_t chunk = std::min(ChunkSize, size - done);
+		fillFunction(expected, chunk, key, static_cast<uint32_t>(done / 4));
+		if (std::memcmp(expected, bytes + done, chunk) != 0)
+			return false;
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include <UDPTest/Detail/ReceiveTracker.h>
+
+#include <UDPTest/Detail/Transport.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+using UDPTest::Detail::ReceiveTracker;
+
+ReceiveTracker::ReceiveTracker() noexcept
+	: m_seqSeen(false), m_firstSeq(0), m_highestSeq(0), m_received(0), m_corrupted(0),
+	m_transitSeen(false), m_lastTransitNs(0), m_jitterNs(0)
+{
+}
+
+void ReceiveTracker::OnPacket(uint32_t seq) noexcept
+{
+	if (m_seqSeen == false)
+	{
+		m_seqSeen = true;
+		m_firstSeq = seq;
+		m_highestSeq = seq;
+	}
+	else
+		m_highestSeq = std::max(m_highestSeq, RandomPacket::ExtendSeq(seq, m_highestSeq));
+	++m_received;
+}
+
+void ReceiveTracker::OnTransit(uint64_t sentNs, Duration_t now) noexcept
+{
+	const int64_t transitNs = static_cast<int64_t>(now.count()) - static_cast<int64_t>(sentNs);
+	if (m_transitSeen == true)
+	{
+		// J += (|D| - J) / 16, as RFC 3550 smooths it
+		const double difference = static_cast<double>(std::abs(transitNs - m_lastTransitNs));
+		m_jitterNs += (difference - m_jitterNs) / 16;
+	}
+	m_transitSeen = true;
+	m_lastTransitNs = transitNs;
+}
+
+void ReceiveTracker::ResetJitter() noexcept
+{
+	m_transitSeen = false;
+	m_jitterNs = 0;
+}
\ No newline at end of file
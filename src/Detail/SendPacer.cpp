@@ -0,0 +1,54 @@
+#include <UDPTest/Detail/SendPacer.h>
+
+#include <stdexcept>
+
+using UDPTest::Detail::SendPacer;
+
+SendPacer::SendPacer(CatchUpPolicy policy, size_t maxBacklog)
+	: m_policy(policy), m_model(nullptr), m_meanGap(0), m_due(0), m_slotSize(0),
+	m_slotPeeked(false), m_peekedGap(0), m_peekedSize(0), m_backlog(maxBacklog),
+	m_backlogHead(0), m_backlogCount(0), m_stalled(false), m_late(0),
+	m_skipped(0)
+{
+}
+
+bool SendPacer::Begin(TrafficModel& model, Duration_t now, Duration_t meanGap) noexcept
+{
+	m_model = &model;
+	m_meanGap = meanGap;
+	m_due = now;
+	m_slotPeeked = false;
+	m_backlogHead = 0;
+	m_backlogCount = 0;
+	m_stalled = false;
+	m_late = 0;
+	m_skipped = 0;
+	Duration_t ignored;
+	return m_model->Next(ignored, m_slotSize);
+}
+
+bool SendPacer::Advance() noexcept
+{
+	Duration_t gap;
+	if (m_slotPeeked == true)
+	{
+		m_slotPeeked = false;
+		gap = m_peekedGap;
+		m_slotSize = m_peekedSize;
+	}
+	else if (m_model->Next(gap, m_slotSize) == false)
+		return false;
+	m_due += gap;
+	return true;
+}
+
+SendPacer::CatchUpPolicy SendPacer::ParsePolicy(const std::string& policy)
+{
+	if (policy == "burst")
+		return CatchUpPolicy::Burst;
+	if (policy == "drop")
+		return CatchUpPolicy::Drop;
+	if (policy == "stretch")
+		return CatchUpPolicy::Stretch;
+	throw std::runtime_error("Unknown catch-up policy: " + policy);
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <UDPTest/Detail/SimNetwork.h>
+
+using UDPTest::Detail::SimNetwork;
+
+SimNetwork::SimNetwork(const ImpairmentConfig& toServer, const ImpairmentConfig& toClient,
+	double corrupt, uint64_t seed) noexcept
+	: m_paths{ Path{ Impairment(toServer, seed), PathStats() },
+		Path{ Impairment(toClient, seed ^ 0x9E3779B97F4A7C15), PathStats() } },
+	m_corrupt(corrupt), m_random(seed ^ 0xC2B2AE3D27D4EB4F), m_now(0)
+{
+}
+
+void SimNetwork::Send(Side from, const uint8_t* data, size_t size, uint64_t tag) noexcept
+{
+	Path& path = m_paths[static_cast<size_t>(from)];
+	++path.stats.sent;
+	if (path.impairment.Drop() == true)
+	{
+		++path.stats.dropped;
+		return;
+	}
+	const int copies = (path.impairment.Duplicate() == true) ? 2 : 1;
+	if (copies == 2)
+		++path.stats.duplicated;
+	for (int i = 0; i < copies; ++i)
+	{
+		uint32_t buffer;
+		if (m_freeBuffers.empty() == false)
+		{
+			buffer = m_freeBuffers.back();
+			m_freeBuffers.pop_back();
+		}
+		else
+		{
+			buffer = static_cast<uint32_t>(m_buffers.size());
+			m_buffers.emplace_back();
+		}
+		m_buffers[buffer].assign(data, data + size);
+		// every copy is corrupted apart, so a duplicate can arrive intact
+		bool corrupted = false;
+		if (from == Side::Client && m_corrupt != 0 && size != 0 &&
+			std::uniform_real_distribution<double>()(m_random) < m_corrupt)
+		{
+			corrupted = true;
+			m_buffers[buffer][size - 1] ^= 0xFF;
+			++path.stats.corrupted;
+		}
+		// every copy draws its own delay, rounded up so none arrives early
+		bool reordered = false;
+		const Duration_t due = m_now + path.impairment.Delay(reordered);
+		if (reordered == true)
+			++path.stats.reordered;
+		m_inFlight.Schedule(static_cast<uint64_t>((due + Tick - Duration_t(1)) / Tick),
+			Datagram{ (from == Side::Client) ? Side::Server : Side::Client,
+				buffer, static_cast<uint32_t>(size), tag, corrupted });
+	}
+}
@@ -0,0 +1,62 @@
+#include <UDPTest/Detail/SoakRecorder.h>
+
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using UDPTest::Detail::SoakRecorder;
+using UDPTest::Detail::SoakWindow;
+
+SoakRecorder::SoakRecorder(const std::string& path, size_t maxFileSize, size_t maxFiles)
+	: m_elapsed(0)
+{
+	try
+	{
+		m_logger = std::make_shared<spdlog::logger>("soak",
+			std::make_shared<spdlog::sinks::rotating_file_sink_mt>(path, maxFileSize, maxFiles));
+	}
+	catch (const spdlog::spdlog_ex& ex)
+	{
+		throw std::runtime_error("Failed to open soak log " + path + ": " + ex.what());
+	}
+	// each record is a complete line, so a test that dies loses at most one
+	m_logger->set_pattern("{\"time\":\"%Y-%m-%dT%H:%M:%S.%eZ\",%v}", spdlog::pattern_time_type::utc);
+	m_logger->set_level(spdlog::level::info);
+	m_logger->flush_on(spdlog::level::info);
+}
+
+void SoakRecorder::AddSecond(const SoakWindow& second) noexcept
+{
+	m_seconds[m_elapsed % SecondsPerMinute] = second;
+	m_minute.Merge(second);
+	++m_elapsed;
+	Write("1s", second, 1);
+	// summing the rings again is cheaper than a second's traffic, and
+	// keeps nothing that would have to be subtracted back out
+	SoakWindow window;
+	for (const SoakWindow& slot : m_seconds)
+		window.Merge(slot);
+	Write("1m", window, std::min<uint64_t>(m_elapsed, SecondsPerMinute));
+	if (m_elapsed % SecondsPerMinute != 0)
+		return;
+	const uint64_t minutes = m_elapsed / SecondsPerMinute;
+	m_minutes[(minutes - 1) % MinutesPerHour] = m_minute;
+	m_minute.Reset();
+	window.Reset();
+	for (const SoakWindow& slot : m_minutes)
+		window.Merge(slot);
+	Write("1h", window, std::min<uint64_t>(minutes, MinutesPerHour) * SecondsPerMinute);
+}
+
+void SoakRecorder::Write(const char* name, const SoakWindow& window, uint64_t seconds) noexcept
+{
+	m_logger->info("\"window\":\"{}\",\"seconds\":{},\"sent\":{},\"received\":{},\"lost\":{},"
+		"\"corrupted\":{},\"loss_percent\":{:.4f},\"bits_per_second\":{},"
+		"\"latency_ns\":{{\"p50\":{},\"p90\":{},\"p99\":{},\"p999\":{},\"max\":{}}}",
+		name, seconds, window.sent, window.received, window.lost, window.corrupted,
+		(window.sent != 0) ? static_cast<double>(window.lost) / window.sent * 100 : 0.,
+		window.bytes * 8 / seconds, window.latency.GetPercentile(50),
+		window.latency.GetPercentile(90), window.latency.GetPercentile(99),
+		window.latency.GetPercentile(99.9), window.latency.GetMax());
+}
\ No newline at end of file
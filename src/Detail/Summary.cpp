@@ -0,0 +1,46 @@
+#include <UDPTest/Detail/Summary.h>
+
+#include <array>
+#include <cmath>
+
+using UDPTest::Detail::Summary;
+
+Summary Summary::Of(const std::vector<double>& samples) noexcept
+{
+	Summary summary;
+	summary.count = samples.size();
+	if (samples.empty() == true)
+		return summary;
+	for (const double sample : samples)
+		summary.mean += sample;
+	summary.mean /= static_cast<double>(samples.size());
+	if (samples.size() < 2)
+		return summary;
+	double squares = 0;
+	for (const double sample : samples)
+		squares += (sample - summary.mean) * (sample - summary.mean);
+	summary.stddev = std::sqrt(squares / static_cast<double>(samples.size() - 1));
+	summary.confidence = GetStudentT95(samples.size() - 1) * summary.stddev /
+		std::sqrt(static_cast<double>(samples.size()));
+	return summary;
+}
+
+double Summary::GetStudentT95(size_t degreesOfFreedom) noexcept
+{
+	static constexpr std::array<double, 30> table =
+	{
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+	};
+	if (degreesOfFreedom <= table.size())
+		return table[degreesOfFreedom - 1];
+	// between rows, round down the degrees of freedom to stay conservative
+	if (degreesOfFreedom < 40)
+		return table.back();
+	if (degreesOfFreedom < 60)
+		return 2.021;
+	if (degreesOfFreedom < 120)
+		return 2.000;
+	return 1.980;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <UDPTest/Detail/TrafficClass.h>
+
+#include <charconv>
+#include <stdexcept>
+
+using UDPTest::Detail::TrafficClass;
+
+std::vector<TrafficClass> TrafficClass::ParseList(const std::string& classes,
+	const TrafficClass& defaults)
+{
+	const auto parseNumber = [](const std::string& item, const std::string& value, uint32_t max)
+	{
+		uint32_t number = 0;
+		auto res = std::from_chars(value.data(), value.data() + value.size(), number, 10);
+		if (res.ec != std::errc() || res.ptr != value.data() + value.size() || number > max)
+			throw std::runtime_error("Expected a number up to " + std::to_string(max) + " in class setting " + item);
+		return number;
+	};
+	std::vector<TrafficClass> list;
+	size_t start = 0;
+	while (start < classes.size())
+	{
+		size_t end = classes.find(',', start);
+		if (end == std::string::npos)
+			end = classes.size();
+		const std::string entry = classes.substr(start, end - start);
+		start = end + 1;
+		const size_t colon = entry.find(':');
+		if (colon == 0 || colon == std::string::npos)
+			throw std::runtime_error("Expected <name>:<settings> in class " + entry);
+		TrafficClass trafficClass = defaults;
+		trafficClass.name = entry.substr(0, colon);
+		for (const TrafficClass& other : list)
+		{
+			if (other.name == trafficClass.name)
+				throw std::runtime_error("Two classes are named " + trafficClass.name);
+		}
+		size_t itemStart = colon + 1;
+		while (itemStart < entry.size())
+		{
+			size_t itemEnd = entry.find('/', itemStart);
+			if (itemEnd == std::string::npos)
+				itemEnd = entry.size();
+			const size_t equals = entry.find('=', itemStart);
+			if (equals >= itemEnd)
+				throw std::runtime_error("Expected <setting>=<value> in class " + entry);
+			const std::string name = entry.substr(itemStart, equals - itemStart);
+			// a trace's path may hold slashes of its own
+			if (name == "shape" && entry.compare(equals + 1, 6, "trace:") == 0)
+				itemEnd = entry.size();
+			const std::string item = entry.substr(itemStart, itemEnd - itemStart);
+			const std::string value = entry.substr(equals + 1, itemEnd - equals - 1);
+			if (name == "dscp")
+				trafficClass.tos = static_cast<uint8_t>(ParseDscp(value) << 2);
+			else if (name == "priority")
+				trafficClass.priority = static_cast<uint8_t>(parseNumber(item, value, 255));
+			else if (name == "bitrate")
+				trafficClass.bitRate = value;
+			else if (name == "rate")
+				trafficClass.packetRate = parseNumber(item, value, UINT32_MAX);
+			else if (name == "size")
+				trafficClass.sizes = value;
+			else if (name == "shape")
+				trafficClass.shape = value;
+			else
+				throw std::runtime_error("Unknown class setting: " + name);
+			itemStart = itemEnd + 1;
+		}
+		if (trafficClass.packetRate == 0)
+			throw std::runtime_error("Class " + trafficClass.name + " needs a nonzero packet rate");
+		list.push_back(trafficClass);
+	}
+	if (list.empty() == true)
+		throw std::runtime_error("No classes in " + classes);
+	return list;
+}
+
+uint8_t TrafficClass::ParseDscp(const std::string& dscp)
+{
+	if (dscp == "be")
+		return 0;
+	if (dscp == "ef")
+		return 46;
+	// class selectors keep the precedence in the top three bits, assured
+	// forwarding adds the drop precedence below it
+	if (dscp.size() == 3 && dscp.compare(0, 2, "cs") == 0 && dscp[2] >= '0' && dscp[2] <= '7')
+		return static_cast<uint8_t>((dscp[2] - '0') << 3);
+	if (dscp.size() == 4 && dscp.compare(0, 2, "af") == 0 &&
+		dscp[2] >= '1' && dscp[2] <= '4' && dscp[3] >= '1' && dscp[3] <= '3')
+		return static_cast<uint8_t>(((dscp[2] - '0') << 3) | ((dscp[3] - '0') << 1));
+	uint32_t value = 0;
+	auto res = std::from_chars(dscp.data(), dscp.data() + dscp.size(), value, 10);
+	if (res.ec != std::errc() || res.ptr != dscp.data() + dscp.size() || value > 63)
+		throw std::runtime_error("Expected a DSCP from 0 to 63, be, ef, cs<0-7> or af<1-4><1-3>, got " + dscp);
+	return static_cast<uint8_t>(value);
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <UDPTest/Detail/TrafficModel.h>
+
+#include <UDPTest/Detail/Transport.h>
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+using UDPTest::Detail::TrafficModel;
+using UDPTest::Detail::ConstantModel;
+using UDPTest::Detail::PoissonModel;
+using UDPTest::Detail::OnOffModel;
+using UDPTest::Detail::TraceModel;
+
+void TrafficModel::SetPayloadSizes(uint32_t minSize, uint32_t maxSize) noexcept
+{
+	m_minSize = minSize;
+	m_maxSize = maxSize;
+}
+
+std::unique_ptr<TrafficModel> TrafficModel::Create(const std::string& shape,
+	Duration_t gap, uint32_t minSize, uint32_t maxSize)
+{
+	std::unique_ptr<TrafficModel> model;
+	if (shape == "cbr")
+		model = std::make_unique<ConstantModel>(gap);
+	else if (shape == "poisson")
+		model = std::make_unique<PoissonModel>(gap);
+	else if (shape.compare(0, 6, "onoff:") == 0)
+	{
+		uint32_t burstLength = 0;
+		uint32_t offMs = 0;
+		const char* const end = shape.data() + shape.size();
+		auto res = std::from_chars(shape.data() + 6, end, burstLength, 10);
+		if (res.ec != std::errc() || res.ptr == end || *res.ptr != ':' ||
+			(res = std::from_chars(res.ptr + 1, end, offMs, 10)).ec != std::errc() ||
+			res.ptr != end || burstLength == 0)
+			throw std::runtime_error("Expected onoff:<burst packets>:<off ms>, got " + shape);
+		model = std::make_unique<OnOffModel>(gap, burstLength, std::chrono::milliseconds(offMs));
+	}
+	else if (shape.compare(0, 6, "trace:") == 0)
+		model = std::make_unique<TraceModel>(shape.substr(6));
+	else
+		throw std::runtime_error("Unknown traffic shape: " + shape);
+	model->SetPayloadSizes(minSize, maxSize);
+	return model;
+}
+
+uint32_t TrafficModel::NextPayloadSize() noexcept
+{
+	if (m_minSize == m_maxSize)
+		return m_minSize;
+	return std::uniform_int_distribution<uint32_t>(m_minSize, m_maxSize)(m_random);
+}
+
+bool ConstantModel::Next(Duration_t& gap, uint32_t& payloadSize) noexcept
+{
+	gap = m_gap;
+	payloadSize = NextPayloadSize();
+	return true;
+}
+
+bool PoissonModel::Next(Duration_t& gap, uint32_t& payloadSize) noexcept
+{
+	gap = Duration_t(static_cast<Duration_t::rep>(m_distribution(m_random)));
+	payloadSize = NextPayloadSize();
+	return true;
+}
+
+bool OnOffModel::Next(Duration_t& gap, uint32_t& payloadSize) noexcept
+{
+	// the first packet of every burst waits out the silence
+	gap = (m_sentInBurst == 0) ? m_gap + m_offTime : m_gap;
+	m_sentInBurst = (m_sentInBurst + 1) % m_burstLength;
+	payloadSize = NextPayloadSize();
+	return true;
+}
+
+TraceModel::TraceModel(const std::string& path)
+	: m_file(path), m_maxPayloadSize(0), m_position(m_file.GetData()), 
+		m_lastTimestamp(0), m_started(false)
+{
+	// the server has to expect the largest packet before the first is sent
+	const char* position = m_file.GetData();
+	const char* const end = m_file.GetData() + m_file.GetSize();
+	uint64_t timestamp;
+	uint32_t size;
+	while (ParseLine(position, end, timestamp, size) == true)
+		m_maxPayloadSize = std::max(m_maxPayloadSize, std::min(size, RandomPacket::MaxPayloadSize));
+}
+
+void TraceModel::Rewind() noexcept
+{
+	m_position = m_file.GetData();
+	m_lastTimestamp = 0;
+	m_started = false;
+}
+
+bool TraceModel::Next(Duration_t& gap, uint32_t& payloadSize) noexcept
+{
+	uint64_t timestamp;
+	uint32_t size;
+	if (ParseLine(m_position, m_file.GetData() + m_file.GetSize(), timestamp, size) == false)
+		return false;
+	// timestamps going backwards are sent right away
+	gap = (m_started == true && timestamp > m_lastTimestamp) ? 
+		std::chrono::microseconds(timestamp - m_lastTimestamp) : Duration_t(0);
+	m_started = true;
+	m_lastTimestamp = timestamp;
+	payloadSize = std::min(size, RandomPacket::MaxPayloadSize);
+	return true;
+}
+
+bool TraceModel::ParseLine(const char*& position, const char* end,
+	uint64_t& timestamp, uint32_t& size) noexcept
+{
+	while (position < end)
+	{
+		const char* lineEnd = std::find(position, end, '\n');
+		const char* cursor = position;
+		position = (lineEnd == end) ? end : lineEnd + 1;
+		// skip leading whitespace, blank lines and comments
+		while (cursor < lineEnd && (*cursor == ' ' || *cursor == '\t'))
+			++cursor;
+		if (cursor == lineEnd || *cursor == '#' || *cursor == '\r')
+			continue;
+		auto res = std::from_chars(cursor, lineEnd, timestamp, 10);
+		if (res.ec != std::errc())
+			continue;
+		cursor = res.ptr;
+		while (cursor < lineEnd && (*cursor == ' ' || *cursor == '\t' || *cursor == ','))
+			++cursor;
+		if (std::from_chars(cursor, lineEnd, size, 10).ec == std::errc())
+			return true;
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include <UDPTest/Detail/WireFormat.h>
+
+#include <stdexcept>
+
+namespace
+{
+	struct FieldName
+	{
+		UDPTest::Detail::Field field;
+		const char* name;
+	};
+
+	constexpr FieldName FieldNames[] =
+	{
+		{ UDPTest::Detail::Field::Seq, "seq" },
+		{ UDPTest::Detail::Field::Checksum, "checksum" },
+		{ UDPTest::Detail::Field::Timestamp, "timestamp" },
+		{ UDPTest::Detail::Field::StreamId, "stream" },
+		{ UDPTest::Detail::Field::Flags, "flags" }
+	};
+}
+
+UDPTest::Detail::FieldSet UDPTest::Detail::ParseFields(const std::string& spec)
+{
+	FieldSet fields = 0;
+	size_t start = 0;
+	while (start < spec.size())
+	{
+		size_t end = spec.find(',', start);
+		if (end == std::string::npos)
+			end = spec.size();
+		const std::string name = spec.substr(start, end - start);
+		if (name == "timestamp")
+			fields |= FieldBit(Field::Timestamp);
+		else if (name == "stream")
+			fields |= FieldBit(Field::StreamId);
+		else if (name == "flags")
+			fields |= FieldBit(Field::Flags);
+		else
+			throw std::runtime_error("Unknown header field: " + name + ", expected timestamp, stream or flags");
+		start = end + 1;
+	}
+	return fields;
+}
+
+std::string UDPTest::Detail::DescribeFields(FieldSet fields)
+{
+	std::string description;
+	for (const FieldName& name : FieldNames)
+	{
+		if ((fields & FieldBit(name.field)) == 0)
+			continue;
+		if (description.empty() == false)
+			description += ',';
+		description += name.name;
+	}
+	return description;
+}
\ No newline at end of file
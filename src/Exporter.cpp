@@ -0,0 +1,235 @@
+#include <UDPTest/Exporter.h>
+
+#include <UDPTest/Common.h>
+
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+using UDPTest::Exporter;
+using UDPTest::Detail::MetricsSegment;
+
+namespace
+{
+	/// @brief The powers of two, in nanoseconds, exported as latency buckets
+	constexpr uint32_t FirstBucketExponent = 10;
+	constexpr uint32_t LastBucketExponent = 34;
+
+	/// @brief Escapes a Prometheus label value
+	std::string EscapeLabel(const std::string& value)
+	{
+		std::string escaped;
+		for (const char c : value)
+		{
+			if (c == '\\' || c == '"')
+				escaped.push_back('\\');
+			escaped.push_back(c);
+		}
+		return escaped;
+	}
+}
+
+Exporter::Exporter(const std::string& address, const std::string& port,
+	const std::string& segment) : m_worker(), m_acceptor(m_worker), 
+	m_signals(m_worker), m_segment(segment)
+{
+	ErrorCode_t ec;
+	// resolve local address
+	Proto_t::resolver resolver(m_worker);
+	Proto_t::endpoint localEndpoint = *resolver.resolve(address, port, ec);
+	if (ec)
+		throw ec;
+	// try to open the acceptor
+	if (m_acceptor.open(Proto_t::v4(), ec), ec ||
+		m_acceptor.set_option(Proto_t::acceptor::reuse_address(true), ec), ec ||
+		m_acceptor.bind(localEndpoint, ec), ec ||
+		m_acceptor.listen(Proto_t::acceptor::max_listen_connections, ec))
+		throw ec;
+	// register signals
+	m_signals.add(SIGINT);
+	m_signals.add(SIGTERM);
+	WaitSignals();
+	Accept();
+	SPDLOG_INFO("Exporting {} on {}:{}", segment, address, port);
+}
+
+void Exporter::Run() noexcept
+{
+	m_worker.run();
+}
+
+void Exporter::PrintMetrics(const std::string& segment, std::ostream& os)
+{
+	using Counter = MetricsSegment::Counter;
+	const MetricsSegment metrics(segment);
+	const auto toMs = [](uint64_t ns) { return static_cast<double>(ns) / 1000000.; };
+	os << "Segment " << segment << " published by " <<
+		((metrics.GetRole() == MetricsSegment::Role::Server) ? "server" : "client") <<
+		" (pid " << metrics.GetPid() << ")\n";
+	os << std::left << std::setw(24) << "Flow" << std::right <<
+		std::setw(10) << "pps" << std::setw(14) << "bytes/s" << 
+		std::setw(12) << "packets" << std::setw(10) << "lost" << std::setw(10) << "corrupt" <<
+		std::setw(8) << "queue" << std::setw(10) << "p50 ms" << 
+		std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << '\n';
+	os << std::fixed << std::setprecision(3);
+	for (const auto& slot : metrics.ReadSlots())
+	{
+		os << std::left << std::setw(24) << slot.name << std::right <<
+			std::setw(10) << slot.counters[Counter::PacketsPerSecond] <<
+			std::setw(14) << slot.counters[Counter::BytesPerSecond] <<
+			std::setw(12) << slot.counters[Counter::PacketsTotal] <<
+			std::setw(10) << slot.counters[Counter::LostTotal] <<
+			std::setw(10) << slot.counters[Counter::CorruptedTotal] <<
+			std::setw(8) << slot.counters[Counter::AckQueueDepth] <<
+			std::setw(10) << toMs(slot.latency.GetPercentile(50)) <<
+			std::setw(10) << toMs(slot.latency.GetPercentile(99)) <<
+			std::setw(10) << toMs(slot.counters[Counter::LatencyMaxNs]) << '\n';
+	}
+}
+
+std::string Exporter::FormatMetrics(const MetricsSegment& segment)
+{
+	using Counter = MetricsSegment::Counter;
+	struct Metric
+	{
+		const char* name;
+		const char* type;
+		const char* help;
+		Counter counter;
+	};
+	static constexpr Metric metrics[] =
+	{
+		{ "udptest_packets_per_second", "gauge", "Packets per second over the last interval", Counter::PacketsPerSecond },
+		{ "udptest_bytes_per_second", "gauge", "Bytes per second over the last interval", Counter::BytesPerSecond },
+		{ "udptest_packets_total", "counter", "Packets sent by a client or received by a server", Counter::PacketsTotal },
+		{ "udptest_bytes_total", "counter", "Bytes sent by a client or received by a server", Counter::BytesTotal },
+		{ "udptest_lost_packets", "gauge", "Packets missing from the current sequence", Counter::LostTotal },
+		{ "udptest_corrupted_packets", "gauge", "Packets that failed their integrity check", Counter::CorruptedTotal },
+		{ "udptest_ack_queue_depth", "gauge", "Acks waiting to be sent", Counter::AckQueueDepth },
+		{ "udptest_cpu_nanoseconds_total", "counter", "CPU time of the transport thread", Counter::CpuTimeNs },
+		{ "udptest_context_switches_total", "counter", "Context switches of the transport thread", Counter::ContextSwitches },
+		{ "udptest_ack_queue_max_depth", "gauge", "Deepest ack queue over the last interval", Counter::MaxAckQueueDepth }
+	};
+	const std::string role = (segment.GetRole() == MetricsSegment::Role::Server) ?
+		"server" : "client";
+	const auto slots = segment.ReadSlots();
+	std::ostringstream oss;
+	for (const Metric& metric : metrics)
+	{
+		oss << "# HELP " << metric.name << ' ' << metric.help << '\n';
+		oss << "# TYPE " << metric.name << ' ' << metric.type << '\n';
+		for (const auto& slot : slots)
+		{
+			oss << metric.name << "{role=\"" << role << "\",flow=\"" << 
+				EscapeLabel(slot.name) << "\"} " << slot.counters[metric.counter] << '\n';
+		}
+	}
+	// clients measure round trip latency, servers the time to ack
+	oss << "# HELP udptest_latency_seconds Round trip latency for clients, ack latency for servers\n";
+	oss << "# TYPE udptest_latency_seconds histogram\n";
+	for (const auto& slot : slots)
+	{
+		const std::string labels = "role=\"" + role + "\",flow=\"" + EscapeLabel(slot.name) + '"';
+		// every power of two starts a new group of sub-buckets
+		uint64_t cumulative = 0;
+		uint32_t bucket = 0;
+		for (uint32_t exponent = FirstBucketExponent; exponent <= LastBucketExponent; ++exponent)
+		{
+			const uint32_t end = (exponent - Detail::Histogram::SubBucketBits + 1) * 
+				Detail::Histogram::SubBuckets;
+			for (; bucket < end; ++bucket)
+				cumulative += slot.latency.GetBucketCount(bucket);
+			oss << "udptest_latency_seconds_bucket{" << labels << ",le=\"" <<
+				static_cast<double>(uint64_t(1) << exponent) / 1e9 << "\"} " << cumulative << '\n';
+		}
+		oss << "udptest_latency_seconds_bucket{" << labels << ",le=\"+Inf\"} " <<
+			slot.counters[Counter::LatencyCount] << '\n';
+		oss << "udptest_latency_seconds_sum{" << labels << "} " <<
+			static_cast<double>(slot.counters[Counter::LatencySumNs]) / 1e9 << '\n';
+		oss << "udptest_latency_seconds_count{" << labels << "} " <<
+			slot.counters[Counter::LatencyCount] << '\n';
+	}
+	return oss.str();
+}
+
+void Exporter::Accept() noexcept
+{
+	m_acceptor.async_accept(
+		[this](const ErrorCode_t& ec, Socket_t socket)
+		{
+			// check if it was closed
+			if (m_acceptor.is_open() == false)
+				return;
+			if (!ec)
+				Serve(std::move(socket));
+			else
+				SPDLOG_ERROR("Error accepting scrape: {}", ec.message());
+			Accept();
+		});
+}
+
+void Exporter::Serve(Socket_t socket) noexcept
+{
+	struct Scrape
+	{
+		explicit Scrape(Socket_t socket) noexcept : socket(std::move(socket)) {}
+
+		Socket_t socket;
+		asio::streambuf request;
+		std::string response;
+	};
+	auto scrape = std::make_shared<Scrape>(std::move(socket));
+	asio::async_read_until(scrape->socket, scrape->request, "\r\n\r\n",
+		[this, scrape](const ErrorCode_t& ec, size_t)
+		{
+			if (ec)
+				return;
+			// open the segment per scrape so publisher restarts are picked up
+			std::string body;
+			std::string status = "200 OK";
+			try
+			{
+				body = FormatMetrics(MetricsSegment(m_segment));
+			}
+			catch (const ErrorCode_t& ec)
+			{
+				status = "503 Service Unavailable";
+				body = "Failed to open metrics segment: " + ec.message() + '\n';
+			}
+			catch (const std::exception& ex)
+			{
+				status = "503 Service Unavailable";
+				body = std::string(ex.what()) + '\n';
+			}
+			scrape->response = "HTTP/1.0 " + status + "\r\n"
+				"Content-Type: text/plain; version=0.0.4\r\n"
+				"Content-Length: " + std::to_string(body.size()) + "\r\n"
+				"Connection: close\r\n\r\n" + body;
+			asio::async_write(scrape->socket, asio::buffer(scrape->response),
+				[scrape](const ErrorCode_t&, size_t)
+				{
+					ErrorCode_t ignored;
+					scrape->socket.shutdown(Socket_t::shutdown_both, ignored);
+					scrape->socket.close(ignored);
+				});
+		});
+}
+
+void Exporter::Stop() noexcept
+{
+	ErrorCode_t ignored;
+	m_acceptor.close(ignored);
+	m_signals.cancel(ignored);
+}
+
+void Exporter::WaitSignals() noexcept
+{
+	m_signals.async_wait(
+		[this](const ErrorCode_t& ec, int signo)
+		{
+			if (ec)
+				return;
+			SPDLOG_DEBUG("Intercepted {}. Closing", signo);
+			Stop();
+		});
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <UDPTest/FanOut.h>
+
+#include <UDPTest/Common.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+using UDPTest::FanOut;
+using UDPTest::Client;
+
+FanOut::FanOut(const std::vector<Flow>& flows, const std::string& metrics, bool perf,
+	const MakeClient_t& makeClient) :
+	m_worker(), m_reporter([this](const Client::IntervalStats& stats) { ReportInterval(stats); }),
+	m_flows(flows), m_cpuMeter(perf), m_aggregatedCount(0)
+{
+	if (metrics.empty() == false)
+	{
+		// one segment, each flow publishes to its own slot
+		m_metrics = std::make_unique<Detail::MetricsSegment>(metrics,
+			Detail::MetricsSegment::Role::Client);
+		SPDLOG_INFO("Publishing metrics to {}", metrics);
+	}
+	m_clients.reserve(m_flows.size());
+	for (size_t i = 0; i < m_flows.size(); ++i)
+	{
+		const Flow& flow = m_flows[i];
+		const Client::Shared shared{ m_worker, m_reporter, m_metrics.get(), static_cast<uint32_t>(i),
+			flow.trafficClass.name };
+		m_clients.push_back(makeClient(flow, shared));
+		SPDLOG_INFO("Flow {} to {}:{} at {} and {} packets/s, DSCP {} at priority {}",
+			flow.trafficClass.name, flow.address, flow.port,
+			Client::BitsToString(Client::ParseBitrate(flow.trafficClass.bitRate)),
+			flow.trafficClass.packetRate, flow.trafficClass.GetDscp(), flow.trafficClass.priority);
+	}
+	m_aggregated.resize(m_clients.size());
+}
+
+void FanOut::Run()
+{
+	SPDLOG_INFO("Running fan-out");
+	// every target's transport runs on this thread
+	m_cpuMeter.Start();
+	if (m_cpuMeter.GetHardwareError().empty() == false)
+		SPDLOG_WARN("Hardware counters unavailable: {}", m_cpuMeter.GetHardwareError());
+	const auto start = std::chrono::steady_clock::now();
+	m_reporter.Start();
+	m_worker.run();
+	m_reporter.Stop();
+	// the reporter has stopped, so the aggregate is this thread's now
+	if (m_aggregatedCount != 0)
+		FlushAggregate();
+	PrintEndStats(std::chrono::steady_clock::now() - start);
+}
+
+std::vector<FanOut::Flow> FanOut::SplitTargets(const std::string& targets,
+	const std::string& port, const Detail::TrafficClass& total)
+{
+	const std::vector<std::pair<std::string, std::string>> endpoints = ParseTargets(targets, port);
+	if (total.packetRate < endpoints.size())
+		throw std::runtime_error("The packet rate must give every target at least a packet per second");
+	const std::string targetBitRate = std::to_string(Client::ParseBitrate(total.bitRate) / endpoints.size());
+	std::vector<Flow> flows;
+	for (size_t i = 0; i < endpoints.size(); ++i)
+	{
+		Flow flow{ endpoints[i].first, endpoints[i].second, total };
+		flow.trafficClass.name = endpoints[i].first + ':' + endpoints[i].second;
+		flow.trafficClass.bitRate = targetBitRate;
+		// the packets left over from an even split go to the first targets
+		flow.trafficClass.packetRate = static_cast<uint32_t>(total.packetRate / endpoints.size() +
+			((i < total.packetRate % endpoints.size()) ? 1 : 0));
+		flows.push_back(flow);
+	}
+	return flows;
+}
+
+std::vector<FanOut::Flow> FanOut::SplitClasses(const std::string& address,
+	const std::string& port, const std::string& classes,
+	const Detail::TrafficClass& defaults)
+{
+	std::vector<Flow> flows;
+	for (const Detail::TrafficClass& trafficClass : Detail::TrafficClass::ParseList(classes, defaults))
+		flows.push_back(Flow{ address, port, trafficClass });
+	return flows;
+}
+
+std::vector<std::pair<std::string, std::string>> FanOut::ParseTargets(
+	const std::string& targets, const std::string& port)
+{
+	std::vector<std::pair<std::string, std::string>> endpoints;
+	size_t start = 0;
+	while (start <= targets.size())
+	{
+		size_t end = targets.find(',', start);
+		if (end == std::string::npos)
+			end = targets.size();
+		const std::string target = targets.substr(start, end - start);
+		start = end + 1;
+		std::string address = target;
+		std::string targetPort = port;
+		if (target.empty() == false && target.front() == '[')
+		{
+			const size_t close = target.find(']');
+			if (close == std::string::npos ||
+				(close + 1 != target.size() && target[close + 1] != ':'))
+				throw std::runtime_error("Expected [<IPv6 address>][:<port>], got " + target);
+			address = target.substr(1, close - 1);
+			if (close + 1 != target.size())
+				targetPort = target.substr(close + 2);
+		}
+		// more than one colon is a bare IPv6 address
+		else if (const size_t colon = target.find(':');
+			colon != std::string::npos && target.find(':', colon + 1) == std::string::npos)
+		{
+			address = target.substr(0, colon);
+			targetPort = target.substr(colon + 1);
+		}
+		if (address.empty() == true || targetPort.empty() == true)
+			throw std::runtime_error("Expected <address>[:<port>], got " + target);
+		endpoints.emplace_back(address, targetPort);
+	}
+	return endpoints;
+}
+
+void FanOut::ReportInterval(const Client::IntervalStats& stats) noexcept
+{
+	m_clients[stats.target]->ReportInterval(stats);
+	// flows are paced apart, so an interval ends when one reports again
+	if (m_aggregated[stats.target] == true)
+		FlushAggregate();
+	m_aggregated[stats.target] = true;
+	++m_aggregatedCount;
+	m_aggregate.Merge(stats);
+}
+
+void FanOut::FlushAggregate() noexcept
+{
+	Client::PrintIntervalStats("All " + std::to_string(m_aggregatedCount) + " flows", m_aggregate);
+	m_aggregate.Reset();
+	std::fill(m_aggregated.begin(), m_aggregated.end(), false);
+	m_aggregatedCount = 0;
+}
+
+void FanOut::PrintEndStats(std::chrono::nanoseconds elapsed) noexcept
+{
+	const auto toMs = [](uint64_t ns) { return static_cast<float>(ns / 1000) / 1000.f; };
+	const auto printRow = [&toMs](const std::string& flow, const std::string& dscp,
+		const Client::Totals& totals, uint64_t bitRate)
+	{
+		SPDLOG_INFO("{}\t{}\t{}\t{}\t{}\t{:.3f}%\t{}\t{} ms\t{} ms\t{} ms\t{} ms\t{} ms", flow, dscp,
+			Client::BitsToString(bitRate), totals.sent, totals.received,
+			(totals.sent != 0) ? static_cast<float>(totals.lost) / totals.sent * 100 : 0.f, totals.corrupted,
+			(totals.received != 0) ? toMs(static_cast<uint64_t>(std::chrono::duration_cast<
+				std::chrono::nanoseconds>(totals.totalLatency).count()) / totals.received) : 0.f,
+			toMs(totals.latency.GetPercentile(50)), toMs(totals.latency.GetPercentile(99)),
+			toMs(totals.latency.GetPercentile(99.9)), toMs(static_cast<uint64_t>(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(totals.jitter).count())));
+	};
+	SPDLOG_INFO("Fan-out stats:");
+	SPDLOG_INFO("Flow\tDSCP\tBitrate\tSent\tRecv\tLoss\tCorrupt\tAvg latency\tP50 latency\tP99 latency\tP99.9 latency\tJitter");
+	Client::Totals all;
+	uint64_t allBitRate = 0;
+	for (size_t i = 0; i < m_clients.size(); ++i)
+	{
+		const Client::Totals& totals = m_clients[i]->GetTotals();
+		const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(totals.elapsed).count();
+		const uint64_t bitRate = (ms != 0) ? totals.bytes * 8 * 1000 / static_cast<uint64_t>(ms) : 0;
+		printRow(m_clients[i]->GetTarget(), std::to_string(m_flows[i].trafficClass.GetDscp()), totals, bitRate);
+		all.sent += totals.sent;
+		all.received += totals.received;
+		all.corrupted += totals.corrupted;
+		all.lost += totals.lost;
+		all.bytes += totals.bytes;
+		all.totalLatency += totals.totalLatency;
+		all.latency.Merge(totals.latency);
+		all.jitter = std::max(all.jitter, totals.jitter);
+		allBitRate += bitRate;
+	}
+	printRow("All", "-", all, allBitRate);
+	// each packet costs a send and an ack receive, whichever flow it went to
+	Detail::CpuMeter::Report(m_cpuMeter.Read(), all.sent, all.bytes, elapsed);
+}
\ No newline at end of file
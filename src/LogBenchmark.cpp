@@ -0,0 +1,100 @@
+#include <UDPTest/LogBenchmark.h>
+
+#include <UDPTest/Common.h>
+#include <UDPTest/Detail/EventLog.h>
+
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <memory>
+#include <string>
+
+using UDPTest::LogBenchmark;
+
+namespace
+{
+	/// @brief Keeps the loops from being optimized away
+	volatile uint32_t g_sink;
+
+	/// @brief Times a per-packet log call the way the transport thread makes it
+	/// @param events The number of events
+	/// @param log The call, given the seq
+	/// @return Nanoseconds per event
+	template<typename Log_t>
+	double Measure(uint32_t events, Log_t&& log)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32_t seq = 0; seq < events; ++seq)
+		{
+			g_sink = seq;
+			log(seq);
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		return static_cast<double>(std::chrono::duration_cast<
+			std::chrono::nanoseconds>(elapsed).count()) / events;
+	}
+}
+
+void LogBenchmark::Run(uint32_t events, std::ostream& os)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+	const std::string textPath = (directory / "udptest-logbench.log").string();
+	const std::string eventPath = (directory / "udptest-logbench.bin").string();
+	const auto print = [&os](const char* mode, double ns, const std::string& note)
+	{
+		os << std::left << std::setw(28) << mode << std::right << std::fixed <<
+			std::setprecision(1) << std::setw(10) << ns << "  " << note << '\n';
+	};
+	os << "Logging " << events << " packet events per mode\n";
+	os << std::left << std::setw(28) << "Mode" << std::right << std::setw(10) << "ns/event" << '\n';
+
+	print("stripped", Measure(events, [](uint32_t) { (void)0; }), "");
+
+	// the cost of a log line that was compiled in but is filtered out at runtime
+	auto filtered = std::make_shared<spdlog::logger>("logbench-filtered",
+		std::make_shared<spdlog::sinks::null_sink_st>());
+	filtered->set_level(spdlog::level::info);
+	print("spdlog, filtered by level", Measure(events, [&filtered](uint32_t seq)
+		{
+			filtered->debug("Received random packet of seq {}", seq);
+		}), "");
+
+	auto null = std::make_shared<spdlog::logger>("logbench-null",
+		std::make_shared<spdlog::sinks::null_sink_st>());
+	null->set_level(spdlog::level::debug);
+	print("spdlog, null sink", Measure(events, [&null](uint32_t seq)
+		{
+			null->debug("Received random packet of seq {}", seq);
+		}), "formats, writes nothing");
+
+	{
+		auto file = std::make_shared<spdlog::logger>("logbench-file",
+			std::make_shared<spdlog::sinks::basic_file_sink_st>(textPath, true));
+		file->set_level(spdlog::level::debug);
+		const double ns = Measure(events, [&file](uint32_t seq)
+			{
+				file->debug("Received random packet of seq {}", seq);
+			});
+		file->flush();
+		print("spdlog, file sink", ns, "buffered, not flushed per line");
+	}
+
+	{
+		Detail::EventLog eventLog(eventPath);
+		eventLog.Start();
+		const double ns = Measure(events, [&eventLog](uint32_t seq)
+			{
+				eventLog.Record(Detail::EventType::PacketReceived, seq, 1024);
+			});
+		eventLog.Stop();
+		print("event log", ns, std::to_string(eventLog.GetWritten()) + " written, " +
+			std::to_string(eventLog.GetDropped()) + " dropped");
+	}
+
+	std::remove(textPath.c_str());
+	std::remove(eventPath.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include <UDPTest/Reflector.h>
+
+#include <UDPTest/Detail/SocketOptions.h>
+
+using UDPTest::Reflector;
+
+Reflector::Shard::Shard(size_t receiveDepth, size_t maxFlows, bool perf) 
+	: worker(1), socket(worker), tickTimer(worker), receiveSlots(receiveDepth),
+	flows(maxFlows), tick(0), packetsReceived(0), bytesReceived(0), acksDropped(0),
+	flowsOpened(0), flowsEvicted(0), flowsRejected(0), evictedLost(0), cpuMeter(perf)
+{
+	// sources are unknown, so every receive has to fit the largest datagram
+	for (ReceiveSlot& slot : receiveSlots)
+		slot.packet = Detail::RandomPacket(Detail::BasePacketFields,
+			Detail::RandomPacket::MaxPayloadSize);
+}
+
+Reflector::Reflector(const std::string& address, const std::string& port,
+	size_t shards, size_t receiveDepth, uint32_t idleTimeout,
+	size_t maxFlows, const std::string& metrics, bool perf) : m_worker(), 
+	m_signals(m_worker), m_printTimer(m_worker), m_idleTimeout(idleTimeout),
+	m_views(shards)
+{
+	spdlog::set_level(spdlog::level::debug);
+	ErrorCode_t ec;
+	// resolve local address
+	Proto_t::resolver resolver(m_worker);
+	const Proto_t::endpoint localEndpoint = *resolver.resolve(address, port, ec);
+	if (ec)
+		throw ec;
+	// every shard binds the same port, the kernel hashes flows across them
+	for (size_t i = 0; i < shards; ++i)
+	{
+		auto shard = std::make_unique<Shard>(receiveDepth, maxFlows, perf);
+		if (shard->socket.open(localEndpoint.protocol(), ec), ec ||
+			(shards > 1 && (Detail::SetReusePort(shard->socket, ec), ec)) ||
+			shard->socket.bind(localEndpoint, ec), ec ||
+			shard->socket.non_blocking(true, ec), ec)
+			throw ec;
+		m_shards.push_back(std::move(shard));
+	}
+	// register signals
+	m_signals.add(SIGINT);
+	m_signals.add(SIGTERM);
+	WaitSignals();
+	m_printTimer.expires_at(std::chrono::steady_clock::now());
+	AwaitPrint();
+	for (auto& shard : m_shards)
+	{
+		for (size_t i = 0; i < shard->receiveSlots.size(); ++i)
+			ReadTransport(*shard, i);
+		shard->tickTimer.expires_at(std::chrono::steady_clock::now());
+		AwaitTick(*shard);
+	}
+	if (metrics.empty() == false)
+	{
+		m_metrics = std::make_unique<Detail::MetricsSegment>(metrics,
+			Detail::MetricsSegment::Role::Server);
+		for (size_t i = 0; i < m_views.size(); ++i)
+			m_views[i].metricsSlot = m_metrics->AcquireSlot("shard " + std::to_string(i));
+		SPDLOG_INFO("Publishing metrics to {}", metrics);
+	}
+	SPDLOG_INFO("Started reflector on {}:{} with {} shards, tracking up to {} flows each",
+		localEndpoint.address().to_string(), localEndpoint.port(), shards, maxFlows);
+}
+
+Reflector::~Reflector()
+{
+	Stop();
+	for (auto& shard : m_shards)
+	{
+		if (shard->thread.joinable() == true)
+			shard->thread.join();
+	}
+}
+
+void Reflector::Run() noexcept
+{
+	SPDLOG_INFO("Running reflector");
+	const auto start = std::chrono::steady_clock::now();
+	for (auto& shard : m_shards)
+	{
+		// the meter measures the thread that starts it
+		shard->thread = std::thread([&shard = *shard]()
+			{
+				shard.cpuMeter.Start();
+				if (shard.cpuMeter.GetHardwareError().empty() == false)
+					SPDLOG_WARN("Hardware counters unavailable: {}", shard.cpuMeter.GetHardwareError());
+				shard.worker.run();
+				shard.cpuUsage = shard.cpuMeter.Read();
+			});
+	}
+	m_worker.run();
+	Detail::CpuMeter::Usage usage;
+	uint64_t packets = 0;
+	uint64_t bytes = 0;
+	for (auto& shard : m_shards)
+	{
+		shard->thread.join();
+		const Detail::CpuMeter::Usage& shardUsage = shard->cpuUsage;
+		usage.userNs += shardUsage.userNs;
+		usage.systemNs += shardUsage.systemNs;
+		usage.voluntarySwitches += shardUsage.voluntarySwitches;
+		usage.involuntarySwitches += shardUsage.involuntarySwitches;
+		usage.hardware = shardUsage.hardware;
+		usage.cycles += shardUsage.cycles;
+		usage.instructions += shardUsage.instructions;
+		usage.cacheMisses += shardUsage.cacheMisses;
+		packets += shard->packetsReceived;
+		bytes += shard->bytesReceived;
+	}
+	SPDLOG_INFO("Received {} packets in total", packets);
+	Detail::CpuMeter::Report(usage, packets, bytes, std::chrono::steady_clock::now() - start);
+}
+
+void Reflector::Stop() noexcept
+{
+	ErrorCode_t ignored;
+	m_signals.cancel(ignored);
+	m_printTimer.cancel(ignored);
+	for (auto& shard : m_shards)
+		shard->worker.stop();
+}
+
+void Reflector::WaitSignals() noexcept
+{
+	m_signals.async_wait(
+		[this](const ErrorCode_t& ec, int signo)
+		{
+			if (ec)
+				return;
+			SPDLOG_DEBUG("Intercepted {}. Closing", signo);
+			Stop();
+		});
+}
+
+void Reflector::ReadTransport(Shard& shard, size_t slot) noexcept
+{
+	Shard::ReceiveSlot& receiveSlot = shard.receiveSlots[slot];
+	shard.socket.async_receive_from(receiveSlot.packet.GetBuffers(),
+		receiveSlot.endpoint, [this, &shard, slot](const ErrorCode_t& ec, size_t bytes)
+		{
+			if (!ec)
+			{
+				const Shard::ReceiveSlot& receiveSlot = shard.receiveSlots[slot];
+				const uint32_t seq = receiveSlot.packet.GetSeq();
+				++shard.packetsReceived;
+				shard.bytesReceived += bytes;
+				TrackFlow(shard, receiveSlot.endpoint, seq);
+				// acks are fire and forget, a full send buffer drops them
+				Detail::PacketAck ack(seq);
+				ErrorCode_t sendEc;
+				shard.socket.send_to(ack.GetBuffers(), receiveSlot.endpoint, 0, sendEc);
+				if (sendEc)
+					++shard.acksDropped;
+				ReadTransport(shard, slot);
+			}
+			else if (ec != asio::error::operation_aborted)
+			{
+				// a port unreachable from an earlier ack lands here, keep going
+				SPDLOG_DEBUG("Transport error on read: {}", ec.message());
+				ReadTransport(shard, slot);
+			}
+		});
+}
+
+void Reflector::TrackFlow(Shard& shard, const Proto_t::endpoint& endpoint,
+	uint32_t seq) noexcept
+{
+	bool inserted;
+	Detail::FlowState* flow = shard.flows.FindOrInsert(
+		Detail::FlowTable::MakeKey(endpoint), inserted);
+	if (flow == nullptr)
+	{
+		++shard.flowsRejected;
+		return;
+	}
+	if (inserted == true)
+		++shard.flowsOpened;
+	flow->lastSeen = shard.tick;
+	// path MTU probes are not part of the sequence
+	if (seq >= Detail::RandomPacket::ProbeSeqBase)
+		return;
+	if (flow->packetsReceived == 0)
+	{
+		flow->firstSeq = seq;
+		flow->highestSeq = seq;
+		++flow->packetsReceived;
+		return;
+	}
+	const uint64_t extended = Detail::RandomPacket::ExtendSeq(seq, flow->highestSeq);
+	// a seq of 0 is the wire seq wrapping when it lands ahead of the
+	// flow, and otherwise a client reusing its port to start over
+	if (seq == 0 && extended <= flow->highestSeq)
+	{
+		// keep the last run's loss
+		shard.evictedLost += flow->GetLost();
+		flow->firstSeq = 0;
+		flow->highestSeq = 0;
+		flow->packetsReceived = 0;
+	}
+	else if (extended > flow->highestSeq)
+		flow->highestSeq = extended;
+	++flow->packetsReceived;
+}
+
+void Reflector::AwaitTick(Shard& shard) noexcept
+{
+	shard.tickTimer.expires_at(shard.tickTimer.expiry() + std::chrono::seconds(1));
+	shard.tickTimer.async_wait([this, &shard](const ErrorCode_t& ec)
+		{
+			if (ec)
+				return;
+			AwaitTick(shard);
+			++shard.tick;
+			shard.flowsEvicted += shard.flows.Evict(shard.tick - m_idleTimeout,
+				[&shard](const Detail::FlowState& flow) { shard.evictedLost += flow.GetLost(); });
+			uint64_t lost = shard.evictedLost;
+			shard.flows.ForEach([&lost](const Detail::FlowState& flow) { lost += flow.GetLost(); });
+			ShardTotals& totals = shard.totals;
+			totals.packetsReceived.store(shard.packetsReceived, std::memory_order_relaxed);
+			totals.bytesReceived.store(shard.bytesReceived, std::memory_order_relaxed);
+			totals.acksDropped.store(shard.acksDropped, std::memory_order_relaxed);
+			totals.flows.store(shard.flows.GetSize(), std::memory_order_relaxed);
+			totals.flowsOpened.store(shard.flowsOpened, std::memory_order_relaxed);
+			totals.flowsEvicted.store(shard.flowsEvicted, std::memory_order_relaxed);
+			totals.flowsRejected.store(shard.flowsRejected, std::memory_order_relaxed);
+			totals.lostTotal.store(lost, std::memory_order_relaxed);
+			const Detail::CpuMeter::Usage usage = shard.cpuMeter.Read();
+			totals.cpuNs.store(usage.GetCpuNs(), std::memory_order_relaxed);
+			totals.contextSwitches.store(usage.voluntarySwitches + usage.involuntarySwitches,
+				std::memory_order_relaxed);
+		});
+}
+
+void Reflector::AwaitPrint() noexcept
+{
+	m_printTimer.expires_at(m_printTimer.expiry() + std::chrono::seconds(1));
+	m_printTimer.async_wait([this](const ErrorCode_t& ec)
+		{
+			using Counter = Detail::MetricsSegment::Counter;
+			if (ec)
+				return;
+			AwaitPrint();
+			uint64_t flows = 0;
+			uint64_t packets = 0;
+			for (size_t i = 0; i < m_shards.size(); ++i)
+			{
+				const ShardTotals& totals = m_shards[i]->totals;
+				ShardView& view = m_views[i];
+				const uint64_t packetsReceived = totals.packetsReceived.load(std::memory_order_relaxed);
+				const uint64_t bytesReceived = totals.bytesReceived.load(std::memory_order_relaxed);
+				const uint64_t flowsOpened = totals.flowsOpened.load(std::memory_order_relaxed);
+				const uint64_t flowsEvicted = totals.flowsEvicted.load(std::memory_order_relaxed);
+				const uint64_t lostTotal = totals.lostTotal.load(std::memory_order_relaxed);
+				SPDLOG_INFO("Shard {}: Flows: {} (+{} -{}, {} rejected)\tReceived: {} pps\tLost: {}\tAcks dropped: {}",
+					i, totals.flows.load(std::memory_order_relaxed), flowsOpened - view.flowsOpened,
+					flowsEvicted - view.flowsEvicted, totals.flowsRejected.load(std::memory_order_relaxed),
+					packetsReceived - view.packetsReceived, lostTotal,
+					totals.acksDropped.load(std::memory_order_relaxed));
+				flows += totals.flows.load(std::memory_order_relaxed);
+				packets += packetsReceived - view.packetsReceived;
+				if (m_metrics != nullptr &&
+					view.metricsSlot != Detail::MetricsSegment::SlotCount)
+				{
+					view.counters[Counter::PacketsPerSecond] = packetsReceived - view.packetsReceived;
+					view.counters[Counter::BytesPerSecond] = bytesReceived - view.bytesReceived;
+					view.counters[Counter::PacketsTotal] = packetsReceived;
+					view.counters[Counter::BytesTotal] = bytesReceived;
+					view.counters[Counter::LostTotal] = lostTotal;
+					view.counters[Counter::CpuTimeNs] = totals.cpuNs.load(std::memory_order_relaxed);
+					view.counters[Counter::ContextSwitches] = totals.contextSwitches.load(std::memory_order_relaxed);
+					m_metrics->WriteSlot(view.metricsSlot, view.counters, Detail::Histogram());
+				}
+				view.packetsReceived = packetsReceived;
+				view.bytesReceived = bytesReceived;
+				view.flowsOpened = flowsOpened;
+				view.flowsEvicted = flowsEvicted;
+			}
+			if (m_shards.size() > 1)
+				SPDLOG_INFO("All shards: Flows: {}\tReceived: {} pps", flows, packets);
+		});
+}
\ No newline at end of file
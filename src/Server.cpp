@@ -1,9 +1,18 @@
 #include <UDPTest/Server.h>
 
+#include <cstring>
+
 using UDPTest::Server;
 
-Server::Server(const std::string& address, const std::string& port)
-	: m_worker(), m_acceptor(m_worker), m_signals(m_worker)
+Server::Server(const std::string& address, const std::string& port,
+	size_t receiveDepth, const std::string& metrics,
+	const std::string& eventLog, bool perf, const std::string& impairment) : m_worker(), 
+	m_acceptor(m_worker), m_signals(m_worker), m_printTimer(m_worker), 
+	m_receiveDepth(receiveDepth), m_impairment(Detail::ImpairmentConfig::Parse(impairment)), 
+	m_latencySlots(std::make_unique<LatencySlot[]>(ReporterQueueSize)), m_nextLatencySlot(0),
+	m_deferredRounds(0),
+	m_reporter([this](const ConnectionSnapshot& snapshot) { ReportStats(snapshot); }),
+	m_cpuMeter(perf), m_packetsReceived(0), m_bytesReceived(0)
 {
 	spdlog::set_level(spdlog::level::debug);
 	ErrorCode_t ec;
@@ -22,13 +31,52 @@ Server::Server(const std::string& address, const std::string& port)
 	m_signals.add(SIGTERM);
 	WaitSignals();
 	Accept();
+	m_printTimer.expires_at(std::chrono::steady_clock::now());
+	AwaitPrint();
+	if (metrics.empty() == false)
+	{
+		m_metrics = std::make_unique<Detail::MetricsSegment>(metrics,
+			Detail::MetricsSegment::Role::Server);
+		SPDLOG_INFO("Publishing metrics to {}", metrics);
+	}
+	if (eventLog.empty() == false)
+	{
+		m_eventLog = std::make_unique<Detail::EventLog>(eventLog);
+		SPDLOG_INFO("Recording packet events to {}", eventLog);
+	}
+	if (m_impairment.IsEnabled() == true)
+	{
+		SPDLOG_INFO("Impairing acks: delay {} ms +/- {} ms\tLoss: {}%\tReorder: {}%\tDuplicate: {}%",
+			m_impairment.delay.count() / 1e6, m_impairment.jitter.count() / 1e6,
+			m_impairment.loss * 100, m_impairment.reorder * 100, m_impairment.duplicate * 100);
+	}
 	SPDLOG_INFO("Started server");
 }
 
 void Server::Run() noexcept
 {
 	SPDLOG_INFO("Running server");
+	// every connection runs on this thread
+	m_cpuMeter.Start();
+	if (m_cpuMeter.GetHardwareError().empty() == false)
+		SPDLOG_WARN("Hardware counters unavailable: {}", m_cpuMeter.GetHardwareError());
+	const auto start = std::chrono::steady_clock::now();
+	m_reporter.Start();
+	if (m_eventLog != nullptr)
+		m_eventLog->Start();
 	m_worker.run();
+	m_reporter.Stop();
+	SPDLOG_INFO("Received {} packets in total", m_packetsReceived);
+	if (m_deferredRounds != 0)
+		SPDLOG_WARN("Reporter fell behind and put off {} collection rounds", m_deferredRounds);
+	Detail::CpuMeter::Report(m_cpuMeter.Read(), m_packetsReceived, m_bytesReceived,
+		std::chrono::steady_clock::now() - start);
+	if (m_eventLog != nullptr)
+	{
+		m_eventLog->Stop();
+		SPDLOG_INFO("Recorded {} packet events, dropped {}",
+			m_eventLog->GetWritten(), m_eventLog->GetDropped());
+	}
 }
 
 void Server::Accept() noexcept
@@ -39,14 +87,21 @@ void Server::Accept() noexcept
 			// check if it was closed
 			if (m_acceptor.is_open() == false)
 				return;
-			if (!ec)
+			if (!ec && m_connectionManager.GetConnections().size() == MaxConnections)
+			{
+				// a collection round has to fit the reporter queue
+				SPDLOG_WARN("Refused connection from {}: at the limit of {} connections",
+					socket.remote_endpoint().address().to_string(), MaxConnections);
+			}
+			else if (!ec)
 			{
 				SPDLOG_INFO("Accepted connection from {}:{}",
 					socket.remote_endpoint().address().to_string(),
 					socket.remote_endpoint().port());
 				m_connectionManager.Start(
 					std::make_shared<Detail::Connection>(
-						m_connectionManager, std::move(socket)));
+						m_connectionManager, std::move(socket), m_receiveDepth,
+						m_eventLog.get(), m_impairment));
 			}
 			else
 				SPDLOG_ERROR("Error accepting connection: {}", ec.message());
@@ -58,8 +113,11 @@ void Server::Stop() noexcept
 {
 	ErrorCode_t ignored;
 	m_acceptor.close(ignored);
+	// the last partial interval
+	CollectStats();
 	m_connectionManager.StopAll();
 	m_signals.cancel(ignored);
+	m_printTimer.cancel(ignored);
 }
 
 void Server::WaitSignals() noexcept
@@ -72,4 +130,144 @@ void Server::WaitSignals() noexcept
 			SPDLOG_DEBUG("Intercepted {}. Closing", signo);
 			Stop();
 		});
+}
+
+void Server::AwaitPrint() noexcept
+{
+	m_printTimer.expires_at(m_printTimer.expiry() + std::chrono::seconds(1));
+	m_printTimer.async_wait([this](const ErrorCode_t& ec)
+		{
+			if (ec)
+				return;
+			AwaitPrint();
+			CollectStats();
+		});
+}
+
+void Server::CollectStats() noexcept
+{
+	// a round goes out whole or waits for the next tick: a lost snapshot
+	// or round marker would make its connection look gone. The stats keep
+	// accumulating in the connections meanwhile
+	const size_t connections = m_connectionManager.GetConnections().size();
+	bool room = m_reporter.GetFree() > connections;
+	for (size_t i = 0; i < connections && room == true; ++i)
+	{
+		room = m_latencySlots[(m_nextLatencySlot + i) % ReporterQueueSize].busy.load(
+			std::memory_order_acquire) == false;
+	}
+	if (room == false)
+	{
+		++m_deferredRounds;
+		return;
+	}
+	// formatting and publishing happen on the reporter thread
+	ConnectionSnapshot snapshot;
+	const Detail::CpuMeter::Usage usage = m_cpuMeter.Read();
+	snapshot.cpuNs = usage.GetCpuNs();
+	snapshot.contextSwitches = usage.voluntarySwitches + usage.involuntarySwitches;
+	for (const auto& conn : m_connectionManager.GetConnections())
+	{
+		snapshot.id = reinterpret_cast<uintptr_t>(conn.get());
+		const std::string& name = conn->GetRemoteAddress();
+		std::memcpy(snapshot.name.data(), name.data(), 
+			std::min(name.size(), snapshot.name.size() - 1));
+		snapshot.latencySlot = static_cast<uint32_t>(m_nextLatencySlot);
+		m_nextLatencySlot = (m_nextLatencySlot + 1) % ReporterQueueSize;
+		LatencySlot& latencySlot = m_latencySlots[snapshot.latencySlot];
+		conn->CollectStats(snapshot.stats, latencySlot.latency);
+		latencySlot.busy.store(true, std::memory_order_relaxed);
+		m_packetsReceived += snapshot.stats.packetsReceived;
+		m_bytesReceived += snapshot.stats.bytesReceived;
+		// the queue publishes the slot's histogram along with the snapshot
+		m_reporter.Publish(snapshot);
+		snapshot.name.fill('\0');
+	}
+	snapshot.id = 0;
+	m_reporter.Publish(snapshot);
+}
+
+void Server::ReportStats(const ConnectionSnapshot& snapshot) noexcept
+{
+	if (snapshot.id == 0)
+	{
+		// the round is over, forget connections that were not in it
+		for (auto it = m_connectionMetrics.begin(); it != m_connectionMetrics.end();)
+		{
+			if (it->second.seen == false)
+			{
+				if (it->second.slot != Detail::MetricsSegment::SlotCount)
+					m_metrics->ReleaseSlot(it->second.slot);
+				it = m_connectionMetrics.erase(it);
+			}
+			else
+				(it++)->second.seen = false;
+		}
+		return;
+	}
+	LatencySlot& latencySlot = m_latencySlots[snapshot.latencySlot];
+	ReportConnection(snapshot, latencySlot.latency);
+	latencySlot.busy.store(false, std::memory_order_release);
+}
+
+void Server::ReportConnection(const ConnectionSnapshot& snapshot,
+	const Detail::Histogram& latency) noexcept
+{
+	using Counter = Detail::MetricsSegment::Counter;
+	const Detail::ConnectionStats& stats = snapshot.stats;
+	SPDLOG_INFO("{}: Received: {} pps\tAcked: {} pps\tLost: {}\tAck queue depth: {} (max {}, {} dropped)",
+		snapshot.name.data(), stats.packetsReceived, stats.acksSent, stats.lostTotal,
+		stats.ackQueueDepth, stats.maxAckQueueDepth, stats.acksQueueDropped);
+	// a client running several classes tells them apart by stream
+	if (stats.streamId != 0)
+	{
+		SPDLOG_INFO("{}: Stream {}\tDSCP: {}\tJitter: {:.3f} ms\tAck latency P50: {:.3f} ms\tP99: {:.3f} ms",
+			snapshot.name.data(), stats.streamId, stats.tos >> 2, stats.jitterNs / 1e6,
+			static_cast<double>(latency.GetPercentile(50)) / 1e6,
+			static_cast<double>(latency.GetPercentile(99)) / 1e6);
+	}
+	if (stats.verifySamples != 0)
+	{
+		SPDLOG_INFO("{}: Corrupted: {} ({} total)\tVerify cost: {:.1f} ns/packet ({:.2f} GB/s)",
+			snapshot.name.data(), stats.packetsCorrupted, stats.corruptedTotal,
+			static_cast<double>(stats.verifySampleNs) / stats.verifySamples,
+			(stats.verifySampleNs != 0) ? 
+				static_cast<double>(stats.verifySampleBytes) / stats.verifySampleNs : 0.);
+	}
+	if (m_impairment.IsEnabled() == true)
+	{
+		SPDLOG_INFO("{}: Impaired acks: {} dropped\t{} duplicated\t{} reordered\t{} held",
+			snapshot.name.data(), stats.acksImpairDropped, stats.acksDuplicated,
+			stats.acksReordered, stats.acksHeld);
+	}
+	if (m_metrics == nullptr)
+		return;
+	auto it = m_connectionMetrics.find(snapshot.id);
+	if (it == m_connectionMetrics.end())
+	{
+		it = m_connectionMetrics.emplace(snapshot.id, ConnectionMetrics{ 
+			m_metrics->AcquireSlot(snapshot.name.data()), false, {}, {} }).first;
+		if (it->second.slot == Detail::MetricsSegment::SlotCount)
+			SPDLOG_WARN("Out of metrics slots for {}", snapshot.name.data());
+	}
+	ConnectionMetrics& metrics = it->second;
+	metrics.seen = true;
+	if (metrics.slot == Detail::MetricsSegment::SlotCount)
+		return;
+	metrics.counters[Counter::PacketsPerSecond] = stats.packetsReceived;
+	metrics.counters[Counter::BytesPerSecond] = stats.bytesReceived;
+	metrics.counters[Counter::PacketsTotal] += stats.packetsReceived;
+	metrics.counters[Counter::BytesTotal] += stats.bytesReceived;
+	metrics.counters[Counter::LostTotal] = stats.lostTotal;
+	metrics.counters[Counter::CorruptedTotal] = stats.corruptedTotal;
+	metrics.counters[Counter::CpuTimeNs] = snapshot.cpuNs;
+	metrics.counters[Counter::ContextSwitches] = snapshot.contextSwitches;
+	metrics.counters[Counter::AckQueueDepth] = stats.ackQueueDepth;
+	metrics.counters[Counter::MaxAckQueueDepth] = stats.maxAckQueueDepth;
+	metrics.counters[Counter::LatencyCount] += stats.acksSent;
+	metrics.counters[Counter::LatencySumNs] += stats.ackLatencySumNs;
+	metrics.counters[Counter::LatencyMaxNs] = std::max(
+		metrics.counters[Counter::LatencyMaxNs], stats.ackLatencyMaxNs);
+	metrics.latency.Merge(latency);
+	m_metrics->WriteSlot(metrics.slot, metrics.counters, metrics.latency);
 }
\ No newline at end of file
@@ -0,0 +1,632 @@
+#include <UDPTest/Simulation.h>
+
+#include <UDPTest/Detail/AckTracker.h>
+#include <UDPTest/Detail/Histogram.h>
+#include <UDPTest/Detail/ReceiveTracker.h>
+#include <UDPTest/Detail/SendPacer.h>
+#include <UDPTest/Detail/SimNetwork.h>
+#include <UDPTest/Detail/TrafficModel.h>
+#include <UDPTest/Detail/Transport.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using UDPTest::Simulation;
+using UDPTest::Detail::RandomPacket;
+using UDPTest::Detail::SimNetwork;
+
+namespace
+{
+	using Duration_t = SimNetwork::Duration_t;
+	using Side = SimNetwork::Side;
+
+	/// @brief The client's loss window, in seconds of sends and at least
+	/// this many seqs
+	constexpr size_t LossWindowSeconds = 2;
+	constexpr size_t LossWindowMin = 4096;
+	/// @brief How long the client waits for the last acks of a phase
+	constexpr Duration_t DrainTime = std::chrono::milliseconds(250);
+	constexpr uint32_t PayloadSeed = 0x5EED;
+	constexpr uint16_t StreamId = 0x51;
+
+	/// @brief SimClient sends packets through a send ring and accounts for
+	/// their acks with the client's own ack tracker. A send holds its ring
+	/// entry until the link has serialized it, which is when it leaves
+	class SimClient
+	{
+	public:
+		SimClient(SimNetwork& network, UDPTest::Detail::FieldSet fields, size_t window,
+			uint64_t firstSeq, uint32_t sendRingSize, uint64_t linkRate)
+			: m_network(network), m_fields(fields),
+			m_streamId(((fields & UDPTest::Detail::FieldBit(UDPTest::Detail::Field::StreamId)) != 0) ? StreamId : 0),
+			m_ack(UDPTest::Detail::GetAckFields(fields)),
+			m_ackTracker(window, (fields & UDPTest::Detail::FieldBit(UDPTest::Detail::Field::Timestamp)) != 0, firstSeq),
+			m_sendRing(sendRingSize), m_sendHead(0), m_inFlight(0), m_linkRate(linkRate), m_linkFree(0)
+		{
+			for (SendEntry& entry : m_sendRing)
+				entry.packet = RandomPacket(fields);
+			m_ackTracker.BeginPhase(Duration_t(0));
+		}
+
+		/// @brief Gets whether the send ring has a free entry
+		bool HasRoom() const noexcept { return m_inFlight < m_sendRing.size(); }
+		/// @brief Gets whether a send is in flight
+		bool IsSending() const noexcept { return m_inFlight != 0; }
+		/// @brief Gets when the oldest send in flight is on the wire.
+		/// Requires: IsSending
+		Duration_t GetNextDone() const noexcept { return m_sendRing[GetOldest()].done; }
+
+		/// @brief Issues the next seq
+		/// @param now The time
+		/// @param payloadSize The payload size
+		void Send(Duration_t now, uint32_t payloadSize) noexcept
+		{
+			SendEntry& entry = m_sendRing[m_sendHead];
+			m_sendHead = (m_sendHead + 1) % m_sendRing.size();
+			++m_inFlight;
+			entry.seq = m_ackTracker.GetNextSeq();
+			entry.packet.Fill(RandomPacket::ToWireSeq(entry.seq), payloadSize, PayloadSeed);
+			const UDPTest::Detail::HeaderView<uint8_t> header = entry.packet.GetHeader();
+			header.Set<UDPTest::Detail::Field::Timestamp>(static_cast<uint64_t>(now.count()));
+			header.Set<UDPTest::Detail::Field::StreamId>(m_streamId);
+			if ((m_fields & UDPTest::Detail::FieldBit(UDPTest::Detail::Field::Checksum)) != 0)
+				entry.packet.Seal();
+			m_ackTracker.OnSend(now);
+			// the link serializes one datagram at a time
+			m_linkFree = std::max(m_linkFree, now);
+			if (m_linkRate != 0)
+			{
+				m_linkFree += Duration_t(static_cast<Duration_t::rep>(
+					entry.packet.GetSize() * 8 * uint64_t(1000000000) / m_linkRate));
+			}
+			entry.done = m_linkFree;
+		}
+
+		/// @brief Puts the oldest send in flight on the wire, freeing its
+		/// ring entry. Requires: IsSending
+		void FinishSend() noexcept
+		{
+			SendEntry& entry = m_sendRing[GetOldest()];
+			--m_inFlight;
+			m_network.Send(Side::Client, static_cast<const uint8_t*>(entry.packet.GetBuffers().data()),
+				entry.packet.GetSize(), entry.seq);
+		}
+
+		/// @brief Accounts for an ack that arrived now
+		/// @param data The datagram
+		/// @param size The size of the datagram
+		void OnAck(const uint8_t* data, size_t size) noexcept
+		{
+			if (size < m_ack.GetSize())
+				return;
+			std::memcpy(m_ack.GetBuffers().data(), data, m_ack.GetSize());
+			if (m_ack.GetHeader().Get<UDPTest::Detail::Field::StreamId>() != m_streamId)
+				return;
+			const UDPTest::Detail::AckTracker::Ack ack = m_ackTracker.OnAck(m_ack.GetSeq(),
+				(m_ack.GetFlags() & UDPTest::Detail::PacketAck::Flags::Corrupt) != 0,
+				m_ack.GetHeader().Get<UDPTest::Detail::Field::Timestamp>(), m_network.GetNow());
+			if (ack.outcome == UDPTest::Detail::AckTracker::Outcome::Received)
+				m_latency.Record(static_cast<uint64_t>(ack.latency.count()));
+		}
+
+		/// @brief Counts whatever is still in flight as lost, as the end
+		/// stats do
+		void Finish() noexcept
+		{
+			m_ackTracker.FinalizeLoss();
+			m_ackTracker.Close();
+		}
+
+		const UDPTest::Detail::AckTracker& GetAckTracker() const noexcept { return m_ackTracker; }
+		const UDPTest::Detail::Histogram& GetLatency() const noexcept { return m_latency; }
+	private:
+		struct SendEntry
+		{
+			RandomPacket packet;
+			/// @brief When the link has serialized it
+			Duration_t done{ 0 };
+			uint64_t seq = 0;
+		};
+
+		/// @brief Gets the index of the oldest send in flight
+		size_t GetOldest() const noexcept
+		{
+			return (m_sendHead + m_sendRing.size() - m_inFlight) % m_sendRing.size();
+		}
+
+		SimNetwork& m_network;
+		UDPTest::Detail::FieldSet m_fields;
+		uint16_t m_streamId;
+		UDPTest::Detail::PacketAck m_ack;
+		UDPTest::Detail::AckTracker m_ackTracker;
+		UDPTest::Detail::Histogram m_latency;
+		std::vector<SendEntry> m_sendRing;
+		size_t m_sendHead;
+		size_t m_inFlight;
+		uint64_t m_linkRate;
+		Duration_t m_linkFree;
+	};
+
+	/// @brief SimServer receives packets with a connection's own receive
+	/// tracker and acks them, verifying the checksum if they carry one
+	class SimServer
+	{
+	public:
+		SimServer(SimNetwork& network, UDPTest::Detail::FieldSet fields, uint32_t maxPayloadSize)
+			: m_network(network), m_packet(fields, maxPayloadSize),
+			m_ackFields(UDPTest::Detail::GetAckFields(fields)),
+			m_verify((fields & UDPTest::Detail::FieldBit(UDPTest::Detail::Field::Checksum)) != 0),
+			m_timestamped((fields & UDPTest::Detail::FieldBit(UDPTest::Detail::Field::Timestamp)) != 0) {}
+
+		/// @brief Acks a packet that arrived now
+		/// @param data The datagram
+		/// @param size The size of the datagram
+		/// @param tag The tag to send the ack with
+		void OnPacket(const uint8_t* data, size_t size, uint64_t tag) noexcept
+		{
+			std::memcpy(m_packet.GetBuffers().data(), data, std::min(size, m_packet.GetSize()));
+			const RandomPacket& packet = m_packet;
+			uint8_t flags = 0;
+			if (size < packet.GetHeaderSize() || (m_verify == true && packet.Verify(size) == false))
+			{
+				m_receiveTracker.OnCorrupt();
+				flags = UDPTest::Detail::PacketAck::Flags::Corrupt;
+			}
+			else
+			{
+				m_receiveTracker.OnPacket(packet.GetSeq());
+				if (m_timestamped == true)
+				{
+					m_receiveTracker.OnTransit(packet.GetHeader().Get<UDPTest::Detail::Field::Timestamp>(),
+						m_network.GetNow());
+				}
+			}
+			UDPTest::Detail::PacketAck ack(m_ackFields, packet.GetHeader(), flags);
+			m_network.Send(Side::Server, static_cast<const uint8_t*>(ack.GetBuffers().data()),
+				ack.GetSize(), tag);
+		}
+
+		const UDPTest::Detail::ReceiveTracker& GetReceiveTracker() const noexcept { return m_receiveTracker; }
+	private:
+		SimNetwork& m_network;
+		RandomPacket m_packet;
+		UDPTest::Detail::FieldSet m_ackFields;
+		bool m_verify;
+		bool m_timestamped;
+		UDPTest::Detail::ReceiveTracker m_receiveTracker;
+	};
+
+	/// @brief GroundTruth is what the network knows happened to every seq.
+	/// It learns seqs from the tags datagrams carry, never from their bytes,
+	/// and which copies arrived corrupted from the network
+	class GroundTruth
+	{
+	public:
+		/// @brief Set in the tag of an ack whose packet arrived corrupted
+		/// where the server can tell
+		static constexpr uint64_t CorruptTag = uint64_t(1) << 63;
+
+		/// @param window The seqs the client keeps in flight before giving
+		/// up on the oldest
+		/// @param firstSeq The first seq sent
+		/// @param timestamped Whether packets carry their send time, which
+		/// the server's jitter needs
+		GroundTruth(size_t window, uint64_t firstSeq, bool timestamped)
+			: m_slots(window), m_judged(firstSeq), m_firstSeq(firstSeq), m_timestamped(timestamped),
+			m_firstReceived(0), m_highestReceived(0), m_serverReceived(0), m_serverCorrupted(0),
+			m_transitSeen(false), m_lastTransit(0), m_serverJitterNs(0), m_acks(0), m_lateAcks(0),
+			m_corruptAcks(0), m_duplicates(0), m_reordered(0), m_maxDisplacement(0),
+			m_highestAcked(firstSeq), m_latencySeen(false), m_lastLatency(0), m_jitter(0), m_lost(0),
+			m_run(0), m_episodes(0), m_longestEpisode(0) {}
+
+		void OnSent(uint64_t seq, Duration_t now)
+		{
+			// the client gives up on a seq once a window of seqs follows it
+			if (seq - m_firstSeq >= m_slots.size())
+				Judge();
+			m_slots[seq % m_slots.size()] = Slot{ now, false };
+			m_sendTimes.push_back(now);
+		}
+
+		/// @param seq The seq
+		/// @param corrupt Whether it arrived corrupted where the server can tell
+		/// @param now The arrival time
+		void OnServerReceived(uint64_t seq, bool corrupt, Duration_t now) noexcept
+		{
+			if (corrupt == true)
+			{
+				++m_serverCorrupted;
+				return;
+			}
+			// the server's sequence starts at the first packet to arrive
+			if (m_serverReceived++ == 0)
+				m_firstReceived = m_highestReceived = seq;
+			m_highestReceived = std::max(m_highestReceived, seq);
+			if (m_timestamped == false)
+				return;
+			const Duration_t transit = now - m_sendTimes[seq - m_firstSeq];
+			if (m_transitSeen == true)
+			{
+				const double difference = static_cast<double>(std::abs((transit - m_lastTransit).count()));
+				m_serverJitterNs += (difference - m_serverJitterNs) / 16;
+			}
+			m_transitSeen = true;
+			m_lastTransit = transit;
+		}
+
+		void OnAck(uint64_t tag, Duration_t now)
+		{
+			const uint64_t seq = tag & ~CorruptTag;
+			// already judged lost, whether intact or not
+			if (seq < m_judged)
+			{
+				++m_lateAcks;
+				return;
+			}
+			Slot& slot = m_slots[seq % m_slots.size()];
+			if (slot.acked == true)
+			{
+				++m_duplicates;
+				return;
+			}
+			slot.acked = true;
+			if ((tag & CorruptTag) != 0)
+			{
+				// counted as corrupted, and as neither received nor lost
+				++m_corruptAcks;
+				return;
+			}
+			++m_acks;
+			const Duration_t latency = now - slot.sent;
+			m_latencies.push_back(static_cast<uint64_t>(latency.count()));
+			if (m_latencySeen == true)
+			{
+				const Duration_t difference = (latency > m_lastLatency) ?
+					latency - m_lastLatency : m_lastLatency - latency;
+				m_jitter += (difference - m_jitter) / 16;
+			}
+			m_latencySeen = true;
+			m_lastLatency = latency;
+			if (seq < m_highestAcked)
+			{
+				++m_reordered;
+				m_maxDisplacement = std::max(m_maxDisplacement, m_highestAcked - seq);
+			}
+			else
+				m_highestAcked = seq;
+		}
+
+		/// @brief Judges every seq still in flight
+		/// @param endSeq The seq after the last sent
+		void Finish(uint64_t endSeq) noexcept
+		{
+			while (m_judged != endSeq)
+				Judge();
+		}
+
+		/// @brief Gets an exact latency percentile, ranked the way the
+		/// histogram ranks
+		uint64_t GetLatency(double percentile)
+		{
+			if (m_latencies.empty() == true)
+				return 0;
+			const size_t rank = std::max<size_t>(1, static_cast<size_t>(
+				std::ceil(percentile / 100. * static_cast<double>(m_latencies.size()))));
+			std::nth_element(m_latencies.begin(), m_latencies.begin() + (rank - 1), m_latencies.end());
+			return m_latencies[rank - 1];
+		}
+
+		uint64_t GetHighestReceived() const noexcept { return m_highestReceived; }
+		uint64_t GetServerReceived() const noexcept { return m_serverReceived; }
+		uint64_t GetServerCorrupted() const noexcept { return m_serverCorrupted; }
+		/// @brief Gets the seqs from the server's first to its highest that
+		/// never arrived, corrupted or not
+		uint64_t GetServerLost() const noexcept
+		{
+			if (m_serverReceived == 0)
+				return 0;
+			const uint64_t expected = m_highestReceived - m_firstReceived + 1;
+			const uint64_t arrived = m_serverReceived + m_serverCorrupted;
+			return (expected > arrived) ? expected - arrived : 0;
+		}
+		double GetServerJitterNs() const noexcept { return m_serverJitterNs; }
+		uint64_t GetAcks() const noexcept { return m_acks; }
+		uint64_t GetLateAcks() const noexcept { return m_lateAcks; }
+		uint64_t GetCorruptAcks() const noexcept { return m_corruptAcks; }
+		uint64_t GetDuplicates() const noexcept { return m_duplicates; }
+		uint64_t GetReordered() const noexcept { return m_reordered; }
+		uint64_t GetMaxDisplacement() const noexcept { return m_maxDisplacement; }
+		Duration_t GetJitter() const noexcept { return m_jitter; }
+		uint64_t GetLost() const noexcept { return m_lost; }
+		uint64_t GetEpisodes() const noexcept { return m_episodes; }
+		uint64_t GetLongestEpisode() const noexcept { return m_longestEpisode; }
+	private:
+		struct Slot
+		{
+			Duration_t sent;
+			bool acked;
+		};
+
+		/// @brief Judges the oldest seq in flight
+		void Judge() noexcept
+		{
+			if (m_slots[m_judged % m_slots.size()].acked == false)
+			{
+				++m_lost;
+				if (++m_run == 1)
+					++m_episodes;
+				m_longestEpisode = std::max(m_longestEpisode, m_run);
+			}
+			else
+				m_run = 0;
+			++m_judged;
+		}
+
+		std::vector<Slot> m_slots;
+		/// @brief The send time of every seq, however late its packet arrives
+		std::vector<Duration_t> m_sendTimes;
+		uint64_t m_judged;
+		uint64_t m_firstSeq;
+		bool m_timestamped;
+		uint64_t m_firstReceived;
+		uint64_t m_highestReceived;
+		uint64_t m_serverReceived;
+		uint64_t m_serverCorrupted;
+		bool m_transitSeen;
+		Duration_t m_lastTransit;
+		double m_serverJitterNs;
+		uint64_t m_acks;
+		uint64_t m_lateAcks;
+		uint64_t m_corruptAcks;
+		uint64_t m_duplicates;
+		uint64_t m_reordered;
+		uint64_t m_maxDisplacement;
+		uint64_t m_highestAcked;
+		bool m_latencySeen;
+		Duration_t m_lastLatency;
+		Duration_t m_jitter;
+		uint64_t m_lost;
+		uint64_t m_run;
+		uint64_t m_episodes;
+		uint64_t m_longestEpisode;
+		/// @brief The latency of every acked seq, in nanoseconds
+		std::vector<uint64_t> m_latencies;
+	};
+
+	/// @brief Counts the slots a traffic model schedules before a time,
+	/// the first of them due right away
+	/// @param model The model, rewound
+	/// @param end The time
+	/// @return The slots
+	uint64_t CountSlots(UDPTest::Detail::TrafficModel& model, Duration_t end) noexcept
+	{
+		uint64_t slots = 0;
+		Duration_t due(0);
+		Duration_t gap;
+		uint32_t size;
+		bool drawn = model.Next(gap, size);
+		while (drawn == true && due < end)
+		{
+			++slots;
+			drawn = model.Next(gap, size);
+			due += gap;
+		}
+		return slots;
+	}
+}
+
+void Simulation::ParseNetwork(const std::string& spec, Config& config)
+{
+	// the items of the client's own link are taken out, the rest are impairments
+	std::string impairments;
+	size_t start = 0;
+	while (start < spec.size())
+	{
+		size_t end = spec.find(',', start);
+		if (end == std::string::npos)
+			end = spec.size();
+		const std::string item = spec.substr(start, end - start);
+		start = end + 1;
+		const size_t equals = item.find('=');
+		const std::string name = item.substr(0, equals);
+		if (name != "corrupt" && name != "link")
+		{
+			impairments += (impairments.empty() == true) ? item : ',' + item;
+			continue;
+		}
+		double value = 0;
+		if (equals == std::string::npos ||
+			std::from_chars(item.data() + equals + 1, item.data() + item.size(), value).ptr != item.data() + item.size() ||
+			value < 0 || (name == "corrupt" && value > 100))
+			throw std::runtime_error("Expected corrupt=<%> or link=<Mbit/s>, got " + item);
+		if (name == "corrupt")
+			config.corrupt = value / 100;
+		else
+			config.linkRate = static_cast<uint64_t>(value * 1e6);
+	}
+	config.impairment = Detail::ImpairmentConfig::Parse(impairments);
+}
+
+bool Simulation::Run(const Config& config, std::ostream& os)
+{
+	if (config.packetRate == 0 || config.time == 0 || config.sendRingSize == 0)
+		throw std::runtime_error("A simulation needs a packet rate, a time and a send ring");
+	const size_t headerSize = Detail::PacketLayouts[config.fields | Detail::BasePacketFields].size;
+	// the header sent with every packet counts towards the bitrate
+	const uint64_t packetBytes = config.bitRate / 8 / config.packetRate;
+	if (packetBytes <= headerSize || packetBytes > RandomPacket::MaxDatagramSize)
+		throw std::runtime_error("Packets would not fit a datagram with the given bitrate and packetrate");
+	const uint32_t payloadSize = static_cast<uint32_t>(packetBytes - headerSize);
+	const Detail::TrafficModel::Duration_t meanGap = Detail::TrafficModel::GetGap(config.packetRate);
+	const std::unique_ptr<Detail::TrafficModel> model = Detail::TrafficModel::Create(config.shape,
+		meanGap, payloadSize, payloadSize);
+	model->Seed(config.seed);
+	Detail::SendPacer pacer(Detail::SendPacer::ParsePolicy(config.catchUpPolicy), config.sendRingSize);
+	// start half the run before the wire seqs wrap, so every run crosses it
+	const uint64_t sends = static_cast<uint64_t>(config.packetRate) * config.time;
+	const uint64_t firstSeq = RandomPacket::SeqSpace - std::min(sends / 2, RandomPacket::SeqSpace / 4);
+	const bool verify = (config.fields & Detail::FieldBit(Detail::Field::Checksum)) != 0;
+
+	SimNetwork network(config.impairment, config.impairment, config.corrupt, config.seed);
+	SimClient client(network, config.fields, std::max<size_t>(LossWindowMin,
+		static_cast<size_t>(config.packetRate) * LossWindowSeconds), firstSeq,
+		config.sendRingSize, config.linkRate);
+	SimServer server(network, config.fields, model->GetMaxPayloadSize());
+	const Detail::AckTracker& ackTracker = client.GetAckTracker();
+	GroundTruth truth(ackTracker.GetLossTracker().GetWindow(), firstSeq,
+		(config.fields & Detail::FieldBit(Detail::Field::Timestamp)) != 0);
+	const auto deliver = [&](Side to, const uint8_t* data, size_t size, uint64_t tag, bool corrupted)
+	{
+		if (to == Side::Server)
+		{
+			// only a checksum tells the server a packet was corrupted
+			const bool caught = corrupted == true && verify == true;
+			truth.OnServerReceived(tag, caught, network.GetNow());
+			server.OnPacket(data, size, (caught == true) ? tag | GroundTruth::CorruptTag : tag);
+		}
+		else
+		{
+			truth.OnAck(tag, network.GetNow());
+			client.OnAck(data, size);
+		}
+	};
+	const auto send = [&](Duration_t now, uint32_t size)
+	{
+		truth.OnSent(ackTracker.GetNextSeq(), now);
+		client.Send(now, size);
+	};
+	const auto hasRoom = [&client]() { return client.HasRoom(); };
+
+	os << "Simulating " << config.time << " s of " << payloadSize << " byte payloads at " <<
+		config.packetRate << " packets/s, seed " << config.seed << '\n';
+	const auto wallStart = std::chrono::steady_clock::now();
+	const Duration_t end = std::chrono::seconds(config.time);
+	constexpr Duration_t never = Duration_t::max();
+	// the first slot is due right away, as a phase starts. Slots come due
+	// until the phase ends on time or its traffic runs out, and every send
+	// issued by then goes on the wire
+	bool pacing = pacer.Begin(*model, Duration_t(0), meanGap);
+	while (true)
+	{
+		const Duration_t due = (pacing == true && pacer.IsStalled() == false && pacer.GetDue() < end) ?
+			pacer.GetDue() : never;
+		const Duration_t done = (client.IsSending() == true) ? client.GetNextDone() : never;
+		if (due == never && done == never)
+			break;
+		if (done <= due)
+		{
+			network.AdvanceTo(done, deliver);
+			client.FinishSend();
+			if (done < end && pacer.OnSendDone(done, hasRoom, send) == true)
+				pacing = pacer.Advance();
+		}
+		else
+		{
+			network.AdvanceTo(due, deliver);
+			if (pacer.OnDue(due, client.HasRoom(), send) == true)
+				pacing = pacer.Advance();
+		}
+	}
+	network.AdvanceTo(((pacing == true) ? std::max(end, network.GetNow()) : network.GetNow()) + DrainTime,
+		deliver);
+	client.Finish();
+	truth.Finish(ackTracker.GetNextSeq());
+	const double wallSeconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - wallStart).count();
+
+	bool matched = true;
+	const auto print = [&os, &matched](const char* stat, const std::string& measured,
+		const std::string& expected, bool ok)
+	{
+		matched = matched && ok;
+		os << std::left << std::setw(24) << stat << std::right << std::setw(16) << measured <<
+			std::setw(16) << expected << "  " << (ok ? "ok" : "MISMATCH") << '\n';
+	};
+	const auto exact = [&print](const char* stat, uint64_t measured, uint64_t expected)
+	{
+		print(stat, std::to_string(measured), std::to_string(expected), measured == expected);
+	};
+	// a percentile is the upper bound of its bucket, at most a sub-bucket
+	// above the exact value
+	const auto latency = [&print](const char* stat, uint64_t measured, uint64_t expected)
+	{
+		const auto toMs = [](uint64_t ns)
+		{
+			std::ostringstream oss;
+			oss << std::fixed << std::setprecision(3) << static_cast<double>(ns) / 1e6 << " ms";
+			return oss.str();
+		};
+		print(stat, toMs(measured), toMs(expected), measured >= expected &&
+			measured - expected <= expected / Detail::Histogram::SubBuckets + 1);
+	};
+	os << std::left << std::setw(24) << "Stat" << std::right << std::setw(16) << "Measured" <<
+		std::setw(16) << "Truth" << '\n';
+	// every slot is sent, skipped or left in the backlog, unless stretching
+	// moved the schedule itself
+	const uint64_t sent = ackTracker.GetSent();
+	if (config.catchUpPolicy != "stretch")
+	{
+		model->Rewind();
+		exact("Send slots", sent + pacer.GetSkipped() + pacer.GetBacklog(), CountSlots(*model, end));
+	}
+	else
+		print("Send slots", std::to_string(sent), "-", true);
+	print("Sent late", std::to_string(pacer.GetLate()), "-", true);
+	print("Slots skipped", std::to_string(pacer.GetSkipped()), "-", true);
+	const Detail::ReceiveTracker& receiveTracker = server.GetReceiveTracker();
+	exact("Server received", receiveTracker.GetReceived(), truth.GetServerReceived());
+	exact("Server corrupted", receiveTracker.GetCorrupted(), truth.GetServerCorrupted());
+	exact("Server highest seq", receiveTracker.GetHighestSeq(), truth.GetHighestReceived());
+	exact("Server lost", receiveTracker.GetLost(), truth.GetServerLost());
+	{
+		std::ostringstream measured;
+		std::ostringstream expected;
+		measured << std::fixed << std::setprecision(3) << receiveTracker.GetJitterNs() / 1e6 << " ms";
+		expected << std::fixed << std::setprecision(3) << truth.GetServerJitterNs() / 1e6 << " ms";
+		print("Server jitter", measured.str(), expected.str(),
+			std::abs(receiveTracker.GetJitterNs() - truth.GetServerJitterNs()) < 1e-6);
+	}
+	exact("Acks received", ackTracker.GetAcked(), truth.GetAcks());
+	exact("Acks corrupted", ackTracker.GetCorrupted(), truth.GetCorruptAcks());
+	exact("Late acks", ackTracker.GetLateAcks(), truth.GetLateAcks());
+	exact("Duplicate acks", ackTracker.GetDuplicates(), truth.GetDuplicates());
+	exact("Acks reordered", ackTracker.GetReordered(), truth.GetReordered());
+	exact("Max displacement", ackTracker.GetMaxDisplacement(), truth.GetMaxDisplacement());
+	const Detail::LossTracker& lossTracker = ackTracker.GetLossTracker();
+	exact("Packets lost", lossTracker.GetLost(), truth.GetLost());
+	// every seq sent ends up acked, corrupted or lost, exactly one of them
+	exact("Acked, corrupt or lost", ackTracker.GetAcked() + ackTracker.GetCorrupted() + lossTracker.GetLost(), sent);
+	exact("Loss episodes", lossTracker.GetEpisodeCount(), truth.GetEpisodes());
+	exact("Longest loss episode", lossTracker.GetBurstLengths().GetMax(), truth.GetLongestEpisode());
+	const Detail::Histogram& histogram = client.GetLatency();
+	latency("Latency P50", histogram.GetPercentile(50), truth.GetLatency(50));
+	latency("Latency P99", histogram.GetPercentile(99), truth.GetLatency(99));
+	latency("Latency P99.9", histogram.GetPercentile(99.9), truth.GetLatency(99.9));
+	exact("Max latency (ns)", histogram.GetMax(), truth.GetLatency(100));
+	exact("Jitter (ns)", static_cast<uint64_t>(ackTracker.GetJitter().count()),
+		static_cast<uint64_t>(truth.GetJitter().count()));
+
+	const auto path = [&os](const char* name, const SimNetwork::PathStats& stats)
+	{
+		os << name << ": " << stats.sent << " sent, " << stats.dropped << " dropped, " <<
+			stats.duplicated << " duplicated, " << stats.reordered << " reordered, " <<
+			stats.corrupted << " corrupted\n";
+	};
+	path("To server", network.GetPathStats(Side::Client));
+	path("To client", network.GetPathStats(Side::Server));
+	os << "Wire seqs wrapped at seq " << RandomPacket::SeqSpace << ", " <<
+		RandomPacket::SeqSpace - firstSeq << " packets in\n";
+	os << "Simulated " << config.time << " s in " << std::fixed << std::setprecision(3) <<
+		wallSeconds << " s" << '\n';
+	return matched;
+}
\ No newline at end of file